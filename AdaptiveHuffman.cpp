@@ -0,0 +1,432 @@
+/*
+    Purpose: Build libadaptivehuffman, the library behind AdaptiveHuffman.h. The handles hold a
+        HuffmanCompressor and the settings it was built with, and the functions are thin calls into it that
+        turn its results into statuses. No exception gets out past them, since the callers may not be C++.
+        Streams code their input a run of whole blocks at a time, cut at the same places compress cuts the
+        whole message, so a container coded through a stream is the same one ah_encode would give.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AdaptiveHuffman.h"
+#include "HuffmanCompressor.h"
+#include "HuffmanThreadPool.h"
+using namespace std;
+
+// Checking that the numbers in the C header are the ones the C++ headers and the containers use
+static_assert(int(AH_INVALID_HEADER) == int(HUFFMAN_INVALID_HEADER), "Statuses Differ From HuffmanStatus");
+static_assert(int(AH_MODE_UTF8) == int(BLOCK_MODE_UTF8) && int(AH_MODE_AUTO) == int(BLOCK_MODE_AUTO), "Modes Differ From HuffmanBlockMode");
+static_assert(AH_TRANSFORM_RLE == TRANSFORM_RLE && AH_TRANSFORM_MTF == TRANSFORM_MTF && AH_TRANSFORM_ALL == TRANSFORM_ALL, "Transforms Differ");
+
+// Creating the coder handle: the alphabet and settings the compressor was built with, the compressor, the threads
+//      it codes Burrows-Wheeler blocks on if it was given any, and where its last failure was
+struct ah_coder {
+    string alphabet;
+    size_t blockSize;
+    int level;
+    int maxCodeLength;
+    vector<string> tokens;
+    unique_ptr<HuffmanThreadPool> pool;
+    unique_ptr<HuffmanCompressor> compressor;
+    uint64_t errorOffset;
+    bool streaming;
+};
+
+// Creating the stream handle: its coder and settings, the input it has taken but not coded yet, how much input
+//      came before that, and the output of the run being coded, which is kept to save allocating it each time
+struct ah_stream {
+    ah_coder* coder;
+    bool encoding;
+    HuffmanBlockMode mode;
+    uint8_t transforms;
+    string pending;
+    uint64_t consumed;
+    bool started;
+    bool finished;
+    ah_status failure;
+    string output;
+};
+
+// Function that runs the body of an exported function, turning anything it throws into a status
+template<class Body>
+static ah_status guarded(Body body) noexcept {
+    try {
+        return body();
+    }
+    catch(const bad_alloc&) {
+        return AH_OUT_OF_MEMORY;
+    }
+    catch(HuffmanException&) {
+        return AH_INVALID_ALPHABET;
+    }
+    catch(...) {
+        // Anything else is a thread the pool couldn't start, which is also running out of something
+        return AH_OUT_OF_MEMORY;
+    }
+}
+
+// Function that tells us whether we can encode with the mode and transforms
+static bool validEncodeSettings(ah_mode mode, unsigned transforms) {
+    return ((int(mode) >= 0 && int(mode) <= AH_MODE_UTF8) || mode == AH_MODE_AUTO) && (transforms & ~AH_TRANSFORM_ALL) == 0;
+}
+
+// Function that keeps where a failed call went wrong, and turns its result into a status
+static ah_status reportResult(ah_coder* coder, const HuffmanResult& result, uint64_t offset = 0) {
+    if(!result.ok()) {
+        coder->errorOffset = offset + result.errorOffset;
+    }
+    return ah_status(result.status);
+}
+
+// Function that copies the output into memory the caller frees with ah_free
+static ah_status giveOutput(const string& data, unsigned char** output, size_t* output_length) {
+    unsigned char* copy = (unsigned char*)malloc(data.empty() ? 1 : data.size());
+
+    if(copy == nullptr) {
+        return AH_OUT_OF_MEMORY;
+    }
+
+    memcpy(copy, data.data(), data.size());
+    *output = copy;
+    *output_length = data.size();
+    return AH_SUCCESS;
+}
+
+// Function that builds the coder a compressor with the block size, level and code length limit, keeping its tokens
+//      and threads. The coder keeps the one it had if this throws
+static void buildCompressor(ah_coder* coder, size_t blockSize, int level, int maxCodeLength) {
+    unique_ptr<HuffmanCompressor> compressor = make_unique<HuffmanCompressor>(coder->alphabet, blockSize, maxCodeLength, level);
+    compressor->useThreadPool(coder->pool.get());
+    compressor->useTokenDictionary(coder->tokens);
+
+    coder->compressor = std::move(compressor);
+    coder->blockSize = blockSize;
+    coder->level = level;
+    coder->maxCodeLength = maxCodeLength;
+}
+
+// Function that codes what the stream holds a run of whole blocks at a time, handing each run's output to the
+//      callback, and then drops what it coded. A run is one block, or one per thread if the coder has threads,
+//      so they can be coded together. Everything left is coded when this is the last call
+static ah_status codePending(ah_stream* stream, bool last, ah_write_fn write, void* context) {
+    HuffmanCompressor& compressor = *stream->coder->compressor;
+    string_view pending = stream->pending;
+    size_t blocksPerRun = stream->coder->pool != nullptr ? stream->coder->pool->getThreadCount() : 1;
+    size_t blockSize = compressor.getBlockSize();
+    size_t start = 0;
+    ah_status status = AH_SUCCESS;
+
+    while(status == AH_SUCCESS) {
+        stream->output.clear();
+        HuffmanResult result;
+        size_t end = start;
+
+        if(stream->encoding) {
+            // A block is only coded once input past its end has come in, since until then we can't tell that it
+            //      isn't the message's last block, which compress would cut the same way
+            for(size_t blocks = 0; blocks < blocksPerRun && pending.size() - end > blockSize; blocks++) {
+                end = compressor.nextBlockEnd(pending, end, stream->mode);
+            }
+            if(last) {
+                end = pending.size();
+            }
+
+            // The first run starts the container, and gets a block even if the message is empty
+            if(end == start && (stream->started || !last)) {
+                break;
+            }
+            if(!stream->started) {
+                compressor.startContainer(stream->output, stream->transforms);
+                stream->started = true;
+            }
+
+            result = compressor.compressBlocks(pending.substr(start, end - start), stream->mode, stream->output, stream->transforms);
+        }
+        else if(!stream->started) {
+            if(pending.size() < CONTAINER_HEADER_SIZE && !last) {
+                break;
+            }
+
+            result = compressor.startDecompressing(pending, stream->transforms);
+            end = CONTAINER_HEADER_SIZE;
+            stream->started = true;
+        }
+        else {
+            // Finding whole blocks by reading each block header for the size of its payload. The last call hands
+            //      over whatever is left as well, so a damaged last block is reported
+            while(end - start < blocksPerRun * blockSize && pending.size() - end >= BLOCK_HEADER_SIZE) {
+                uint64_t payloadBits = readLittleEndian(pending.data() + end + 5, 8);
+                uint64_t payloadBytes = payloadBits / 8 + (payloadBits % 8 != 0 ? 1 : 0);
+
+                if(payloadBytes > pending.size() - end - BLOCK_HEADER_SIZE) {
+                    break;
+                }
+                end += BLOCK_HEADER_SIZE + size_t(payloadBytes);
+            }
+            if(last) {
+                end = pending.size();
+            }
+
+            if(end == start) {
+                break;
+            }
+
+            result = compressor.decompressBlocks(pending.substr(start, end - start), stream->transforms, stream->output, 0);
+        }
+
+        status = reportResult(stream->coder, result, stream->consumed + start);
+
+        if(status == AH_SUCCESS && !stream->output.empty() &&
+           write(context, (const unsigned char*)stream->output.data(), stream->output.size()) != 0) {
+            stream->coder->errorOffset = stream->consumed + start;
+            status = AH_OUTPUT_FULL;
+        }
+        start = end;
+    }
+
+    stream->pending.erase(0, start);
+    stream->consumed += start;
+    stream->failure = status;
+    return status;
+}
+
+extern "C" {
+
+AH_API int ah_version(void) {
+    return AH_VERSION;
+}
+
+AH_API const char* ah_status_message(ah_status status) {
+    switch(status) {
+        case AH_INVALID_ARGUMENT:
+            return "Invalid Argument";
+        case AH_INVALID_ALPHABET:
+            return "Invalid Alphabet Or Token Dictionary";
+        case AH_OUT_OF_MEMORY:
+            return "Out Of Memory";
+        case AH_BUSY:
+            return "Coder Has A Stream Open";
+        default:
+            return describeHuffmanStatus(HuffmanStatus(status));
+    }
+}
+
+AH_API ah_status ah_coder_create(const char* alphabet, size_t alphabet_length, ah_coder** coder) {
+    if(coder == nullptr || (alphabet == nullptr && alphabet_length > 0)) {
+        return AH_INVALID_ARGUMENT;
+    }
+
+    return guarded([&] {
+        unique_ptr<ah_coder> created = make_unique<ah_coder>();
+        created->alphabet.assign(alphabet == nullptr ? "" : alphabet, alphabet_length);
+        created->errorOffset = 0;
+        created->streaming = false;
+
+        buildCompressor(created.get(), DEFAULT_BLOCK_SIZE, DEFAULT_LZ77_LEVEL, NO_CODE_LENGTH_LIMIT);
+        *coder = created.release();
+        return AH_SUCCESS;
+    });
+}
+
+AH_API void ah_coder_free(ah_coder* coder) {
+    delete coder;
+}
+
+AH_API ah_status ah_coder_set_block_size(ah_coder* coder, size_t block_size) {
+    if(coder == nullptr) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(coder->streaming) {
+        return AH_BUSY;
+    }
+
+    return guarded([&] {
+        buildCompressor(coder, block_size == 0 ? DEFAULT_BLOCK_SIZE : block_size, coder->level, coder->maxCodeLength);
+        return AH_SUCCESS;
+    });
+}
+
+AH_API ah_status ah_coder_set_level(ah_coder* coder, int level) {
+    if(coder == nullptr || level < LZ77_MIN_LEVEL || level > LZ77_MAX_LEVEL) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(coder->streaming) {
+        return AH_BUSY;
+    }
+
+    return guarded([&] {
+        buildCompressor(coder, coder->blockSize, level, coder->maxCodeLength);
+        return AH_SUCCESS;
+    });
+}
+
+AH_API ah_status ah_coder_set_max_code_length(ah_coder* coder, int max_code_length) {
+    if(coder == nullptr || (max_code_length != NO_CODE_LENGTH_LIMIT &&
+                            (max_code_length < MIN_CODE_LENGTH_LIMIT || max_code_length > MAX_CODE_LENGTH_LIMIT))) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(coder->streaming) {
+        return AH_BUSY;
+    }
+
+    return guarded([&] {
+        buildCompressor(coder, coder->blockSize, coder->level, max_code_length);
+        return AH_SUCCESS;
+    });
+}
+
+AH_API ah_status ah_coder_set_tokens(ah_coder* coder, const char* dictionary, size_t dictionary_length) {
+    if(coder == nullptr || (dictionary == nullptr && dictionary_length > 0)) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(coder->streaming) {
+        return AH_BUSY;
+    }
+
+    return guarded([&] {
+        vector<string> tokens = parseTokenDictionary(string(dictionary == nullptr ? "" : dictionary, dictionary_length));
+        coder->compressor->useTokenDictionary(tokens);
+        coder->tokens = std::move(tokens);
+        return AH_SUCCESS;
+    });
+}
+
+AH_API ah_status ah_coder_set_threads(ah_coder* coder, unsigned thread_count) {
+    if(coder == nullptr) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(coder->streaming) {
+        return AH_BUSY;
+    }
+
+    return guarded([&] {
+        unique_ptr<HuffmanThreadPool> pool = thread_count > 0 ? make_unique<HuffmanThreadPool>(thread_count) : nullptr;
+        coder->compressor->useThreadPool(pool.get());
+        coder->pool = std::move(pool);
+        return AH_SUCCESS;
+    });
+}
+
+AH_API uint64_t ah_error_offset(const ah_coder* coder) {
+    return coder == nullptr ? 0 : coder->errorOffset;
+}
+
+AH_API ah_status ah_encode(ah_coder* coder, const void* message, size_t message_length, ah_mode mode, unsigned transforms,
+                           unsigned char** output, size_t* output_length) {
+    if(coder == nullptr || (message == nullptr && message_length > 0) || output == nullptr || output_length == nullptr ||
+       !validEncodeSettings(mode, transforms)) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(coder->streaming) {
+        return AH_BUSY;
+    }
+
+    return guarded([&] {
+        string container;
+        HuffmanResult result = coder->compressor->compress(string_view((const char*)message, message_length), HuffmanBlockMode(mode),
+                                                           container, uint8_t(transforms));
+
+        if(!result.ok()) {
+            return reportResult(coder, result);
+        }
+        return giveOutput(container, output, output_length);
+    });
+}
+
+AH_API ah_status ah_decode(ah_coder* coder, const void* container, size_t container_length, unsigned char** output, size_t* output_length) {
+    if(coder == nullptr || (container == nullptr && container_length > 0) || output == nullptr || output_length == nullptr) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(coder->streaming) {
+        return AH_BUSY;
+    }
+
+    return guarded([&] {
+        string message;
+        HuffmanResult result = coder->compressor->decompress(string_view((const char*)container, container_length), message);
+
+        if(!result.ok()) {
+            return reportResult(coder, result);
+        }
+        return giveOutput(message, output, output_length);
+    });
+}
+
+AH_API void ah_free(void* output) {
+    free(output);
+}
+
+AH_API ah_status ah_stream_create(ah_coder* coder, int encoding, ah_mode mode, unsigned transforms, ah_stream** stream) {
+    if(coder == nullptr || stream == nullptr || (encoding && !validEncodeSettings(mode, transforms))) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(coder->streaming) {
+        return AH_BUSY;
+    }
+
+    return guarded([&] {
+        *stream = new ah_stream{coder, encoding != 0, encoding ? HuffmanBlockMode(mode) : BLOCK_MODE_RAW,
+                                uint8_t(encoding ? transforms : AH_TRANSFORM_NONE), string(), 0, false, false, AH_SUCCESS, string()};
+        coder->streaming = true;
+        return AH_SUCCESS;
+    });
+}
+
+AH_API void ah_stream_free(ah_stream* stream) {
+    if(stream != nullptr) {
+        stream->coder->streaming = false;
+        delete stream;
+    }
+}
+
+AH_API ah_status ah_stream_write(ah_stream* stream, const void* input, size_t input_length, ah_write_fn write, void* context) {
+    if(stream == nullptr || (input == nullptr && input_length > 0) || write == nullptr) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(stream->failure != AH_SUCCESS) {
+        return stream->failure;
+    }
+    if(stream->finished) {
+        return AH_INVALID_ARGUMENT;
+    }
+
+    return guarded([&] {
+        stream->pending.append((const char*)input, input_length);
+        return codePending(stream, false, write, context);
+    });
+}
+
+AH_API ah_status ah_stream_finish(ah_stream* stream, ah_write_fn write, void* context) {
+    if(stream == nullptr || write == nullptr) {
+        return AH_INVALID_ARGUMENT;
+    }
+    if(stream->failure != AH_SUCCESS) {
+        return stream->failure;
+    }
+    if(stream->finished) {
+        return AH_INVALID_ARGUMENT;
+    }
+
+    return guarded([&] {
+        ah_status status = codePending(stream, true, write, context);
+        stream->finished = status == AH_SUCCESS;
+        return status;
+    });
+}
+
+AH_API void ah_stream_reset(ah_stream* stream) {
+    if(stream != nullptr) {
+        stream->pending.clear();
+        stream->consumed = 0;
+        stream->started = false;
+        stream->finished = false;
+        stream->failure = AH_SUCCESS;
+    }
+}
+
+}
@@ -0,0 +1,162 @@
+/*
+    Purpose: Give C programs, and anything else that can call C, the containers the command line program
+        writes, without starting it for every message. This header is plain C, and the library behind it,
+        libadaptivehuffman, is built from AdaptiveHuffman.cpp the way the README shows. Nothing of the C++
+        headers the library is written in comes through here, and everything the library exports starts
+        with ah_, so a program can link it next to anything else.
+
+        An ah_coder holds a compressor built over one alphabet, and is kept for as many messages as the
+        program likes, since building one is most of the cost of a small message. ah_encode and ah_decode
+        code a whole message at once, into memory the library allocates and ah_free gives back. An
+        ah_stream codes a message a piece at a time, handing its output to a callback as each run of whole
+        blocks is coded, and gives the same container ah_encode would. Every call returns an ah_status, and
+        ah_error_offset tells where in the input the last failure was.
+
+        A coder, and its stream, are for one thread at a time. Threads that want to code at the same time
+        each create their own coder. A coder with an open stream can't be used for anything else until the
+        stream is freed.
+
+        The numbers of the statuses, modes and transforms are the ones in the containers and in the C++
+        headers, and they, and the functions below, only ever have things added to them.
+*/
+#ifndef ADAPTIVE_HUFFMAN_H
+#define ADAPTIVE_HUFFMAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Creating the mark on everything the library exports, which is built with the rest of its symbols hidden
+#if defined(__GNUC__)
+#define AH_API __attribute__((visibility("default")))
+#else
+#define AH_API
+#endif
+
+// Creating the version of this header, which ah_version gives back for the library that was linked
+#define AH_VERSION 1
+
+// Creating the statuses. The first six are the HuffmanStatus values, and the rest are for the library itself
+typedef enum ah_status {
+    AH_SUCCESS = 0,
+    AH_INVALID_CHARACTER = 1,
+    AH_INVALID_BIT = 2,
+    AH_TRUNCATED_MESSAGE = 3,
+    AH_OUTPUT_FULL = 4,
+    AH_INVALID_HEADER = 5,
+
+    // A null handle or pointer, a mode, transform, level or code length limit we don't know, or a stream used after
+    //      it finished
+    AH_INVALID_ARGUMENT = 64,
+
+    // The alphabet, or the token dictionary, can't be built
+    AH_INVALID_ALPHABET = 65,
+
+    // Memory ran out part way through a call, which then did nothing
+    AH_OUT_OF_MEMORY = 66,
+
+    // The coder has a stream open
+    AH_BUSY = 67
+} ah_status;
+
+// Creating the block modes, which are the modes the command line takes
+typedef enum ah_mode {
+    AH_MODE_RAW = 0,
+    AH_MODE_ADAPTIVE = 1,
+    AH_MODE_SEMI_ADAPTIVE = 2,
+    AH_MODE_STATIC = 3,
+    AH_MODE_CONTEXT = 4,
+    AH_MODE_LZ77 = 5,
+    AH_MODE_BWT = 6,
+    AH_MODE_TOKEN = 7,
+    AH_MODE_UTF8 = 8,
+    AH_MODE_AUTO = 255
+} ah_mode;
+
+// Creating the transform flags, for the stages each block goes through before it is coded
+#define AH_TRANSFORM_NONE 0u
+#define AH_TRANSFORM_RLE 1u
+#define AH_TRANSFORM_MTF 2u
+#define AH_TRANSFORM_ALL 3u
+
+// Creating the handles, which only the library looks inside
+typedef struct ah_coder ah_coder;
+typedef struct ah_stream ah_stream;
+
+// Creating the callback a stream hands its output to. It returns 0 if it took the bytes, and anything else stops
+//      the stream with AH_OUTPUT_FULL
+typedef int (*ah_write_fn)(void* context, const unsigned char* data, size_t length);
+
+// Function that returns the AH_VERSION the library was built with
+AH_API int ah_version(void);
+
+// Function that returns a readable description of a status, which the caller doesn't free
+AH_API const char* ah_status_message(ah_status status);
+
+// Function that creates a coder over the alphabet, given as the bytes of the line an alphabet file holds. It codes
+//      with the default block size and LZ77 level, no code length limit, no token dictionary, and no threads of its own
+AH_API ah_status ah_coder_create(const char* alphabet, size_t alphabet_length, ah_coder** coder);
+
+// Function that frees a coder, which may be null. Its stream has to be freed first
+AH_API void ah_coder_free(ah_coder* coder);
+
+// Function that sets the largest number of bytes in a block, 0 for the default. Decoding takes any block size
+AH_API ah_status ah_coder_set_block_size(ah_coder* coder, size_t block_size);
+
+// Function that sets the level of the LZ77 match finder, from 1 to 9
+AH_API ah_status ah_coder_set_level(ah_coder* coder, int level);
+
+// Function that sets the longest code the adaptive trees may give a symbol, from 16 to 40 bits, or 0 for no limit.
+//      The container records it, so decoding needs no setting
+AH_API ah_status ah_coder_set_max_code_length(ah_coder* coder, int max_code_length);
+
+// Function that gives the coder the token dictionary, in the form of a --tokens= file. Token blocks are only
+//      written with one, and decoding them takes the dictionary they were written with
+AH_API ah_status ah_coder_set_tokens(ah_coder* coder, const char* dictionary, size_t dictionary_length);
+
+// Function that gives the coder threads of its own to code Burrows-Wheeler blocks on, in both directions. 0 goes
+//      back to coding them on the calling thread
+AH_API ah_status ah_coder_set_threads(ah_coder* coder, unsigned thread_count);
+
+// Function that returns where in its input the coder's last failed call went wrong: a byte of the message when
+//      encoding, or of the container when decoding. Only the statuses from AH_INVALID_CHARACTER to AH_INVALID_HEADER
+//      set it, so after any other it still describes an earlier call
+AH_API uint64_t ah_error_offset(const ah_coder* coder);
+
+// Function that compresses the message into a container, setting *output to memory holding it and *output_length
+//      to its size. The output is only set on success, and is freed with ah_free
+AH_API ah_status ah_encode(ah_coder* coder, const void* message, size_t message_length, ah_mode mode, unsigned transforms,
+                           unsigned char** output, size_t* output_length);
+
+// Function that decompresses a container the same way, into the message
+AH_API ah_status ah_decode(ah_coder* coder, const void* container, size_t container_length, unsigned char** output, size_t* output_length);
+
+// Function that frees output from ah_encode or ah_decode, which may be null
+AH_API void ah_free(void* output);
+
+// Function that opens a stream on the coder, which compresses a message with the mode and transforms if encoding
+//      is nonzero, and decompresses a container otherwise. The mode and transforms are ignored when decoding
+AH_API ah_status ah_stream_create(ah_coder* coder, int encoding, ah_mode mode, unsigned transforms, ah_stream** stream);
+
+// Function that frees a stream, which may be null, and leaves its coder free for other calls
+AH_API void ah_stream_free(ah_stream* stream);
+
+// Function that takes the next piece of the input, and hands the write callback whatever it lets us code. A
+//      failure is kept, and returned by every call on the stream until it is reset
+AH_API ah_status ah_stream_write(ah_stream* stream, const void* input, size_t input_length, ah_write_fn write, void* context);
+
+// Function that codes the rest of the input and hands it to the write callback. Once it succeeds, the stream
+//      takes no more input until it is reset
+AH_API ah_status ah_stream_finish(ah_stream* stream, ah_write_fn write, void* context);
+
+// Function that drops whatever the stream holds, and any failure it had, so it can code another message
+AH_API void ah_stream_reset(ah_stream* stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
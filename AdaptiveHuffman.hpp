@@ -0,0 +1,243 @@
+/*
+    Purpose: Give C++ programs that link libadaptivehuffman a way to use it that owns its handles and works
+        in strings, without taking in the headers the library is written in. Everything here is in the
+        adaptivehuffman namespace and goes through AdaptiveHuffman.h, so including it brings in no using
+        directive and none of the coders, and a program built against it only has to be rebuilt when the
+        C API changes. Constructors throw an adaptivehuffman::Error if the coder or stream can't be made,
+        and everything else returns a Result, the way the HuffmanResult methods do.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "AdaptiveHuffman.h"
+
+namespace adaptivehuffman {
+
+// Creating the block modes and transform flags, with the numbers AdaptiveHuffman.h gives them
+enum class Mode : int {
+    Raw = AH_MODE_RAW,
+    Adaptive = AH_MODE_ADAPTIVE,
+    SemiAdaptive = AH_MODE_SEMI_ADAPTIVE,
+    Static = AH_MODE_STATIC,
+    Context = AH_MODE_CONTEXT,
+    LZ77 = AH_MODE_LZ77,
+    BWT = AH_MODE_BWT,
+    Token = AH_MODE_TOKEN,
+    Utf8 = AH_MODE_UTF8,
+    Auto = AH_MODE_AUTO
+};
+
+constexpr unsigned TransformNone = AH_TRANSFORM_NONE;
+constexpr unsigned TransformRle = AH_TRANSFORM_RLE;
+constexpr unsigned TransformMtf = AH_TRANSFORM_MTF;
+constexpr unsigned TransformAll = AH_TRANSFORM_ALL;
+
+// Function that tells us whether the status is one of the coding failures, the only ones with an offset
+inline bool codingFailure(ah_status status) noexcept {
+    return status >= AH_INVALID_CHARACTER && status <= AH_INVALID_HEADER;
+}
+
+// Creating the result of a call: its status, and where in the input it went wrong if coding failed
+struct Result {
+    ah_status status;
+    std::uint64_t errorOffset;
+
+    // Function that tells the caller whether the call finished without an error
+    bool ok() const noexcept {
+        return status == AH_SUCCESS;
+    }
+
+    // Function that returns a readable description of the status
+    const char* message() const noexcept {
+        return ah_status_message(status);
+    }
+};
+
+// Creating the exception a constructor throws when the library can't make its handle
+class Error : public std::runtime_error {
+private:
+    ah_status status;
+
+public:
+    // Constructor that takes the status the library returned
+    explicit Error(ah_status status) : std::runtime_error(ah_status_message(status)), status(status) {}
+
+    // Function that returns the status the library returned
+    ah_status getStatus() const noexcept {
+        return this->status;
+    }
+};
+
+// Creating the coder class, which owns an ah_coder. See AdaptiveHuffman.h for what each call does
+class Coder {
+private:
+    ah_coder* handle;
+
+    // Function that turns a status from the library into a result. Only the coding failures set the offset, so
+    //      anything else gets 0 rather than where some earlier call went wrong
+    Result makeResult(ah_status status) const noexcept {
+        return Result{status, codingFailure(status) ? ah_error_offset(this->handle) : 0};
+    }
+
+    // Function that appends the output the library allocated onto the end of the string, and frees it
+    static void takeOutput(unsigned char* output, std::size_t length, std::string& into) {
+        try {
+            into.append((const char*)output, length);
+        }
+        catch(...) {
+            ah_free(output);
+            throw;
+        }
+        ah_free(output);
+    }
+
+public:
+    // Constructor that builds a coder over the alphabet, given as the line an alphabet file holds
+    explicit Coder(std::string_view alphabet) : handle(nullptr) {
+        ah_status status = ah_coder_create(alphabet.data(), alphabet.size(), &this->handle);
+
+        if(status != AH_SUCCESS) {
+            throw Error(status);
+        }
+    }
+
+    // A coder owns its handle, so it can be moved but not copied
+    Coder(const Coder&) = delete;
+    Coder& operator=(const Coder&) = delete;
+
+    Coder(Coder&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    Coder& operator=(Coder&& other) noexcept {
+        std::swap(this->handle, other.handle);
+        return *this;
+    }
+
+    // Destructor that frees the handle
+    ~Coder() {
+        ah_coder_free(this->handle);
+    }
+
+    // Functions that change the coder's settings
+    Result setBlockSize(std::size_t blockSize) noexcept {
+        return makeResult(ah_coder_set_block_size(this->handle, blockSize));
+    }
+
+    Result setLevel(int level) noexcept {
+        return makeResult(ah_coder_set_level(this->handle, level));
+    }
+
+    Result setMaxCodeLength(int maxCodeLength) noexcept {
+        return makeResult(ah_coder_set_max_code_length(this->handle, maxCodeLength));
+    }
+
+    Result setTokens(std::string_view dictionary) noexcept {
+        return makeResult(ah_coder_set_tokens(this->handle, dictionary.data(), dictionary.size()));
+    }
+
+    Result setThreads(unsigned threadCount) noexcept {
+        return makeResult(ah_coder_set_threads(this->handle, threadCount));
+    }
+
+    // Function that compresses the message into a container, appended onto the end of the string
+    Result compress(std::string_view message, std::string& container, Mode mode = Mode::Adaptive, unsigned transforms = TransformNone) {
+        unsigned char* output = nullptr;
+        std::size_t length = 0;
+        ah_status status = ah_encode(this->handle, message.data(), message.size(), ah_mode(mode), transforms, &output, &length);
+
+        if(status == AH_SUCCESS) {
+            takeOutput(output, length, container);
+        }
+        return makeResult(status);
+    }
+
+    // Function that decompresses the container, appending the message onto the end of the string
+    Result decompress(std::string_view container, std::string& message) {
+        unsigned char* output = nullptr;
+        std::size_t length = 0;
+        ah_status status = ah_decode(this->handle, container.data(), container.size(), &output, &length);
+
+        if(status == AH_SUCCESS) {
+            takeOutput(output, length, message);
+        }
+        return makeResult(status);
+    }
+
+    // Function that returns the handle, for calls this class doesn't wrap
+    ah_coder* get() const noexcept {
+        return this->handle;
+    }
+};
+
+// Creating the stream class, which owns an ah_stream open on a coder. The coder has to outlive it, and can't be used
+//      for anything else while it does
+class Stream {
+private:
+    ah_stream* handle;
+    ah_coder* coder;
+
+    // Function that the library hands output to, which appends it onto the end of the string it was given
+    static int appendOutput(void* context, const unsigned char* data, std::size_t length) {
+        try {
+            static_cast<std::string*>(context)->append((const char*)data, length);
+            return 0;
+        }
+        catch(...) {
+            return 1;
+        }
+    }
+
+    // Function that turns a status from the library into a result, with the offset if coding failed
+    Result makeResult(ah_status status) const noexcept {
+        return Result{status, codingFailure(status) ? ah_error_offset(this->coder) : 0};
+    }
+
+public:
+    // Constructor that opens a stream on the coder, which compresses with the mode and transforms if encoding is
+    //      true and decompresses otherwise
+    Stream(Coder& coder, bool encoding, Mode mode = Mode::Adaptive, unsigned transforms = TransformNone)
+        : handle(nullptr), coder(coder.get()) {
+        ah_status status = ah_stream_create(this->coder, encoding ? 1 : 0, ah_mode(mode), transforms, &this->handle);
+
+        if(status != AH_SUCCESS) {
+            throw Error(status);
+        }
+    }
+
+    // A stream owns its handle, so it can be moved but not copied
+    Stream(const Stream&) = delete;
+    Stream& operator=(const Stream&) = delete;
+
+    Stream(Stream&& other) noexcept : handle(std::exchange(other.handle, nullptr)), coder(other.coder) {}
+
+    Stream& operator=(Stream&& other) noexcept {
+        std::swap(this->handle, other.handle);
+        std::swap(this->coder, other.coder);
+        return *this;
+    }
+
+    // Destructor that frees the handle, which leaves the coder free again
+    ~Stream() {
+        ah_stream_free(this->handle);
+    }
+
+    // Function that takes the next piece of the input, appending whatever can be coded so far onto the output
+    Result write(std::string_view input, std::string& output) noexcept {
+        return makeResult(ah_stream_write(this->handle, input.data(), input.size(), &Stream::appendOutput, &output));
+    }
+
+    // Function that codes the rest of the input, appending it onto the output
+    Result finish(std::string& output) noexcept {
+        return makeResult(ah_stream_finish(this->handle, &Stream::appendOutput, &output));
+    }
+
+    // Function that drops whatever the stream holds, so it can code another message
+    void reset() noexcept {
+        ah_stream_reset(this->handle);
+    }
+};
+
+}
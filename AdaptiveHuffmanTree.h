@@ -4,63 +4,111 @@
         take a string as a parameter. This string should be the alphabet that will be used
         for the encode or decode operation. Each method should take a string as a parameter and
         return a string. The driver program should accept 3 command line arguments. For encoding,
-        the program should create a new file that is named with the original file name with the 
+        the program should create a new file that is named with the original file name with the
         extension .encoded appended. And with decoding, the file should be appending with .decoded.
     Course: CPTS 223
     Date: 11/8/22
+
+    The tree itself is BasicAdaptiveHuffmanTree, a template over the symbol type, the count type, and the
+    most symbols a tree can hold, so the same engine can code bytes, 16 bit tokens, or 32 bit values, and
+    small alphabets can use narrow counts. AdaptiveHuffmanTree is the byte tree every coder uses, with the
+    string alphabet and the '0'/'1' and packed message methods on top.
 */
 #pragma once
 #include <iostream>
 #include "HuffmanException.h"
+#include "HuffmanResult.h"
+#include "AlphabetScanner.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanAlphabet.h"
+#include <algorithm>
 #include <cmath>
 #include <bitset>
+#include <cstdint>
 #include <cstring>
+#include <limits>
 #include <string>
+#include <string_view>
+#include <memory>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 using namespace std;
 
-// Creating the constant variable for the size of our alphabet array. With our process of 
-//      correctly reading in the characters that start with the escape sequence, there are 
-//      a empty array elements set to the NULL character, so instead of the 256 sized array,
-//      we will do 300 for safe measures
-const int ALPHABET_ARRAY_SIZE = 300;
+// Creating the limits on the longest code a tree may be asked to keep to. A limit of zero means no limit. The
+//      suggested limit keeps every code inside a 32 bit word. Below the smallest limit, halving the counts of a
+//      full alphabet might not bring the tree back under its limit, and above the largest the root's count
+//      would no longer fit an int
+const int NO_CODE_LENGTH_LIMIT = 0;
+const int DEFAULT_CODE_LENGTH_LIMIT = 24;
+const int MIN_CODE_LENGTH_LIMIT = 16;
+const int MAX_CODE_LENGTH_LIMIT = 40;
+
+// Creating the largest symbol value that gets a direct lookup table. Symbols above it are found by a binary
+//      search instead, so a tree over a few scattered 32 bit values doesn't need a table billions of entries long
+const uint32_t DENSE_SYMBOL_INDEX_LIMIT = 1 << 20;
+
+// Function that returns the root count at which a tree limited to maxCodeLength has to be rescaled. A Huffman tree
+//      whose leaves all have a count of at least one needs a total count of at least the Fibonacci number F(d + 2)
+//      to be d deep, and the zero node adds at most one more level under that. So as long as the root's count stays
+//      below F(maxCodeLength + 2), no code is longer than maxCodeLength
+constexpr int codeLengthLimitCount(int maxCodeLength) {
+    int previous = 1;
+    int current = 1;
+
+    for(int i = 2; i < maxCodeLength + 2; i++) {
+        int following = previous + current;
+        previous = current;
+        current = following;
+    }
+
+    return current - 1;
+}
 
-// Creating a const variable for the backslash and single quote ASCII value
-const int BACKSLASH_ASCII_VALUE = 92;
-const int SINGLE_QUOTE_ASCII_VALUE = 39;
+// Function that returns how many bits a new symbol is written with, for an alphabet whose largest symbol is given.
+//      That is enough bits for the largest symbol, and never fewer than eight, which is what the byte tree has always
+//      written
+constexpr int symbolLiteralBits(uint64_t largest) {
+    int bits = 8;
+    while(bits < 32 && (largest >> bits) != 0) {
+        bits++;
+    }
+    return bits;
+}
 
-// Creating our Adaptive Huffman Node class
-class HuffmanNode 
+// Creating our Adaptive Huffman Node class, over the type of the symbol a leaf holds and the type of its count
+template<class Symbol, class Count>
+class BasicHuffmanNode
 {
     // Declaring our private members of the HuffmanNode
-    private:    
+    private:
     // In each node, there will be five pointers. Pointers to the node's parent, to the node previous
     //      in the thread, to the node next in the thread, and pointers to the node's left and right child
-    HuffmanNode* parent;
-    HuffmanNode* prev;
-    HuffmanNode* next;
-    HuffmanNode* left;
-    HuffmanNode* right;
-
-    // We will create another node pointer that will only be used by the nodes within the alphabet array. 
-    //      This node will be set when we add a new character to the tree, and used to jump that character
-    //      node, whenever we need to obtain the path from the root to that node
-    HuffmanNode* alphabet;
+    BasicHuffmanNode* parent;
+    BasicHuffmanNode* prev;
+    BasicHuffmanNode* next;
+    BasicHuffmanNode* left;
+    BasicHuffmanNode* right;
 
     // And in each node, there will be a count variable and a character data member. Nodes that are only
-    //      for keeping the count will have characters of null
-    int count;
-    char character;
+    //      for keeping the count will have characters of zero
+    Count count;
+    Symbol character;
 
     // In our public section, we will have the node constructors and the getter and setter functions
     public:
 
     // Default constructor for the node, which sets every pointer to the nullptr and the count and character
     //      to one and empty, respectively.
-    HuffmanNode() {
+    BasicHuffmanNode() {
         /*
             The default constructor will be used to create the nodes that keep the counts and do not represent
-            a character in the tree. 
-            
+            a character in the tree.
+
             And since each new node is first intialized to one, that is why the count starts at one.
         */
         parent = nullptr;
@@ -68,1486 +116,1652 @@ class HuffmanNode
         next = nullptr;
         left = nullptr;
         right = nullptr;
-        alphabet = nullptr;
         count = 1;
-
-        // Intializing the character member to be the char equivalent to NULL, so that it will
-        //      never match with any other possible character in a message
-        character = char(0);
+        character = Symbol(0);
     }
 
     // Overloaded constructor for the node
-    HuffmanNode(char character) {
+    BasicHuffmanNode(Symbol character) {
         parent = nullptr;
         prev = nullptr;
         next = nullptr;
         left = nullptr;
         right = nullptr;
-        alphabet = nullptr;
         /*
-            Since this overloaded constructor will be used when a new character is encountered, 
-            the default count will be 1. 
-            
-            With new nodes that will be only for keeping the count, those character values passed 
-            will also be the empty character.       
+            Since this overloaded constructor will be used when a new character is encountered,
+            the default count will be 1.
         */
         count = 1;
         this->character = character;
     }
 
     // Setter function for the character in the node
-    void setCharacter(char c) {
+    void setCharacter(Symbol c) {
         this->character = c;
     }
 
     // Getter function to obtain the character held in the node
-    char getCharacter() {
+    Symbol getCharacter() const {
         return this->character;
     }
 
     // Function that will set the parent of the node
-    void setParentNode(HuffmanNode* parent) {
+    void setParentNode(BasicHuffmanNode* parent) {
         this->parent = parent;
     }
 
     // Function that will return a pointer to the parent's node
-    HuffmanNode* getParentNode() {
+    BasicHuffmanNode* getParentNode() const {
         return this->parent;
     }
 
     // Function that will set the node's previous node in the chain
-    void setPrevNode(HuffmanNode* prev) {
-        this->prev = prev;     
+    void setPrevNode(BasicHuffmanNode* prev) {
+        this->prev = prev;
     }
 
     // Function that will get the node previous to the current node
-    HuffmanNode* getPrevNode() {
+    BasicHuffmanNode* getPrevNode() const {
         return this->prev;
     }
 
     // Function that will set the node's next node in the chain
-    void setNextNode(HuffmanNode* next) {
+    void setNextNode(BasicHuffmanNode* next) {
         this->next = next;
     }
 
     // Function that will get the node next up in the chain from the current node
-    HuffmanNode* getNextNode() {
+    BasicHuffmanNode* getNextNode() const {
         return this->next;
     }
 
     // Function that will set the node's left child
-    void setLeftNode(HuffmanNode* left) {
+    void setLeftNode(BasicHuffmanNode* left) {
         this->left = left;
     }
 
     // Function that will get the left child of the node
-    HuffmanNode* getLeftNode() {
+    BasicHuffmanNode* getLeftNode() const {
         return this->left;
     }
 
     // Function that will set the node's right child
-    void setRightNode(HuffmanNode* right) {
+    void setRightNode(BasicHuffmanNode* right) {
         this->right = right;
     }
 
     // Function that will return the node's right child
-    HuffmanNode* getRightNode() {
+    BasicHuffmanNode* getRightNode() const {
         return this->right;
     }
 
-    // Function that will be used with the nodes in our alphabet array. When a new character
-    //      is added to the tree, the node in the alphabet array that the character matches
-    //      will have their alphabet node set to that character node in the tree
-    void setAlphabetNode(HuffmanNode* alpha) {
-        this->alphabet = alpha;
+    // Function to update the count of a huffman node. The change can be negative, and with an unsigned count
+    //      it wraps around to the same result
+    void updateCount(int var) {
+        this->count = Count(this->count + Count(var));
     }
 
-    // This function will return the huffman node within the tree that our alphabet array node
-    //      pointer is pointing to. This will allow us to jump to the character node and easily
-    //      manipulate it and get the path from the root to that node for output.
-    HuffmanNode* getAlphabetNode() {
-        return this->alphabet;
+    // Function that returns the count of a node
+    Count getCount() const {
+        return this->count;
     }
 
-    // Function to update the count of a huffman node
-    void updateCount(int var) {
-        this->count += var;
+};
+
+// Creating the node the byte tree is built from
+using HuffmanNode = BasicHuffmanNode<uint8_t, int32_t>;
+
+// Creating the symbols of an alphabet and the lookup from a symbol to its place among them. A table never
+//      changes once it is built, so a tree and all of its clones share one
+template<class Symbol>
+class HuffmanSymbolTable {
+private:
+    // Creating the symbols in the order they were first given, the direct lookup for symbols up to the largest
+    //      one (or DENSE_SYMBOL_INDEX_LIMIT), and the sorted list the rest are searched for in
+    vector<Symbol> symbols;
+    vector<int32_t> denseIndex;
+    vector<pair<Symbol, int32_t>> sparseIndex;
+    int literalBits;
+
+public:
+    // Constructor that takes the list of symbols. A symbol that comes up again is only kept the first time
+    HuffmanSymbolTable(const Symbol* list, size_t count) : literalBits(8) {
+        unordered_set<Symbol> seen;
+        uint64_t largest = 0;
+
+        for(size_t i = 0; i < count; i++) {
+            if(seen.insert(list[i]).second) {
+                this->symbols.push_back(list[i]);
+                largest = max<uint64_t>(largest, uint64_t(list[i]));
+            }
+        }
+
+        this->literalBits = symbolLiteralBits(largest);
+
+        this->denseIndex.assign(size_t(min<uint64_t>(largest + 1, DENSE_SYMBOL_INDEX_LIMIT)), -1);
+
+        for(size_t i = 0; i < this->symbols.size(); i++) {
+            uint64_t value = uint64_t(this->symbols[i]);
+
+            if(value < this->denseIndex.size()) {
+                this->denseIndex[size_t(value)] = (int32_t)i;
+            }
+            else {
+                this->sparseIndex.push_back(make_pair(this->symbols[i], (int32_t)i));
+            }
+        }
+
+        sort(this->sparseIndex.begin(), this->sparseIndex.end());
     }
 
-    // Function that returns the count of a node
-    int getCount() {
-        return this->count;
+    // Function that returns the number of symbols
+    size_t size() const noexcept {
+        return this->symbols.size();
+    }
+
+    // Function that returns the symbols, in the order they were given
+    const Symbol* data() const noexcept {
+        return this->symbols.data();
+    }
+
+    // Function that returns the direct lookup table and its length
+    const int32_t* denseData() const noexcept {
+        return this->denseIndex.data();
+    }
+
+    size_t denseSize() const noexcept {
+        return this->denseIndex.size();
     }
 
+    // Function that returns the number of bits a new symbol is written with
+    int getLiteralBits() const noexcept {
+        return this->literalBits;
+    }
+
+    // Function that finds a symbol too large for the direct lookup, returning -1 if it isn't in the alphabet
+    int findSparse(Symbol symbol) const noexcept {
+        auto found = lower_bound(this->sparseIndex.begin(), this->sparseIndex.end(), make_pair(symbol, int32_t(-1)));
+
+        if(found == this->sparseIndex.end() || found->first != symbol) {
+            return -1;
+        }
+        return found->second;
+    }
 };
 
-// Creating the Adaptive Huffman Algorithm class to handle our encoding and decoding
-class AdaptiveHuffmanTree 
+// Creating the Adaptive Huffman Algorithm class to handle our encoding and decoding, over the symbol type, the
+//      count type, and the most symbols one tree can hold. The symbol is an unsigned type of up to 32 bits. A count
+//      narrower than 32 bits can't count a long message, so such a tree always keeps to a code length limit, which
+//      rescales the counts long before they overflow
+template<class Symbol, class Count, int MaxSymbols>
+class BasicAdaptiveHuffmanTree
 {
-    private:
+    static_assert(is_integral<Symbol>::value && is_unsigned<Symbol>::value && sizeof(Symbol) <= 4, "Symbols must be unsigned and at most 32 bits");
+    static_assert(is_integral<Count>::value && sizeof(Count) >= 2, "Counts must be integers of at least 16 bits");
+    static_assert(MaxSymbols > 0 && (sizeof(Symbol) >= 4 || MaxSymbols <= (1 << (8 * sizeof(Symbol)))), "The symbol type can't tell that many symbols apart");
+
+    public:
+    // Creating the node type of this tree
+    using Node = BasicHuffmanNode<Symbol, Count>;
+
+    // Creating the longest code limit whose rescale count still fits the count type
+    static constexpr int maxCodeLengthLimit() {
+        int limit = MIN_CODE_LENGTH_LIMIT;
+        while(limit < MAX_CODE_LENGTH_LIMIT && uint64_t(codeLengthLimitCount(limit + 1)) <= uint64_t(numeric_limits<Count>::max())) {
+            limit++;
+        }
+        return limit;
+    }
+
+    // Creating the shortest code limit at which halving the counts of a full alphabet always leaves room to grow.
+    //      Every leaf keeps a count of at least one, so the rescale count has to be well above the number of leaves
+    static constexpr int minCodeLengthLimit() {
+        int limit = MIN_CODE_LENGTH_LIMIT;
+        while(uint64_t(codeLengthLimitCount(limit)) < 4 * uint64_t(MaxSymbols + 1)) {
+            limit++;
+        }
+        return limit;
+    }
+
+    static_assert(minCodeLengthLimit() <= maxCodeLengthLimit(), "The count type is too narrow for that many symbols");
+
+    // Creating whether the count type is too narrow to go without a code length limit
+    static constexpr bool needsCodeLengthLimit = numeric_limits<Count>::digits < 31;
+
+    // Creating the number of 64 bit words a path from the root can take. A tree over MaxSymbols symbols and the
+    //      zero node can't be deeper than MaxSymbols
+    static constexpr int PATH_WORDS = MaxSymbols / 64 + 1;
+
+    // Creating whether the tree keeps an index of the leader of each count. Trees over more symbols than a byte
+    //      alphabet can have blocks of thousands of nodes with the same count, and walking up a block to find its
+    //      leader would make every update that slow. Counts from LEADER_COUNTS up are rare enough to walk
+    static constexpr bool TRACK_LEADERS = MaxSymbols > 256;
+    static constexpr size_t LEADER_COUNTS = size_t(1) << 16;
+
+    protected:
     // Creating a node pointer to keep track of the root of our tree
-    HuffmanNode* root;
+    Node* root;
 
     // Creating a node pointer that will keep track of the zero node of the tree
-    HuffmanNode* zeroNode;
-
-    // Creating an array to store all of the possible letters in the alphabet of characters. This array
-    //      stores pointers to huffman nodes when they are placed into the tree. And we are initialzing 
-    HuffmanNode alphabetArray[ALPHABET_ARRAY_SIZE];
+    Node* zeroNode;
+
+    // Creating the alphabet's symbols and their lookup, shared with every clone of the tree, along with the
+    //      pointers into it the coding loops use. A tree built on a compiled alphabet has no table, and its
+    //      pointers lead straight into the compiled alphabet instead
+    shared_ptr<const HuffmanSymbolTable<Symbol>> table;
+    const Symbol* symbols;
+    const int32_t* symbolIndex;
+    size_t symbolIndexSize;
+    int symbolCount;
+    int literalBits;
+
+    // Creating the array from each symbol's place in the alphabet to its leaf in the tree, which is nullptr until the
+    //      symbol has been seen. It lives on the heap along with the node storage, so moving a tree only has to hand
+    //      over the pointers
+    unique_ptr<Node*[]> leaves;
+
+    // Creating the storage that every node in the tree comes from. The zero node is always the first element,
+    //      and the nodes for new characters are handed out in order after it, so resetting the tree is just
+    //      a matter of starting over at the front instead of freeing and allocating nodes. Every new symbol adds
+    //      a character node and a counter node, so along with the zero node twice the alphabet plus one is enough
+    unique_ptr<Node[]> nodeStorage;
+
+    // Creating a variable to keep track of how many elements of the node storage are in use
+    int nodesUsed;
+
+    // Creating the longest code the tree keeps to (zero for no limit), and the root count at which we rescale the
+    //      tree to keep to it
+    int maxCodeLength;
+    int rescaleCount;
+
+    // Creating the leader of each count, the node closest to the root with that count, when the tree keeps track of
+    //      them. An entry is either right or fails the check in jumpToLeader, in which case we walk to the leader
+    vector<Node*> leaders;
 
     public:
-    // Creating our overloaded constructor that takes in the alphabet string as its parameter
-    AdaptiveHuffmanTree(string alphabet) {
-        // First, to distribute the alphabet characters passed into the constructor, we will cast the 
-        //      string into a c-string, so we can easily manipulate and place each node in the array
-        const char* alphabetCString = alphabet.c_str();
+    // Creating our constructor that takes in the list of symbols in the alphabet. The optional third parameter caps
+    //      the length of every code (not counting the bits after the zero node's code), so that coding a symbol never
+    //      walks more than that many levels. Trees only read what trees with the same limit wrote. A HuffmanException
+    //      is thrown if the alphabet has more than MaxSymbols symbols
+    BasicAdaptiveHuffmanTree(const Symbol* alphabet, size_t alphabetSize, int maxCodeLength = NO_CODE_LENGTH_LIMIT) {
+        useCodeLengthLimit(maxCodeLength);
+        useTable(make_shared<const HuffmanSymbolTable<Symbol>>(alphabet, alphabetSize));
+        allocateStorage();
+    }
 
-        // Creating a huffman node pointer for our zero node
-        zeroNode = new HuffmanNode();
+    // A tree owns all of its nodes, and the nodes point at each other, so a plain member by member copy would
+    //      leave two trees sharing (and corrupting) the same nodes. Copying is therefore not allowed; use
+    //      clone() to get an independent copy
+    BasicAdaptiveHuffmanTree(const BasicAdaptiveHuffmanTree&) = delete;
+    BasicAdaptiveHuffmanTree& operator=(const BasicAdaptiveHuffmanTree&) = delete;
 
-        // Subtracting one from the zeroNode's count to make its count zero
-        zeroNode->updateCount(-1);
+    // Move constructor. The new tree takes over the other tree's node storage and leaf array, and the other
+    //      tree is left empty. An empty tree may only be destroyed or assigned to
+    BasicAdaptiveHuffmanTree(BasicAdaptiveHuffmanTree&& other) noexcept {
+        takeFrom(other);
+    }
 
-        // Assigning the root node to point to our zero node for the tree
-        this->root = zeroNode;
-
-        // Now, we will run through the entire alphabet with a for loop based on the length of the string
-        // In this for loop, for each letter of the alphabet, we will create a huffman node that has that 
-        //      character assigned to its character data member. And for the intialization of the node, 
-        //      each node will point to the nullptr.
-        for(int i = 0; i < strlen(alphabetCString); i++) {
-            // Making a temporary node that will be intialized with a character from the alphabet, and stored
-            //      into the alphabet array
-            HuffmanNode tempNode(alphabetCString[i]);
-
-            // Getting the ascii reprensentation of the current character we are looking at
-            int ascii = int(alphabetCString[i]);
-
-            // With this if statement, we are checking to see if the current character we are reading in
-            //      is a single backslash. If it is, we know that the following chracter will have to be attached
-            //      to and it will create a single character with the escape sequence, not a backslash and a character
-            if(ascii == BACKSLASH_ASCII_VALUE) {
-                // Switch statement that will look ahead to the next character in the string after the backslash
-                //      and depening on the character's ascii value, we will input a non-printable character
-                //      into our alphabet array
-                switch(int(alphabetCString[i+1])) {
-                    // Our case for the Alert escape sequence
-                    case int('a'): 
-                        tempNode = '\a';
-                        break;
-
-                    // Case to handle the Backspace
-                    case int('b'): 
-                        tempNode = '\b';
-                        break;
-
-                    // Case to handle the Form Feed (new page)
-                    case int('\f'): 
-                        tempNode = '\f';
-                        break;
-                        
-                    // Case to handle the Vertical Tab
-                    case int('v'): 
-                        tempNode = '\v';
-                        break;
-                        
-                    // Case to handle the New-line
-                    case int('n'):
-                        tempNode = '\n';
-                        break;
-                        
-                    // Case to handle the Horizontal Tab
-                    case int('t'): 
-                        tempNode = '\t';
-                        break;
-                        
-                    // Case to handle the Carriage Return
-                    case int('r'): 
-                        tempNode = '\r';
-                        break;
-                                            
-                    // Case to handle the Backslash
-                    case int('\\'): 
-                        tempNode = '\\';
-                        break;
-                        
-                    // Case to handle the Single Quotation Mark. Note with this, we are just using
-                    //      the ascii value itself
-                    case SINGLE_QUOTE_ASCII_VALUE: 
-                        tempNode = '\'';
-                        break;
-                        
-                    // Case to handle the Double Quotation Mark
-                    case int('"'): 
-                        tempNode = '\"';
-                        break;
-                                            
-                    // Case to handle the Backspace
-                    case int('?'): 
-                        tempNode = '\?';
-                        break;
-                }
+    // Move assignment, which frees this tree's nodes and takes over the other tree's
+    BasicAdaptiveHuffmanTree& operator=(BasicAdaptiveHuffmanTree&& other) noexcept {
+        if(this != &other) {
+            takeFrom(other);
+        }
+        return *this;
+    }
 
-                // Now placing the node into the alphabet array
-                this->alphabetArray[i] = tempNode;
+    // Function that returns an independent deep copy of this tree, including everything it has adapted to so far.
+    //      This lets a caller fork a stream, for example to try two ways of encoding what comes next and keep the
+    //      better one
+    BasicAdaptiveHuffmanTree clone() const {
+        BasicAdaptiveHuffmanTree copy;
+        cloneInto(copy);
+        return copy;
+    }
 
-                // Incrementing the i value, since we already read the next character and need
-                //      to jump to the one after it in the sequence
-                i++;
+    // Function that puts the tree back into the state it was in right after construction, so it can code another
+    //      message that a freshly constructed tree will be able to read. Only the nodes that were handed out and the
+    //      leaf array are touched, and nothing is allocated, so this is much cheaper than building a new tree
+    void reset() noexcept {
+        for(int i = 0; i < this->symbolCount; i++) {
+            this->leaves[i] = nullptr;
+        }
 
-                // Inserting the char equivalent to NULL, since with each escape character 
-                //      processing, we bypass an i-value, so an array element is skipped. This 
-                //      way, we fill the element with NULL, to ensure no random values do.
-                this->alphabetArray[i] = char(0);
-            } 
+        resetNodes();
+    }
 
-            // Else, the character is normal, so we place the node into the alphabet array
-            else {
-                this->alphabetArray[i] = tempNode;
+    // Function that returns the number of symbols in the alphabet
+    int getSymbolCount() const noexcept {
+        return this->symbolCount;
+    }
+
+    // Function that returns the symbol at the given place in the alphabet
+    Symbol getSymbol(int index) const noexcept {
+        return this->symbols[index];
+    }
+
+    // Function that returns the place of a symbol in the alphabet, or -1 if it isn't in it
+    int indexOf(Symbol symbol) const noexcept {
+        if(size_t(symbol) < this->symbolIndexSize) {
+            return this->symbolIndex[size_t(symbol)];
+        }
+        return this->table ? this->table->findSparse(symbol) : -1;
+    }
+
+    // Function that returns the longest code the tree keeps to, or zero if it has no limit
+    int getMaxCodeLength() const noexcept {
+        return this->maxCodeLength;
+    }
+
+    // Function that returns the number of bits written after the zero node's code for a new symbol
+    int getLiteralBits() const noexcept {
+        return this->literalBits;
+    }
+
+    // Function that returns the most bits encoding a message of the given length can take. Every symbol costs
+    //      at most the depth of the tree, which can't be more than the number of symbols in the alphabet (or the
+    //      code length limit), and the first time each symbol appears it also costs its literal bits.
+    uint64_t maxEncodedBits(size_t messageLength) const noexcept {
+        uint64_t alphabetSize = uint64_t(this->symbolCount);
+        uint64_t newCharacters = messageLength < alphabetSize ? messageLength : alphabetSize;
+        uint64_t longestCode = this->maxCodeLength != NO_CODE_LENGTH_LIMIT ? uint64_t(this->maxCodeLength) : alphabetSize;
+        return uint64_t(messageLength) * longestCode + uint64_t(getLiteralBits()) * newCharacters;
+    }
+
+    // Function that returns the size of a caller buffer that is always big enough for the packed encode method
+    size_t maxEncodedBytes(size_t messageLength) const noexcept {
+        return size_t((maxEncodedBits(messageLength) + 7) / 8);
+    }
+
+    // Function that checks every symbol of a message against the alphabet before any tree work is done. The result
+    //      holds the offset of the first symbol that is not in the alphabet
+    HuffmanResult validateSymbols(const Symbol* message, size_t messageLength) const noexcept {
+        for(size_t i = 0; i < messageLength; i++) {
+            if(indexOf(message[i]) == -1) {
+                return huffmanFailure(HUFFMAN_INVALID_CHARACTER, i);
             }
         }
+
+        return huffmanSuccess();
     }
 
-    // Creating our encode method that takes in the string message that will be encoded as a parameter. This method
-    //      then returns the encoded version of the original message as a string.
-    string encode(string messageString) {
-        // Creating a large try-catch block to handle the error we get if a character in the message is not in the 
-        //     alphabet array
-        try {
-            // Our first task in the encoding process will be to cast the string message into a c_string so we can 
-            //      easily access each character
-            const char* message = messageString.c_str();
-
-            // Creating the encoded message string that will be used to track and hold the output of our message
-            //      while work through the process of encoding it
-            string encodedMessage;
-
-            // Now, we will create a for loop that will iterate through the total length of the string message
-            for(int i = 0; i < strlen(message); i++) {
-
-                // First we will create pointers to our two new nodes in the tree: the character node and the 
-                //      its parent counter node
-                HuffmanNode* counterNode = new HuffmanNode();
-
-                // For the character node, we are intializing it with the character in our message that we are currently
-                //      encoding
-                HuffmanNode* characterNode = new HuffmanNode();
-
-                // Creating a temporary string variable that will be used to store the eight bit representation
-                //      of each character output
-                string stringBits;
-
-                // Creating a boolean variable that will be used in our conditional checking to help see if a character
-                //      is within our alphabet array
-                bool isFound = false;
-
-                // Creating another boolean variable to keep track of where we are at while traversing up the chain
-                bool endOfChain = false;
-
-                // Creating an int variable to keep track of the leader count while checking the chain
-                int leaderCount;
-
-                // Creating a string that will be appended to, so we can hold the 1's and 0's as we traverse up the tree 
-                //      to obtain the path from the root to a node
-                string reversePath;
-
-                // Creating another string to hold the result from the reverseString method, which will be the correct path
-                //      from the root to a given node
-                string correctPath;
-
-                // Creating a traversal node that will be used to obtain the path from the root to a given node
-                HuffmanNode* traversalNode = nullptr;
-
-                // Creating a temporary node pointer to keep track of the current node we are on
-                HuffmanNode* currentNode = nullptr;
-
-                // Creating a temporary node pointer to get the parent of each node, while we traverse and update our tree
-                HuffmanNode* parentNode = nullptr;
-
-                // Creating two node pointers, one for the next node in the chain and one for the previous node in the cahin
-                HuffmanNode* prevNode = nullptr;
-                HuffmanNode* nextNode = nullptr;
-
-                // Creating a node pointer called swapNode, to help keep track of the node that we swap with another
-                //      leaf chracter node
-                HuffmanNode* swapNode = nullptr;
-
-                // For our swapping process, we will obtain the parent, next, and prev pointers for both the next node and
-                //      the swap node, that are switching places. Below, we create all of them.
-                HuffmanNode* nextNodeParent = nullptr;
-                HuffmanNode* nextNodeNext = nullptr;
-                HuffmanNode* nextNodePrev = nullptr;
-                HuffmanNode* swapNodeParent = nullptr;
-                HuffmanNode* swapNodeNext = nullptr;
-                HuffmanNode* swapNodePrev = nullptr;
-
-                // Creating a accumlator integer to also help with our check to see if a character is in our array
-                int index = 0;
-                
-                // Our first action is to check whether or not the character that we are encoding is a character
-                //      within our pre-set alphabet array. To do this, we will use a while loop and our 
-                //      conditional check will be either if the character was found or we reach the end of the array
-                while(!isFound && (index != ALPHABET_ARRAY_SIZE - 1)) {
-                    // Using an if statement to check if a character matches
-                    if(message[i] == alphabetArray[index].getCharacter()) {
-                        // Entering the if statement, we will know our character is in the alphabet, so we set
-                        //      isFound to be true
-                        isFound = true;
-                    }
+    // Creating the encode method for a message of symbols, which writes packed bits into a caller's sink
+    HuffmanResult encode(const Symbol* message, size_t messageLength, HuffmanSink& sink) noexcept {
+        HuffmanResult validation = validateSymbols(message, messageLength);
 
-                    // Else statement that will increment the index variable to go to the next array element
-                    else {
-                        index++;
-                    }          
-                }
+        if(!validation.ok()) {
+            return validation;
+        }
 
-                // Using an if else statement, we will check if the character was found in the array. If it is found,
-                //       we will start the next process by checking if the corresponding node in the alphabet array
-                //      is pointing a node in the tree. In other words, we will see if the character node already exists
-                if(isFound) {
-                    // Checking to see if the alphabet array element is pointing to a character node. If the character node
-                    //       doesn't exist we will have our first case, which is that we need to add the character node 
-                    //       and its parent counter node into the huffman tree
-                    if(alphabetArray[index].getAlphabetNode() == nullptr) { 
-                        // For the characterNode that we are adding to the tree, we will set its character member
-                        //      to the new character from the message
-                        characterNode->setCharacter(message[i]);
-
-                        // Now, since the character node doesn't exist, we need to determine the path from the root node
-                        //      to the zero node, so we can output it to our endoded message string. In this event, we 
-                        //      have two cases: 1. The zero node is the root and 2. The zero node is not the root. 
-                        // Checking to see if the zero is the root
-                        if(this->root == this->zeroNode) {
-                            // Within in this if statement, we will handle the case when the zero node is the root 
-                            //      i.e. when this is our first character being introduced into the tree
-                            // In this case, the path from the root to the zero is nothing, so we will simply 
-                            //      output the bits of the character to our encoded message. To do this, we will 
-                            //      utilize the bitset class to convert the character to bits.
-                            bitset<8> characterBits(message[i]);
-
-                            // Now, we will convert the eight bit representation of the character to a string variable
-                            stringBits = characterBits.to_string();
-
-                            // And now, we will append the string to our encoded message string
-                            encodedMessage.append(stringBits);
-                        } 
-
-                        // Else statement that will traverse from the zero node up to the root, to determine the output
-                        //      we need to append to our encode message
-                        else {
-                            // Now, since we are starting at the zero node, we will set our traversal node to the zero node
-                            traversalNode = this->zeroNode;
-
-                            // Next, we will use a while loop to go up the tree, logging a one if the child node is the right
-                            //      child of its parent, and a zero, if the child is the left child of its parent
-                            while(traversalNode->getParentNode() != nullptr) {
-                                // Check to see if the traversal node is the left child of the parent
-                                if(traversalNode == traversalNode->getParentNode()->getLeftNode()) {
-                                    // If its the left child, we will append a zero to the reversePath path
-                                    reversePath.append("0");
-                                }
+        ByteWriter bytes(sink);
+        PackedBitWriter writer(bytes);
 
-                                // Else, the traversal node is the right child, so we append a one
-                                else {
-                                    reversePath.append("1");
-                                }
+        for(size_t i = 0; i < messageLength; i++) {
+            encodeCharacter(indexOf(message[i]), writer);
 
-                                // Updating the traversal node to be its previous parent
-                                traversalNode = traversalNode->getParentNode();
-                            }
+            if(writer.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, i);
+            }
+        }
 
-                            // Out of the while loop, we will have obtained the reversePath from the node to the root, so now
-                            //      we will use the reverseString function and store the correct path into the correctPath string.
-                            correctPath = reverseString(reversePath);
+        if(!writer.finish()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, messageLength);
+        }
 
-                            // Now that we have obtained the correctPath, we will output the path into our encodedMessage
-                            encodedMessage.append(correctPath);
+        return huffmanSuccess(writer.bytesWritten(), writer.bitsWritten());
+    }
 
-                            // The next step is to output the binary representation of the character that we are adding to the tree
-                            // Getting the eight bit representation
-                            bitset<8> characterBits(message[i]);
+    // Creating the decode method for packed bits, appending the decoded symbols onto the end of the vector. The
+    //      result counts symbols where the byte methods count bytes. Error offsets are in bits
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, vector<Symbol>& message) noexcept {
+        PackedBitReader reader(input, bitCount);
+        size_t start = message.size();
 
-                            // Converting the eight bits of the character to a string variable
-                            stringBits = characterBits.to_string();
+        while(!reader.atEnd()) {
+            uint64_t symbolOffset = reader.getPosition();
+            int index = -1;
 
-                            // Finally, appending the string to our encoded message string
-                            encodedMessage.append(stringBits);  
-                        }
+            HuffmanStatus status = decodeCharacter(reader, index);
+            if(status != HUFFMAN_SUCCESS) {
+                return huffmanFailure(status, status == HUFFMAN_TRUNCATED_MESSAGE ? reader.getPosition() : symbolOffset);
+            }
 
-                        // Next, we will add the new nodes into our list, setting the correct pointer members as required
-                        // First, we will set the included pointers for the parent counter node. There are two instances
-                        //      that we will encounter when a new counter node is added to the tree, and those are
-                        //      1. The zero node is the root and 2. The zero node is not the root.
+            message.push_back(this->symbols[index]);
+        }
 
-                        // No matter the case, we always have a series of pointers to set and to add the counter node to 
-                        //      the tree, these steps are:
-                        // 1. The zeroNode becomes the counter node's left child
-                        counterNode->setLeftNode(this->zeroNode);
+        return huffmanSuccess(message.size() - start, uint64_t(message.size() - start) * sizeof(Symbol) * 8);
+    }
 
-                        // 2. The characterNode becomes the counter node's right child
-                        counterNode->setRightNode(characterNode);
+    // Function that encodes one symbol through the caller's bit writer and updates the tree. This is for coders
+    //      built out of several trees, which decide for themselves which tree codes each symbol. The symbol has to
+    //      be in the alphabet, which the caller checks beforehand
+    template<class BitWriter>
+    void encodeSymbol(Symbol character, BitWriter& writer) {
+        encodeCharacter(indexOf(character), writer);
+    }
 
-                        // 3. The characterNode becomes its next node in the chain
-                        counterNode->setNextNode(characterNode);
+    // Function that decodes one symbol from the caller's bit reader and updates the tree
+    template<class BitReader>
+    HuffmanStatus decodeSymbol(BitReader& reader, Symbol& character) {
+        int index = -1;
+        HuffmanStatus status = decodeCharacter(reader, index);
 
-                        // Now, we will check to see if the zero node has a parent (i.e. the zero node is not the root) 
-                        if(this->zeroNode->getParentNode() != nullptr) {
-                            // Setting zero node's parent node to the parentNode temporary pointer
-                            parentNode = zeroNode->getParentNode();
+        if(status == HUFFMAN_SUCCESS) {
+            character = this->symbols[index];
+        }
+        return status;
+    }
 
-                            // If the zeroNode has a parent, that means, for the counterNode we have to follow these steps:
-                            // 1. Make the zero node's parent the parent for the counternode
-                            counterNode->setParentNode(parentNode);
+    // Function that tells us whether the symbol has been seen by this tree since it was built or reset
+    bool hasSymbol(Symbol character) const noexcept {
+        return this->leaves[indexOf(character)] != nullptr;
+    }
 
-                            // 2. Make zeroNode's parent node's left child be the counterNode
-                            parentNode->setLeftNode(counterNode);
+    // Function that encodes a symbol the tree has already seen and returns true. For a symbol it hasn't seen,
+    //      only the zero node's code is written, as an escape, and false is returned; the caller then codes the
+    //      symbol some other way (for example with a second tree). Either way the tree is updated
+    template<class BitWriter>
+    bool encodeSymbolOrEscape(Symbol character, BitWriter& writer) {
+        int index = indexOf(character);
+        Node* characterNode = this->leaves[index];
+
+        if(characterNode != nullptr) {
+            writePath(characterNode, writer);
+            updateTree(index);
+            return true;
+        }
 
-                            // 3. Make the right child of the new parent, the previous to the counterNode
-                            counterNode->setPrevNode(parentNode->getRightNode());
+        if(this->root != this->zeroNode) {
+            writePath(this->zeroNode, writer);
+        }
+        updateTree(index);
+        return false;
+    }
 
-                            // 4. Make the right child of the new parent's next, become the counterNode
-                            parentNode->getRightNode()->setNextNode(counterNode);
-                        }
+    // Function that decodes what encodeSymbolOrEscape wrote. On an escape, escaped is set and nothing else is read;
+    //      the caller decodes the symbol some other way and hands it to addEscapedSymbol, which updates the tree
+    //      the same way the encoder's tree was updated
+    template<class BitReader>
+    HuffmanStatus decodeSymbolOrEscape(BitReader& reader, Symbol& character, bool& escaped) {
+        Node* traversalNode = this->root;
 
-                        // Else, it is our first case where the zero node is the root, which means the counterNode becomes the 
-                        //      new root of the tree, so we only have one more assignment to do
-                        else {
-                            this->root = counterNode;
-                        }
+        while(traversalNode->getLeftNode() != nullptr && traversalNode->getRightNode() != nullptr) {
+            unsigned bit;
 
-                        // Now that we have finished assigning the proper pointers for the counter node, we will move on 
-                        //      to placing the character node into the tree, through these steps:
-                        // 1. The counter node becomes the parent of the character node
-                        characterNode->setParentNode(counterNode);
+            if(!reader.getBit(bit)) {
+                return HUFFMAN_TRUNCATED_MESSAGE;
+            }
 
-                        // 2. The counter node becomes the previous node in the chain from the character node
-                        characterNode->setPrevNode(counterNode);
+            traversalNode = bit ? traversalNode->getRightNode() : traversalNode->getLeftNode();
+        }
 
-                        // 3. The zeroNode becomes the next node in the chain after the character node
-                        characterNode->setNextNode(this->zeroNode);
+        escaped = traversalNode == this->zeroNode;
+        if(escaped) {
+            return HUFFMAN_SUCCESS;
+        }
 
-                        // Next, we will update the pointers for the zeroNode
-                        // Making the character node the previous node in the chain
-                        this->zeroNode->setPrevNode(characterNode);
+        character = traversalNode->getCharacter();
+        updateTree(indexOf(character));
+        return HUFFMAN_SUCCESS;
+    }
 
-                        // Setting the parent of the zero node to the counter node
-                        this->zeroNode->setParentNode(counterNode);  
+    // Function that adds a symbol the decoder escaped on, once the caller has decoded it. It has to be in the alphabet
+    void addEscapedSymbol(Symbol character) {
+        updateTree(indexOf(character));
+    }
 
-                        // The next step in the process will be to increment the parent node of the new counter node,
-                        //      if it was assigned a parent during insertion into the tree
-                        if(counterNode->getParentNode() != nullptr) {
-                            counterNode->getParentNode()->updateCount(1);
-                        }
+    protected:
+    // Protected constructor for an empty tree, which clone() fills in
+    BasicAdaptiveHuffmanTree() noexcept : root(nullptr), zeroNode(nullptr), symbols(nullptr), symbolIndex(nullptr), symbolIndexSize(0),
+                                          symbolCount(0), literalBits(8), nodesUsed(0), maxCodeLength(NO_CODE_LENGTH_LIMIT), rescaleCount(0) {}
+
+    // Protected constructor for a tree that reads its alphabet in place from symbols and a direct lookup table that
+    //      outlive it, such as a compiled alphabet. Nothing about the alphabet is copied or parsed
+    BasicAdaptiveHuffmanTree(const Symbol* alphabet, int alphabetSize, const int32_t* symbolIndex, size_t symbolIndexSize, int maxCodeLength)
+        : BasicAdaptiveHuffmanTree() {
+        useCodeLengthLimit(maxCodeLength);
+
+        this->symbols = alphabet;
+        this->symbolIndex = symbolIndex;
+        this->symbolIndexSize = symbolIndexSize;
+        this->symbolCount = alphabetSize;
+
+        uint64_t largest = 0;
+        for(int i = 0; i < alphabetSize; i++) {
+            largest = max<uint64_t>(largest, uint64_t(alphabet[i]));
+        }
+        this->literalBits = symbolLiteralBits(largest);
 
-                        // And finally, we will update the alphabet array huffman node by setting the character node
-                        //      as its alphabet node
-                        alphabetArray[index].setAlphabetNode(characterNode);
+        allocateStorage();
+    }
 
-                        // To start the next process of checking the chain, we will set our previous and next nodes
-                        // Checking to see if the counter node has a parent 
-                        if(counterNode->getParentNode() != nullptr) {
+    // Function that keeps the code length limit inside the range where the rescaling can always keep to it, and
+    //      works out the root count that triggers a rescale
+    void useCodeLengthLimit(int maxCodeLength) noexcept {
+        if(maxCodeLength == NO_CODE_LENGTH_LIMIT && needsCodeLengthLimit) {
+            maxCodeLength = maxCodeLengthLimit();
+        }
+        if(maxCodeLength != NO_CODE_LENGTH_LIMIT) {
+            maxCodeLength = max(minCodeLengthLimit(), min(maxCodeLength, maxCodeLengthLimit()));
+        }
 
-                            // Now, checking to see if the parent of the counter node has a parent too
-                            if(counterNode->getParentNode()->getParentNode() != nullptr) {
+        this->maxCodeLength = maxCodeLength;
+        this->rescaleCount = maxCodeLength == NO_CODE_LENGTH_LIMIT ? 0 : codeLengthLimitCount(maxCodeLength);
+    }
 
-                                // If the counternode has a grandparent, we will set the previous node to 
-                                //      the parent's previous and the next node to the counter nodes parent
-                                prevNode = counterNode->getParentNode()->getPrevNode();
-                                nextNode = counterNode->getParentNode();
-                            }
+    // Function that points the tree at a symbol table
+    void useTable(shared_ptr<const HuffmanSymbolTable<Symbol>> symbolTable) noexcept {
+        this->table = std::move(symbolTable);
+        this->symbols = this->table->data();
+        this->symbolIndex = this->table->denseData();
+        this->symbolIndexSize = this->table->denseSize();
+        this->symbolCount = (int)this->table->size();
+        this->literalBits = this->table->getLiteralBits();
+    }
 
-                            // Else, the previous node will become the counter node's parent, and the next node
-                            //      will be the counter node's previous 
-                            else {
-                                prevNode = counterNode->getParentNode();
-                                nextNode = counterNode->getPrevNode();
-                            }
+    // Function that points the tree at the same alphabet as another tree, whether it has a table or not
+    void useSymbolsOf(const BasicAdaptiveHuffmanTree& other) noexcept {
+        this->table = other.table;
+        this->symbols = other.symbols;
+        this->symbolIndex = other.symbolIndex;
+        this->symbolIndexSize = other.symbolIndexSize;
+        this->symbolCount = other.symbolCount;
+        this->literalBits = other.literalBits;
+    }
 
-                        }
-                        
-                        // Else statement that just sets the prevNode to the counter node, since it will be the root,
-                        //      this way, our conditional checks below will operate properly
-                        else {
-                            prevNode = characterNode->getPrevNode();
-                            nextNode = characterNode;
-                        }
+    // Function that creates the leaf array and the node storage for the alphabet, and starts the tree off with just
+    //      the zero node. A HuffmanException is thrown if the alphabet has more than MaxSymbols symbols
+    void allocateStorage() {
+        if(this->symbolCount > MaxSymbols) {
+            throw HuffmanException("Alphabet Has More Symbols Than The Tree Can Hold.");
+        }
 
-                    }
+        this->leaves.reset(new Node*[this->symbolCount + 1]());
+        this->nodeStorage.reset(new Node[2 * this->symbolCount + 1]);
+        resetNodes();
+    }
 
-                    // Else statement that will run for our second case in encoding which is that the character node
-                    //      exists, and we need to increment its count
-                    else {
-                        // Since our character node is in the tree, we will use alphabet array alphabet node ot jump 
-                        //      to the character node
-                        // Setting our characterNode
-                        characterNode = alphabetArray[index].getAlphabetNode();
-
-                        // Now, starting at the character node, we will traverse up to the root to obtain the path
-                        //      we must take to get to the node
-                        traversalNode = characterNode;
-
-                        // Next, we will use a while loop to go up the tree, logging a one if the child node is the right
-                        //      child of its parent, and a zero, if the child is the left child of its parent
-                        while(traversalNode->getParentNode() != nullptr) {
-                            // Check to see if the traversal node is the left child of the parent
-                            if(traversalNode == traversalNode->getParentNode()->getLeftNode()) {
-                                // If its the left child, we will append a zero to the reversePath path
-                                reversePath.append("0");
-                            }
+    // Function that fills an empty tree with a copy of this one. The copy's nodes are laid out exactly like ours,
+    //      so every pointer is moved over by the distance between the two node storages
+    void cloneInto(BasicAdaptiveHuffmanTree& copy) const {
+        copy.useSymbolsOf(*this);
+        copy.leaves.reset(new Node*[this->symbolCount + 1]());
+        copy.nodeStorage.reset(new Node[2 * this->symbolCount + 1]);
+        copy.nodesUsed = this->nodesUsed;
+        copy.maxCodeLength = this->maxCodeLength;
+        copy.rescaleCount = this->rescaleCount;
+
+        for(int i = 0; i < this->nodesUsed; i++) {
+            const Node& node = this->nodeStorage[i];
+            Node& copiedNode = copy.nodeStorage[i];
+
+            copiedNode = node;
+            copiedNode.setParentNode(copy.relocate(this->nodeStorage.get(), node.getParentNode()));
+            copiedNode.setPrevNode(copy.relocate(this->nodeStorage.get(), node.getPrevNode()));
+            copiedNode.setNextNode(copy.relocate(this->nodeStorage.get(), node.getNextNode()));
+            copiedNode.setLeftNode(copy.relocate(this->nodeStorage.get(), node.getLeftNode()));
+            copiedNode.setRightNode(copy.relocate(this->nodeStorage.get(), node.getRightNode()));
+        }
 
-                            // Else, the traversal node is the right child, so we append a one
-                            else {
-                                reversePath.append("1");
-                            }
+        for(int i = 0; i < this->symbolCount; i++) {
+            copy.leaves[i] = copy.relocate(this->nodeStorage.get(), this->leaves[i]);
+        }
 
-                            // Updating the traversal node to be its previous parent
-                            traversalNode = traversalNode->getParentNode();
-                        }
+        copy.root = copy.relocate(this->nodeStorage.get(), this->root);
+        copy.zeroNode = copy.relocate(this->nodeStorage.get(), this->zeroNode);
 
-                        // Out of the while loop, we will have obtained the reversePath from the node to the root, so now
-                        //      we will use the reverseString function and store the correct path into the correctPath string.
-                        correctPath = reverseString(reversePath);
+        // The copy starts without leaders, and finds them again as it walks to them
+        copy.leaders.clear();
+    }
 
-                        // Now that we have obtained the correctPath, we will output the path into our encodedMessage
-                        encodedMessage.append(correctPath);
+    // Function that takes over another tree's state, leaving the other tree empty
+    void takeFrom(BasicAdaptiveHuffmanTree& other) noexcept {
+        this->root = other.root;
+        this->zeroNode = other.zeroNode;
+        useSymbolsOf(other);
+        this->leaves = std::move(other.leaves);
+        this->nodeStorage = std::move(other.nodeStorage);
+        this->nodesUsed = other.nodesUsed;
+        this->maxCodeLength = other.maxCodeLength;
+        this->rescaleCount = other.rescaleCount;
+        this->leaders = std::move(other.leaders);
+
+        other.root = nullptr;
+        other.zeroNode = nullptr;
+        other.table.reset();
+        other.symbols = nullptr;
+        other.symbolIndex = nullptr;
+        other.symbolIndexSize = 0;
+        other.symbolCount = 0;
+        other.nodesUsed = 0;
+    }
 
-                        // Next, we will increment the current node's count since we saw it again in the message
-                        characterNode->updateCount(1);
+    // Function that finds the node in our storage at the same place as the given node in another tree's storage
+    Node* relocate(const Node* otherStorage, const Node* node) const noexcept {
+        if(node == nullptr) {
+            return nullptr;
+        }
+        return this->nodeStorage.get() + (node - otherStorage);
+    }
 
-                        // To start the next process of checking the chain,we willset our prev node to the character 
-                        //      node's prev node in the chain (i.e. its parent), and assigning the nextNode to the characterNode
-                        prevNode = characterNode->getPrevNode();
-                        nextNode = characterNode;
-                    }
+    // Function that empties the node storage and makes the zero node the whole tree again
+    void resetNodes() noexcept {
+        this->nodesUsed = 1;
 
-                    // Checking to see if the previous node has a previous node (i.e. if it is the root)
-                    if(prevNode->getPrevNode() != nullptr) {
-
-                        // Now, we will perform these checks through a while loop, as we need to check the chain 
-                        //      up until we reach the root. 
-                        while(!endOfChain) {
-
-                            // Assigning the currentNode to the current prevNode
-                            currentNode = prevNode;
-
-                            // Since we know that we might be swapping nodes, if the leader is not the parent
-                            //      of the current nextNode, we will assign next node to swapNode
-                            swapNode = nextNode;
-
-                            // Now, we need to locate the leader of the smaller count values and perform a swap if need be.
-                            //      To do so, first, we will assign the leaderCount value to the count of the prevNode 
-                            //      in the list, so we can compare the nodes behind it
-                            leaderCount = currentNode->getCount();
-
-                            // So, to check the order, we see if the count of the next node is less than to the 
-                            //      previous node's count
-                            if(currentNode->getCount() < nextNode->getCount()) {
-                                    
-                                // Checking to see if the current node is not the root
-                                if(currentNode->getPrevNode() != nullptr) {
-                                    // Now, we will use a while loop to traverse up the chain to determine where the leader of 
-                                    //      this count size is at in the tree
-                                    while(leaderCount == currentNode->getCount() && prevNode->getPrevNode() != nullptr) {
-                                        // Setting the currentnode to its previous node, the nextnode to currentNode, and then 
-                                        //      the prevNode to the new current's previous node for the next check for leader
-                                        nextNode = currentNode;
-                                        currentNode = currentNode->getPrevNode();
-                                        prevNode = currentNode->getPrevNode();
-                                    }
+        // Clearing the zero node back to a fresh node, and subtracting one from its count to make it zero
+        this->zeroNode = &this->nodeStorage[0];
+        *this->zeroNode = Node();
+        this->zeroNode->updateCount(-1);
 
-                                    // Now, exiting the while loop, we will have obtained the leader of the counts and it will
-                                    //      be represented as the currentNode pointer. Now, we will check if the currentNode pointer
-                                    //      is the parent of the swapNode
+        // Assigning the root node to point to our zero node for the tree
+        this->root = this->zeroNode;
 
-                                    // If the nextNode (leader of counts) is the parent of the swap node and there is no issue
-                                    //      with the order of the chain, we will just increment the parent height 
-                                    if(nextNode == swapNode->getParentNode() && nextNode->getCount() < currentNode->getCount()) {
-                                        nextNode->updateCount(1);
-                                    }
+        // Forgetting every leader, since their nodes are about to be handed out again
+        this->leaders.clear();
+    }
 
-                                    // Else, we will perform a swap between the nextNode and the swap node
-                                    else {
-                                        // If the next node is the parent of the swap node, and the current node (the node previous
-                                        //      to it in the chain) has a smaller count, we will assign the nextNode to be this currentNode
-                                        //      since it is the leader of these smaller counts and needs to be swapped
-                                        if(nextNode == swapNode->getParentNode() && currentNode->getCount() <= nextNode->getCount()) {
-                                            nextNode = currentNode;
-                                        }
-
-                                        // Before we do the swap, we will get the parent, next, and prev nodes for both the next
-                                        //      and swap nodes undergoing the swap in the tree
-                                        nextNodeParent = nextNode->getParentNode();
-                                        nextNodeNext = nextNode->getNextNode();
-                                        nextNodePrev = nextNode->getPrevNode();
-                                        swapNodeParent = swapNode->getParentNode();
-                                        swapNodeNext = swapNode->getNextNode();
-                                        swapNodePrev = swapNode->getPrevNode();
-
-                                        // Our next steps will vary and have different cases: 1. The nextNode is the left child
-                                        //      and the swapNode is the right child, 2. The nextNode and swapNode are both right children,
-                                        //      3. They are both left children, and 4. The nextNode is the right child and the swapNode is the left child
-                                        // Conditional that will check if the next node is the left child and if the swap node is the right 
-                                        //      child, if the next and swap nodes are both right nodes, or if they are both left. These are for our first three cases
-                                        if( (nextNode->getParentNode()->getLeftNode() == nextNode && swapNode->getParentNode()->getRightNode() == swapNode) ||
-                                            (nextNode->getParentNode()->getRightNode() == nextNode && swapNode->getParentNode()->getRightNode() == swapNode) ||
-                                            (nextNode->getParentNode()->getLeftNode() == nextNode && swapNode->getParentNode()->getLeftNode() == swapNode)) {
-                                            // Now, to swap these two nodes, we will first assign the pointers to their original parents
-                                            //      which means, for example, the nextNodeParent will now be the parent of the 
-                                            //      swap node
-                                            // Handling the parent assingment for the swap node
-                                            swapNode->setParentNode(nextNodeParent);
-
-                                            // Now, checking to see if the next node is the left or right child of its parent
-                                            if(nextNode == nextNodeParent->getLeftNode()) {
-                                                // Making the swap node the new left child of the current parent if the current node was its left
-                                                //      child
-                                                nextNodeParent->setLeftNode(swapNode);
-                                            }
-
-                                            // Else, the swap node will become its right child
-                                            else {
-                                                nextNodeParent->setRightNode(swapNode);
-                                            }
-
-                                            // Now, we handle the parent assignment for the current node
-                                            nextNode->setParentNode(swapNodeParent);
-
-                                            // Now, checking to see if the swap node was the left or right child of its parent
-                                            if(swapNode == swapNodeParent->getLeftNode()) {
-                                                // Making the current node the new left child of the swap parent if the swap node was its left
-                                                //      child
-                                                    swapNodeParent->setLeftNode(nextNode);
-                                                }
-
-                                            // Else, the current node will become its right child
-                                            else {
-                                                swapNodeParent->setRightNode(nextNode);
-                                            }
-
-                                            // Checking to see if we encounter the subcase of the swap node being the node in front of the
-                                            //      nextNode in the chain, this requires special assignment.
-                                            if(swapNode == nextNode->getNextNode()) {
-                                                // Working with the swap node
-                                                // Making the swap node's previous node, next's old previous
-                                                swapNode->setPrevNode(nextNodePrev);
-
-                                                // Making the next node's previous node's next, swap node
-                                                nextNodePrev->setNextNode(swapNode);
-
-                                                // Making swap node's next, the next node
-                                                swapNode->setNextNode(nextNode);
-
-                                                // Working with the next node 
-                                                // Making the next node's previous node, the swap node
-                                                nextNode->setPrevNode(swapNode);
-
-                                                // Making swap node's old next node,  next node's new next node
-                                                nextNode->setNextNode(swapNodeNext);
-
-                                                // Making swap Node next's previous, the next node
-                                                swapNodeNext->setPrevNode(nextNode);
-                                            }
-
-                                            // Else, we have a normal case that can be solved with the same assignments
-                                            else {
-                                                // Now, we handle the assignment of the rest of the nexts and previous nodes
-                                                // Working with the swap node
-                                                // Making swap node's previous node, next's old previous
-                                                swapNode->setPrevNode(nextNodePrev);
-
-                                                // Making next node's previous node's next, swap node
-                                                nextNodePrev->setNextNode(swapNode);
-
-                                                // Making swap node's next, next's old next
-                                                swapNode->setNextNode(nextNodeNext);
-
-                                                // Making the swap node the next node of nextNodeNext
-                                                nextNodeNext->setPrevNode(swapNode);
-
-                                                // Working with the next node
-                                                // Making the next node's previous node, swap's old previous
-                                                nextNode->setPrevNode(swapNodePrev);
-
-                                                // Making swap node's previous node's next, next node
-                                                swapNodePrev->setNextNode(nextNode);
-
-                                                // Making next node's next, swap's old next
-                                                nextNode->setNextNode(swapNodeNext);
-
-                                                // Making the next node the next node of swapNodeNext
-                                                swapNodeNext->setPrevNode(nextNode);
-                                            }
-                                        }
-
-                                        // Else if, the nextNode is the right child and the swapNode is the left child
-                                        else if(nextNode->getParentNode()->getRightNode() == nextNode && swapNode->getParentNode()->getLeftNode() == swapNode){
-                                            // Now, to swap these two nodes, we will first assign the pointers to their original parents
-                                            //      which means, for example, the nextNodeParent will now be the parent of the 
-                                            //      swap node
-                                            // Handling the parent assingment for the swap node
-                                            swapNode->setParentNode(nextNodeParent);
-
-                                            // Now, checking to see if the next node is the left or right child of its parent
-                                            if(nextNode == nextNodeParent->getLeftNode()) {
-                                                // Making the swap node the new left child of the current parent if the current node was its left
-                                                //      child
-                                                nextNodeParent->setLeftNode(swapNode);
-                                            }
-
-                                            // Else, the swap node will become its right child
-                                            else {
-                                                nextNodeParent->setRightNode(swapNode);
-                                            }
-
-                                            // Now, we handle the parent assignment for the current node
-                                            nextNode->setParentNode(swapNodeParent);
-
-                                            // Now, checking to see if the swap node was the left or right child of its parent
-                                            if(swapNode == swapNodeParent->getLeftNode()) {
-                                                // Making the current node the new left child of the swap parent if the swap node was its left
-                                                //      child
-                                                    swapNodeParent->setLeftNode(nextNode);
-                                                }
-
-                                            // Else, the current node will become its right child
-                                            else {
-                                                swapNodeParent->setRightNode(nextNode);
-                                            }
-
-                                            // Now, we wil check if the swap and next nodes are siblings 
-                                            if(nextNode->getNextNode() == swapNode) {
-                                                // We can start to handle the assignment of the next nodes for the swap and next nodes
-                                                // Making the nextNode's old next, the next node
-                                                swapNode->setNextNode(nextNode);
-
-                                                // Making swap node's new previous node, next's old previous
-                                                swapNode->setPrevNode(nextNodePrev);
-
-                                                // Now, for the next node, we will assign its next to the swap's old next
-                                                nextNode->setNextNode(swapNodeNext);
-
-                                                // Making the nextNode's previous pointer, the swap node
-                                                nextNode->setPrevNode(swapNode);
-
-                                                // And assinging the swap node next as the previous next node
-                                                swapNodeNext->setPrevNode(nextNode);
-
-                                                // Assigning nextNodePrev's next node to the swapNode
-                                                nextNodePrev->setNextNode(swapNode);                                     
-                                            }
-
-                                            // Else, they are not siblings
-                                            else {
-                                                // Now, we handle the assignment of the rest of the nexts and previous nodes
-                                                // Working with the swap node
-                                                // Making swap node's previous node, next's old previous
-                                                swapNode->setPrevNode(nextNodePrev);
-
-                                                // Making next node's previous node's next, swap node
-                                                nextNodePrev->setNextNode(swapNode);
-
-                                                // Making swap node's next, next's old next
-                                                swapNode->setNextNode(nextNodeNext);
-
-                                                // Making the swap node the next node of nextNodeNext
-                                                nextNodeNext->setPrevNode(swapNode);
-
-                                                // Working with the next node
-                                                // Making the next node's previous node, swap's old previous
-                                                nextNode->setPrevNode(swapNodePrev);
-
-                                                // Making swap node's previous node's next, next node
-                                                swapNodePrev->setNextNode(nextNode);
-
-                                                // Making next node's next, swap's old next
-                                                nextNode->setNextNode(swapNodeNext);
-
-                                                // Making the next node the next node of swapNodeNext
-                                                swapNodeNext->setPrevNode(nextNode);                                               
-                                            }
-                                        }   
-
-                                        // Now, incrementing the height of the swap node's new parent
-                                        swapNode->getParentNode()->updateCount(1);
-                                    }
-                                }
+    // Function that hands out the next unused node from the node storage, cleared to a fresh node
+    Node* allocateNode() noexcept {
+        Node* node = &this->nodeStorage[this->nodesUsed++];
+        *node = Node();
+        return node;
+    }
 
-                                // Else, if the currentNode is the root, we will just update the current node,
-                                else {
-                                    currentNode->updateCount(1);
-                                }
-                            }
+    // Function that writes the path from the root down to the given node, where each left branch is a 0 and each
+    //      right branch is a 1. We walk up from the node to the root, so the bits come out last first. Instead of
+    //      building a string and reversing it, we drop each bit straight into its place in a small bit array and
+    //      hand the finished path to the writer in at most a few pieces.
+    template<class BitWriter>
+    void writePath(Node* node, BitWriter& writer) {
+        // Each word is stored once it fills up, so the array never has to be cleared
+        uint64_t pathWords[PATH_WORDS];
+        uint64_t word = 0;
+        int depth = 0;
+
+        for(Node* traversalNode = node; traversalNode->getParentNode() != nullptr; traversalNode = traversalNode->getParentNode()) {
+            if(traversalNode != traversalNode->getParentNode()->getLeftNode()) {
+                word |= uint64_t(1) << (depth & 63);
+            }
+            depth++;
 
-                            // Else statement that will simply update the count of the swap node's parent 
-                            //      since there is nothing wrong with the chain order
-                            else {
-                                swapNode->getParentNode()->updateCount(1);
-                            }
+            if((depth & 63) == 0) {
+                pathWords[(depth >> 6) - 1] = word;
+                word = 0;
+            }
+        }
 
-                            // Checking to see if the swap node's parent has a revious node of itself (i.e. if it is not the root)
-                            if(swapNode->getParentNode()->getPrevNode() != nullptr) {
-                                // Traversing up the chain by assigning the previous node to the current node's prevNode and the next node
-                                //      to the original current node
-                                nextNode = swapNode->getParentNode();
-                                prevNode = swapNode->getParentNode()->getPrevNode(); 
-                            }
+        if((depth & 63) != 0) {
+            pathWords[depth >> 6] = word;
+        }
 
-                            // Else, the current node is the root, so we will stop the traversal process
-                            else {
-                                endOfChain = true;
-                            }
-                        }                    
-                    }
+        // Bit (depth - 1) is the branch taken at the root, so we write from the top bit down, 32 bits at a time
+        while(depth > 0) {
+            int count = depth < 32 ? depth : 32;
+            int low = depth - count;
+            uint64_t value = pathWords[low >> 6] >> (low & 63);
 
-                    // Else if statement that will handle the case where we are dealing with the root node directly with no iteration
-                    //      through the tree. This will update the count of the root node (prevNode) if the sum of its two children
-                    //      are not equal to it.
-                    else if(prevNode->getCount() != (prevNode->getLeftNode()->getCount() + prevNode->getRightNode()->getCount())){
-                        prevNode->updateCount(1);
-                    }
-                }
+            if((low & 63) + count > 64) {
+                value |= pathWords[(low >> 6) + 1] << (64 - (low & 63));
+            }
 
-                // Else statement that will throw an exception since the character was not in our alphabet
-                else {
-                    throw HuffmanException("Invalid Character In Message. Re-Run Program To Try Again.");
-                }  
+            writer.putBits(value, count);
+            depth = low;
+        }
+    }
+
+    // Function that encodes a single symbol, given its place in the alphabet, and updates the tree
+    template<class BitWriter>
+    void encodeCharacter(int index, BitWriter& writer) {
+        Node* characterNode = this->leaves[index];
+
+        // If the character is already in the tree, its code is simply the path from the root to its node
+        if(characterNode != nullptr) {
+            writePath(characterNode, writer);
+        }
+
+        // Else, we write the path to the zero node (which is nothing while the zero node is the root) followed by
+        //      the literal bits of the new symbol, which are eight for the byte tree
+        else {
+            if(this->root != this->zeroNode) {
+                writePath(this->zeroNode, writer);
             }
-            
-            // Finally, returning the fully encoded message
-            return encodedMessage;
+
+            writer.putBits(uint64_t(this->symbols[index]), getLiteralBits());
         }
 
-        // Catching the error thrown if a character is not in the alphabet
-        catch(HuffmanException error) {            
-            error.outputError();
-            return "NULL";
+        updateTree(index);
+    }
+
+    // Function that decodes a single symbol from the reader, sets index to its place in the alphabet, and updates
+    //      the tree
+    template<class BitReader>
+    HuffmanStatus decodeCharacter(BitReader& reader, int& index) {
+        // Creating a variable to hold the symbol's value after we decode its bits
+        unsigned character = 0;
+
+        // Starting at the root, we read in the bits until our traversal node no longer has a child. Recall that
+        //      a '0' is left and '1' is right. While the zero node is the root, this reads nothing.
+        Node* traversalNode = this->root;
+
+        while(traversalNode->getLeftNode() != nullptr && traversalNode->getRightNode() != nullptr) {
+            unsigned bit;
+
+            if(!reader.getBit(bit)) {
+                return HUFFMAN_TRUNCATED_MESSAGE;
+            }
+
+            traversalNode = bit ? traversalNode->getRightNode() : traversalNode->getLeftNode();
+        }
+
+        // Now, out of the while loop, we will either be at the zero node or a character node. At the zero node,
+        //      we have encountered a new symbol, and the next literal bits tell us which one it is
+        if(traversalNode == this->zeroNode) {
+            if(!reader.getBits(getLiteralBits(), character)) {
+                return HUFFMAN_TRUNCATED_MESSAGE;
+            }
         }
+
+        // Else, we are at a character node, so we just get the symbol from the node
+        else {
+            character = unsigned(traversalNode->getCharacter());
+        }
+
+        // Next we check whether or not the symbol that we decoded is in our alphabet, using the symbol lookup to
+        //      jump straight to its place
+        index = indexOf(Symbol(character));
+
+        if(index == -1) {
+            return HUFFMAN_INVALID_CHARACTER;
+        }
+
+        updateTree(index);
+        return HUFFMAN_SUCCESS;
     }
 
-    // Creating our decode method that takes in the encoded string message and decodes it. After decoding, this method
-    //      then returns decoded version of the encoded message, which should be the original message.
-    string decode(string messageString) {
-        // Creating a large try-catch block to handle the error we get if a character in the message is not in the 
-        //     alphabet array
-        try {
-            // Our first task in the decoding process will be to cast the string message into a c_string so we can 
-            //      easily access each character
-            const char* message = messageString.c_str();
-
-            // Creating our limitation variable for how many characters we want to iterate through our message. Due
-            //      to appending an extra \n to our string message while reading it in from file, there will
-            //      always be extra 
-
-            // Creating the decoded message string that will be used to track and hold the output of our message
-            //      while work through the process of decoding it
-            string decodedMessage;
-
-            // Creating a count variable that will increase with each bit we read in, and let us know when we
-            //      have reached the end of the message
-            int count = 0;
-
-            // Now, we will create a while loop that will let us iterate through the entire message without 
-            //      having a bounds issue
-            while(count < strlen(message)) {
-
-                // First we will create pointers to our two new nodes in the tree: the character node and the 
-                //      its parent counter node
-                HuffmanNode* counterNode = new HuffmanNode();
-
-                // For the character node, we are intializing it with the character in our message that we are currently
-                //      encoding
-                HuffmanNode* characterNode = new HuffmanNode();
-
-                // Creating a temporary string variable that will be used to store the eight bit representation
-                //      of each character output
-                string stringBits;
-
-                // Creating a character variable to hold the character value after we decode its bits
-                char character;
-
-                // Creating a boolean variable that will be used in our conditional checking to help see if a character
-                //      is within our alphabet array
-                bool isFound = false;
-
-                // Creating another boolean variable to keep track of where we are at while traversing up the chain
-                bool endOfChain = false;
-
-                // Creating an int variable to keep track of the leader count while checking the chain
-                int leaderCount;
-
-                // Creating a string that will be appended to, so we can hold the 1's and 0's as we traverse up the tree 
-                //      to obtain the path from the root to a node
-                string reversePath;
-
-                // Creating another string to hold the result from the reverseString method, which will be the correct path
-                //      from the root to a given node
-                string correctPath;
-
-                // Creating a traversal node that will be used to obtain the path from the root to a given node
-                HuffmanNode* traversalNode = nullptr;
-
-                // Creating a temporary node pointer to keep track of the current node we are on
-                HuffmanNode* currentNode = nullptr;
-
-                // Creating a temporary node pointer to get the parent of each node, while we traverse and update our tree
-                HuffmanNode* parentNode = nullptr;
-
-                // Creating two node pointers, one for the next node in the chain and one for the previous node in the cahin
-                HuffmanNode* prevNode = nullptr;
-                HuffmanNode* nextNode = nullptr;
-
-                // Creating a node pointer called swapNode, to help keep track of the node that we swap with another
-                //      leaf chracter node
-                HuffmanNode* swapNode = nullptr;
-
-                // For our swapping process, we will obtain the parent, next, and prev pointers for both the next node and
-                //      the swap node, that are switching places. Below, we create all of them.
-                HuffmanNode* nextNodeParent = nullptr;
-                HuffmanNode* nextNodeNext = nullptr;
-                HuffmanNode* nextNodePrev = nullptr;
-                HuffmanNode* swapNodeParent = nullptr;
-                HuffmanNode* swapNodeNext = nullptr;
-                HuffmanNode* swapNodePrev = nullptr;
-
-                // Creating a accumlator integer to also help with our check to see if a character is in our array
-                int index = 0;
-
-                // Our first action with the decoding will always be to read in the first eight bits of the message,
-                //      since we know that all we have in the tree is the zero node, therfore the first bits will
-                //      be a character that we will add to the tree, if it is in our alphabet
-                // First, with an if statement, we check if the root is the zero node 
-                if(this->zeroNode == this->root) {
-                    // Using a for loop, to get the first eight bits of the message
-                    for(int i = 0; i < 8; i++) {
-                        // Casting the ith bit element into a string 
-                        string temp(1, message[i]);
-
-                        // Appending the temporary string into the stringBits string,  which will be later converted to 
-                        //      its character value
-                        stringBits.append(temp);
-
-                        // Increasing the count by one with each bit read
-                        count++;
-                    }
+    // Function that adds one to a node's count. When the node is the leader of its old count it leaves that block
+    //      from the top, so the leadership passes to the node after it in the chain
+    void incrementCount(Node* node) noexcept {
+        if constexpr(TRACK_LEADERS) {
+            size_t count = size_t(node->getCount());
+
+            if(count < this->leaders.size() && this->leaders[count] == node) {
+                Node* next = node->getNextNode();
+                this->leaders[count] = next != nullptr && size_t(next->getCount()) == count ? next : nullptr;
+            }
+        }
+        node->updateCount(1);
+    }
+
+    // Function that records a node as the leader of its count
+    void rememberLeader(Node* node) {
+        if constexpr(TRACK_LEADERS) {
+            size_t count = size_t(node->getCount());
 
-                    // Using the convert binary function to convert the eight bits, into its character reprensentation
-                    character = convertBinary(stringBits);                               
+            if(count < LEADER_COUNTS) {
+                if(count >= this->leaders.size()) {
+                    this->leaders.resize(min(LEADER_COUNTS, max(count + 1, 2 * this->leaders.size())), nullptr);
                 }
+                this->leaders[count] = node;
+            }
+        }
+    }
 
-                // Else statement means we need to start at the bit equal to one less than the count, and see where
-                //      it leads us in the tree. We have two cases that may happen: 1. We land in the zero node
-                //      and 2. We land at a character node
-                else {
-                    // First, we need to read in the bits until our traversal node no longer has a child
-                    // Assigning the traversal node to the root
-                    traversalNode = this->root;
-
-                    // Using a while loop to traverse down the correct path given by the bits in the encoded message
-                    //      Recall that a '0' is left and '1' is right.
-                    while(traversalNode->getLeftNode() != nullptr && traversalNode->getRightNode() != nullptr) {
-                        // Using the rule, to determine if we need to take a left or right path
-                        if(message[count] == '0') {
-                            traversalNode = traversalNode->getLeftNode();
-                        }
+    // Function that hands the leadership of a node's count on after a swap moved the node down the chain, to the
+    //      node that took its place if that one is followed by the same count
+    void leaderMovedDown(Node* node, Node* replacement) noexcept {
+        if constexpr(TRACK_LEADERS) {
+            size_t count = size_t(node->getCount());
 
-                        // Else, the bit was a 1 and we take the right path
-                        else {
-                            traversalNode = traversalNode->getRightNode();
-                        }
+            if(count < this->leaders.size() && this->leaders[count] == node) {
+                Node* next = replacement->getNextNode();
+                this->leaders[count] = next != nullptr && size_t(next->getCount()) == count ? next : nullptr;
+            }
+        }
+    }
 
-                        // Incrementing the count, since we looked at a bit
-                        count++;
-                    }
+    // Function that moves the three pointers of the leader search in updateTree to where walking up the chain over
+    //      the nodes of leaderCount would leave them, using the recorded leader. The walk never goes past the node
+    //      just below the root, so a block that reaches that far stops there. Returns false, leaving the pointers
+    //      alone, when there's no trustworthy leader and the caller has to walk
+    bool jumpToLeader(Count leaderCount, Node*& currentNode, Node*& nextNode, Node*& prevNode) const noexcept {
+        if constexpr(TRACK_LEADERS) {
+            if(size_t(leaderCount) >= this->leaders.size()) {
+                return false;
+            }
 
-                    // Now, out of the while loop, we will either be at the zero node or a character node
-                    if(traversalNode == this->zeroNode) {
-                        // If the traversal node is a zero node, that means we have encountered a new character,
-                        //      and we need to read in the next eight bits to determine what that character is
-        
-                        // Creating a temporary variable to hold the value of the current count + 8, so we 
-                        //      can make sure to read all eight bits for the new character
-                        int countPlusEight = count + 8;
-
-                        // Using a for loop to read in the next eight bits, based on the current count value and note 
-                        //      that using count in the for loop will also take care of the incrementing for each bit read
-                        for(count; count < countPlusEight; count++) {
-                            // Casting the ith bit element into a string 
-                            string temp(1, message[count]);
-
-                            // Appending the temporary string into the stringBits string,  which will be later converted to 
-                            //      its character value
-                            stringBits.append(temp);
-                        }
+            Node* leader = this->leaders[size_t(leaderCount)];
+            if(leader == nullptr || leader->getCount() != leaderCount ||
+               (leader->getPrevNode() != nullptr && leader->getPrevNode()->getCount() == leaderCount)) {
+                return false;
+            }
 
-                        // // Incrementing the count by one, to adjust to the next correct bit in the message
-                        // count++;
+            Node* belowRoot = this->root->getNextNode();
+            if(currentNode != belowRoot) {
+                Node* stop = leader == this->root || leader == belowRoot ? belowRoot : leader->getPrevNode();
+                nextNode = stop->getNextNode();
+                currentNode = stop;
+                prevNode = stop->getPrevNode();
+            }
+            return true;
+        }
+        else {
+            return false;
+        }
+    }
 
-                        // Using the convert binary function to convert the eight bits, into its character reprensentation
-                        character = convertBinary(stringBits);
-                    }
+    // Function that updates the tree after the symbol at the given place in the alphabet has been coded. The
+    //      encoder and decoder both call this, so they always make exactly the same changes to their trees.
+    void updateTree(int index) {
+        // Creating pointers to the new nodes in the tree when the character is new: the character node and its
+        //      parent counter node
+        Node* counterNode = nullptr;
+        Node* characterNode = nullptr;
+
+        // Creating another boolean variable to keep track of where we are at while traversing up the chain
+        bool endOfChain = false;
+
+        // Creating a variable to keep track of the leader count while checking the chain
+        Count leaderCount;
+
+        // Creating a temporary node pointer to keep track of the current node we are on
+        Node* currentNode = nullptr;
+
+        // Creating a temporary node pointer to get the parent of each node, while we traverse and update our tree
+        Node* parentNode = nullptr;
+
+        // Creating two node pointers, one for the next node in the chain and one for the previous node in the cahin
+        Node* prevNode = nullptr;
+        Node* nextNode = nullptr;
+
+        // Creating a node pointer called swapNode, to help keep track of the node that we swap with another
+        //      leaf chracter node
+        Node* swapNode = nullptr;
+
+        // For our swapping process, we will obtain the parent, next, and prev pointers for both the next node and
+        //      the swap node, that are switching places. Below, we create all of them.
+        Node* nextNodeParent = nullptr;
+        Node* nextNodeNext = nullptr;
+        Node* nextNodePrev = nullptr;
+        Node* swapNodeParent = nullptr;
+        Node* swapNodeNext = nullptr;
+        Node* swapNodePrev = nullptr;
+
+        // Checking to see if the symbol's leaf is pointing to a character node. If the character node
+        //       doesn't exist we will have our first case, which is that we need to add the character node 
+        //       and its parent counter node into the huffman tree
+        if(this->leaves[index] == nullptr) { 
+            // Creating the two new nodes, and setting the character node's character member to the new
+            //      character from the message
+            counterNode = allocateNode();
+            characterNode = allocateNode();
+            characterNode->setCharacter(this->symbols[index]);
+
+            // Next, we will add the new nodes into our list, setting the correct pointer members as required
+            // First, we will set the included pointers for the parent counter node. There are two instances
+            //      that we will encounter when a new counter node is added to the tree, and those are
+            //      1. The zero node is the root and 2. The zero node is not the root.
+
+            // No matter the case, we always have a series of pointers to set and to add the counter node to 
+            //      the tree, these steps are:
+            // 1. The zeroNode becomes the counter node's left child
+            counterNode->setLeftNode(this->zeroNode);
+
+            // 2. The characterNode becomes the counter node's right child
+            counterNode->setRightNode(characterNode);
+
+            // 3. The characterNode becomes its next node in the chain
+            counterNode->setNextNode(characterNode);
+
+            // Now, we will check to see if the zero node has a parent (i.e. the zero node is not the root) 
+            if(this->zeroNode->getParentNode() != nullptr) {
+                // Setting zero node's parent node to the parentNode temporary pointer
+                parentNode = zeroNode->getParentNode();
+
+                // If the zeroNode has a parent, that means, for the counterNode we have to follow these steps:
+                // 1. Make the zero node's parent the parent for the counternode
+                counterNode->setParentNode(parentNode);
+
+                // 2. Make zeroNode's parent node's left child be the counterNode
+                parentNode->setLeftNode(counterNode);
+
+                // 3. Make the right child of the new parent, the previous to the counterNode
+                counterNode->setPrevNode(parentNode->getRightNode());
+
+                // 4. Make the right child of the new parent's next, become the counterNode
+                parentNode->getRightNode()->setNextNode(counterNode);
+            }
 
-                    // Else, we are at a character node, so we just get the character from the node
-                    else {
-                        character = traversalNode->getCharacter();
-                    }
-                }
+            // Else, it is our first case where the zero node is the root, which means the counterNode becomes the 
+            //      new root of the tree, so we only have one more assignment to do
+            else {
+                this->root = counterNode;
+            }
 
-                // Next we check whether or not the character that we decoded is in our alphabet
-                //      To do this, we will use a while loop and our conditional check will be either 
-                //      if the character was found or we reach the end of the array
-                while(!isFound && (index != ALPHABET_ARRAY_SIZE - 1)) {
-                    // Using an if statement to check if a character matches
-                    if(character == alphabetArray[index].getCharacter()) {
-                        // Entering the if statement, we will know our character is in the alphabet, so we set
-                        //      isFound to be true
-                        isFound = true;
-                    }
+            // Now that we have finished assigning the proper pointers for the counter node, we will move on 
+            //      to placing the character node into the tree, through these steps:
+            // 1. The counter node becomes the parent of the character node
+            characterNode->setParentNode(counterNode);
 
-                    // Else statement that will increment the index variable to go to the next array element
-                    else {
-                        index++;
-                    }          
-                } 
-                
-                // Using an if else statement, we will check if the character was found in the array. If it is found,
-                //       we will start the next process by checking if the corresponding node in the alphabet array
-                //      is pointing a node in the tree. In other words, we will see if the character node already exists.
-                if(isFound) {
-                    // First, since our character is apart of the alphabet, we will append it to the decode message
-                    // Converting the character back to a string variable
-                    string backToString(1, character);
-
-                    // Now appending it to the decoded message
-                    decodedMessage.append(backToString);
-
-                    // Checking to see if the alphabet array element is pointing to a character node. If the character node
-                    //       doesn't exist we will have our first case, which is that we need to add the character node 
-                    //       and its parent counter node into the huffman tree
-                    if(alphabetArray[index].getAlphabetNode() == nullptr) { 
-                        // For the characterNode that we are adding to the tree, we will set its character member
-                        //      to the new character from the message
-                        characterNode->setCharacter(character);
-
-                        // Next, we will add the new nodes into our list, setting the correct pointer members as required
-                        // First, we will set the included pointers for the parent counter node. There are two instances
-                        //      that we will encounter when a new counter node is added to the tree, and those are
-                        //      1. The zero node is the root and 2. The zero node is not the root.
-
-                        // No matter the case, we always have a series of pointers to set and to add the counter node to 
-                        //      the tree, these steps are:
-                        // 1. The zeroNode becomes the counter node's left child
-                        counterNode->setLeftNode(this->zeroNode);
-
-                        // 2. The characterNode becomes the counter node's right child
-                        counterNode->setRightNode(characterNode);
-
-                        // 3. The characterNode becomes its next node in the chain
-                        counterNode->setNextNode(characterNode);
-
-                        // Now, we will check to see if the zero node has a parent (i.e. the zero node is not the root) 
-                        if(this->zeroNode->getParentNode() != nullptr) {
-                            // Setting zero node's parent node to the parentNode temporary pointer
-                            parentNode = zeroNode->getParentNode();
-
-                            // If the zeroNode has a parent, that means, for the counterNode we have to follow these steps:
-                            // 1. Make the zero node's parent the parent for the counternode
-                            counterNode->setParentNode(parentNode);
-
-                            // 2. Make zeroNode's parent node's left child be the counterNode
-                            parentNode->setLeftNode(counterNode);
-
-                            // 3. Make the right child of the new parent, the previous to the counterNode
-                            counterNode->setPrevNode(parentNode->getRightNode());
-
-                            // 4. Make the right child of the new parent's next, become the counterNode
-                            parentNode->getRightNode()->setNextNode(counterNode);
-                        }
+            // 2. The counter node becomes the previous node in the chain from the character node
+            characterNode->setPrevNode(counterNode);
 
-                        // Else, it is our first case where the zero node is the root, which means the counterNode becomes the 
-                        //      new root of the tree, so we only have one more assignment to do
-                        else {
-                            this->root = counterNode;
-                        }
+            // 3. The zeroNode becomes the next node in the chain after the character node
+            characterNode->setNextNode(this->zeroNode);
 
-                        // Now that we have finished assigning the proper pointers for the counter node, we will move on 
-                        //      to placing the character node into the tree, through these steps:
-                        // 1. The counter node becomes the parent of the character node
-                        characterNode->setParentNode(counterNode);
+            // Next, we will update the pointers for the zeroNode
+            // Making the character node the previous node in the chain
+            this->zeroNode->setPrevNode(characterNode);
 
-                        // 2. The counter node becomes the previous node in the chain from the character node
-                        characterNode->setPrevNode(counterNode);
+            // Setting the parent of the zero node to the counter node
+            this->zeroNode->setParentNode(counterNode);  
 
-                        // 3. The zeroNode becomes the next node in the chain after the character node
-                        characterNode->setNextNode(this->zeroNode);
+            // The next step in the process will be to increment the parent node of the new counter node,
+            //      if it was assigned a parent during insertion into the tree
+            if(counterNode->getParentNode() != nullptr) {
+                incrementCount(counterNode->getParentNode());
+            }
 
-                        // Next, we will update the pointers for the zeroNode
-                        // Making the character node the previous node in the chain
-                        this->zeroNode->setPrevNode(characterNode);
+            // And finally, we will record the character node as the leaf of its symbol
+            this->leaves[index] = characterNode;
 
-                        // Setting the parent of the zero node to the counter node
-                        this->zeroNode->setParentNode(counterNode);  
+            // To start the next process of checking the chain, we will set our previous and next nodes
+            // Checking to see if the counter node has a parent 
+            if(counterNode->getParentNode() != nullptr) {
+                // Now, checking to see if the parent of the counter node has a parent too
+                if(counterNode->getParentNode()->getParentNode() != nullptr) {
 
-                        // The next step in the process will be to increment the parent node of the new counter node,
-                        //      if it was assigned a parent during insertion into the tree
-                        if(counterNode->getParentNode() != nullptr) {
-                            counterNode->getParentNode()->updateCount(1);
-                        }
+                    // If the counternode has a grandparent, we will set the previous node to 
+                    //      the parent's previous and the next node to the counter nodes parent
+                    prevNode = counterNode->getParentNode()->getPrevNode();
+                    nextNode = counterNode->getParentNode();
+                }
 
-                        // And finally, we will update the alphabet array huffman node by setting the character node
-                        //      as its alphabet node
-                        alphabetArray[index].setAlphabetNode(characterNode);
+                // Else, the previous node will become the counter node's parent, and the next node
+                //      will be the counter node's previous 
+                else {
+                    prevNode = counterNode->getParentNode();
+                    nextNode = counterNode->getPrevNode();
+                }
+            }
 
-                        // To start the next process of checking the chain, we will set our previous and next nodes
-                        // Checking to see if the counter node has a parent 
-                        if(counterNode->getParentNode() != nullptr) {
-                            // Now, checking to see if the parent of the counter node has a parent too
-                            if(counterNode->getParentNode()->getParentNode() != nullptr) {
+            // Else statement that just sets the prevNode to the counter node, since it will be the root,
+            //      this way, our conditional checks below will operate properly
+            else {
+                prevNode = characterNode->getPrevNode();
+                nextNode = characterNode;
+            }
 
-                                // If the counternode has a grandparent, we will set the previous node to 
-                                //      the parent's previous and the next node to the counter nodes parent
-                                prevNode = counterNode->getParentNode()->getPrevNode();
-                                nextNode = counterNode->getParentNode();
+        }
+
+        // Else statement that will run for our second case which is that the character node
+        //      exists, and we need to increment its count
+        else {
+            // Since our character node is in the tree, we will use the leaf array to jump to the character node
+            // Setting our characterNode
+            characterNode = this->leaves[index];
+
+            // Next, we will increment the current node's count since we saw it again in the message
+            incrementCount(characterNode);
+
+            // To start the next process of checking the chain,we willset our prev node to the character 
+            //      node's prev node in the chain (i.e. its parent), and assigning the nextNode to the characterNode
+            prevNode = characterNode->getPrevNode();
+            nextNode = characterNode;
+        }
+
+        // Checking to see if the previous node has a previous node (i.e. if it is the root)
+        if(prevNode->getPrevNode() != nullptr) {
+
+            // Now, we will perform these checks through a while loop, as we need to check the chain 
+            //      up until we reach the root. 
+            while(!endOfChain) {
+
+                // Assigning the currentNode to the current prevNode
+                currentNode = prevNode;
+
+                // Since we know that we might be swapping nodes, if the leader is not the parent
+                //      of the current nextNode, we will assign next node to swapNode
+                swapNode = nextNode;
+
+                // Now, we need to locate the leader of the smaller count values and perform a swap if need be.
+                //      To do so, first, we will assign the leaderCount value to the count of the prevNode 
+                //      in the list, so we can compare the nodes behind it
+                leaderCount = currentNode->getCount();
+
+                // So, to check the order, we see if the count of the next node is less than to the 
+                //      previous node's count
+                if(currentNode->getCount() < nextNode->getCount()) {
+
+                    // Checking to see if the current node is not the root
+                    if(currentNode->getPrevNode() != nullptr) {
+                        // Now, if we know the leader of this count size we jump straight to it, and otherwise we
+                        //      will use a while loop to traverse up the chain to determine where it is at in the tree
+                        if(!jumpToLeader(leaderCount, currentNode, nextNode, prevNode)) {
+                            while(leaderCount == currentNode->getCount() && prevNode->getPrevNode() != nullptr) {
+                                // Setting the currentnode to its previous node, the nextnode to currentNode, and then 
+                                //      the prevNode to the new current's previous node for the next check for leader
+                                nextNode = currentNode;
+                                currentNode = currentNode->getPrevNode();
+                                prevNode = currentNode->getPrevNode();
                             }
 
-                            // Else, the previous node will become the counter node's parent, and the next node
-                            //      will be the counter node's previous 
-                            else {
-                                prevNode = counterNode->getParentNode();
-                                nextNode = counterNode->getPrevNode();
+                            // Remembering the leader for next time, if the walk got past the top of its block
+                            if(currentNode->getCount() != leaderCount) {
+                                rememberLeader(nextNode);
                             }
                         }
-                        
-                        // Else statement that just sets the prevNode to the counter node, since it will be the root,
-                        //      this way, our conditional checks below will operate properly
-                        else {
-                            prevNode = characterNode->getPrevNode();
-                            nextNode = characterNode;
+
+                        // Now, exiting the while loop, we will have obtained the leader of the counts and it will
+                        //      be represented as the currentNode pointer. Now, we will check if the currentNode pointer
+                        //      is the parent of the swapNode
+
+                        // If the nextNode (leader of counts) is the parent of the swap node and there is no issue
+                        //      with the order of the chain, we will just increment the parent height 
+                        if(nextNode == swapNode->getParentNode() && nextNode->getCount() < currentNode->getCount()) {
+                            incrementCount(nextNode);
                         }
 
-                    }
+                        // Else, we will perform a swap between the nextNode and the swap node
+                        else {
+                            // If the next node is the parent of the swap node, and the current node (the node previous
+                            //      to it in the chain) has a smaller count, we will assign the nextNode to be this currentNode
+                            //      since it is the leader of these smaller counts and needs to be swapped
+                            if(nextNode == swapNode->getParentNode() && currentNode->getCount() <= nextNode->getCount()) {
+                                nextNode = currentNode;
+                            }
 
-                    // Else statement that will run for our second case in decoding which is that the character node
-                    //      exists, and we need to increment its count
-                    else {
-                        // Since our character node is in the tree, we will use alphabet array alphabet node ot jump 
-                        //      to the character node
-                        // Setting our characterNode
-                        characterNode = alphabetArray[index].getAlphabetNode();
-
-                        // Next, we will increment the current node's count since we saw it again in the message
-                        characterNode->updateCount(1);
-
-                        // To start the next process of checking the chain,we willset our prev node to the character 
-                        //      node's prev node in the chain (i.e. its parent), and assigning the nextNode to the characterNode
-                        prevNode = characterNode->getPrevNode();
-                        nextNode = characterNode;
-                    }
+                            // Before we do the swap, we will get the parent, next, and prev nodes for both the next
+                            //      and swap nodes undergoing the swap in the tree
+                            nextNodeParent = nextNode->getParentNode();
+                            nextNodeNext = nextNode->getNextNode();
+                            nextNodePrev = nextNode->getPrevNode();
+                            swapNodeParent = swapNode->getParentNode();
+                            swapNodeNext = swapNode->getNextNode();
+                            swapNodePrev = swapNode->getPrevNode();
+
+                            // Our next steps will vary and have different cases: 1. The nextNode is the left child
+                            //      and the swapNode is the right child, 2. The nextNode and swapNode are both right children, and
+                            //      3. They are both left children, and 3. The nextNode is the right child and the swapNode is the left child
+                            // Conditional that will check if the next node is the left child and if the swap node is the right 
+                            //      child, if the next and swap nodes are both right nodes, or if they are both left. These are for our first three cases
+                            if( (nextNode->getParentNode()->getLeftNode() == nextNode && swapNode->getParentNode()->getRightNode() == swapNode) ||
+                                (nextNode->getParentNode()->getRightNode() == nextNode && swapNode->getParentNode()->getRightNode() == swapNode) ||
+                                (nextNode->getParentNode()->getLeftNode() == nextNode && swapNode->getParentNode()->getLeftNode() == swapNode)) {
+                                // Now, to swap these two nodes, we will first assign the pointers to their original parents
+                                //      which means, for example, the nextNodeParent will now be the parent of the 
+                                //      swap node
+                                // Handling the parent assingment for the swap node
+                                swapNode->setParentNode(nextNodeParent);
+
+                                // Now, checking to see if the next node is the left or right child of its parent
+                                if(nextNode == nextNodeParent->getLeftNode()) {
+                                    // Making the swap node the new left child of the current parent if the current node was its left
+                                    //      child
+                                    nextNodeParent->setLeftNode(swapNode);
+                                }
 
-                    // Checking to see if the previous node has a previous node (i.e. if it is the root)
-                    if(prevNode->getPrevNode() != nullptr) {
-
-                        // Now, we will perform these checks through a while loop, as we need to check the chain 
-                        //      up until we reach the root. 
-                        while(!endOfChain) {
-
-                            // Assigning the currentNode to the current prevNode
-                            currentNode = prevNode;
-
-                            // Since we know that we might be swapping nodes, if the leader is not the parent
-                            //      of the current nextNode, we will assign next node to swapNode
-                            swapNode = nextNode;
-
-                            // Now, we need to locate the leader of the smaller count values and perform a swap if need be.
-                            //      To do so, first, we will assign the leaderCount value to the count of the prevNode 
-                            //      in the list, so we can compare the nodes behind it
-                            leaderCount = currentNode->getCount();
-
-                            // So, to check the order, we see if the count of the next node is less than to the 
-                            //      previous node's count
-                            if(currentNode->getCount() < nextNode->getCount()) {
-                                    
-                                // Checking to see if the current node is not the root
-                                if(currentNode->getPrevNode() != nullptr) {
-                                    // Now, we will use a while loop to traverse up the chain to determine where the leader of 
-                                    //      this count size is at in the tree
-                                    while(leaderCount == currentNode->getCount() && prevNode->getPrevNode() != nullptr) {
-                                        // Setting the currentnode to its previous node, the nextnode to currentNode, and then 
-                                        //      the prevNode to the new current's previous node for the next check for leader
-                                        nextNode = currentNode;
-                                        currentNode = currentNode->getPrevNode();
-                                        prevNode = currentNode->getPrevNode();
-                                    }
+                                // Else, the swap node will become its right child
+                                else {
+                                    nextNodeParent->setRightNode(swapNode);
+                                }
 
-                                    // Now, exiting the while loop, we will have obtained the leader of the counts and it will
-                                    //      be represented as the currentNode pointer. Now, we will check if the currentNode pointer
-                                    //      is the parent of the swapNode
+                                // Now, we handle the parent assignment for the current node
+                                nextNode->setParentNode(swapNodeParent);
 
-                                    // If the nextNode (leader of counts) is the parent of the swap node and there is no issue
-                                    //      with the order of the chain, we will just increment the parent height 
-                                    if(nextNode == swapNode->getParentNode() && nextNode->getCount() < currentNode->getCount()) {
-                                        nextNode->updateCount(1);
+                                // Now, checking to see if the swap node was the left or right child of its parent
+                                if(swapNode == swapNodeParent->getLeftNode()) {
+                                    // Making the current node the new left child of the swap parent if the swap node was its left
+                                    //      child
+                                        swapNodeParent->setLeftNode(nextNode);
                                     }
 
-                                    // Else, we will perform a swap between the nextNode and the swap node
-                                    else {
-                                        // If the next node is the parent of the swap node, and the current node (the node previous
-                                        //      to it in the chain) has a smaller count, we will assign the nextNode to be this currentNode
-                                        //      since it is the leader of these smaller counts and needs to be swapped
-                                        if(nextNode == swapNode->getParentNode() && currentNode->getCount() <= nextNode->getCount()) {
-                                            nextNode = currentNode;
-                                        }
-
-                                        // Before we do the swap, we will get the parent, next, and prev nodes for both the next
-                                        //      and swap nodes undergoing the swap in the tree
-                                        nextNodeParent = nextNode->getParentNode();
-                                        nextNodeNext = nextNode->getNextNode();
-                                        nextNodePrev = nextNode->getPrevNode();
-                                        swapNodeParent = swapNode->getParentNode();
-                                        swapNodeNext = swapNode->getNextNode();
-                                        swapNodePrev = swapNode->getPrevNode();
-
-                                        // Our next steps will vary and have different cases: 1. The nextNode is the left child
-                                        //      and the swapNode is the right child, 2. The nextNode and swapNode are both right children, and
-                                        //      3. They are both left children, and 3. The nextNode is the right child and the swapNode is the left child
-                                        // Conditional that will check if the next node is the left child and if the swap node is the right 
-                                        //      child, if the next and swap nodes are both right nodes, or if they are both left. These are for our first three cases
-                                        if( (nextNode->getParentNode()->getLeftNode() == nextNode && swapNode->getParentNode()->getRightNode() == swapNode) ||
-                                            (nextNode->getParentNode()->getRightNode() == nextNode && swapNode->getParentNode()->getRightNode() == swapNode) ||
-                                            (nextNode->getParentNode()->getLeftNode() == nextNode && swapNode->getParentNode()->getLeftNode() == swapNode)) {
-                                            // Now, to swap these two nodes, we will first assign the pointers to their original parents
-                                            //      which means, for example, the nextNodeParent will now be the parent of the 
-                                            //      swap node
-                                            // Handling the parent assingment for the swap node
-                                            swapNode->setParentNode(nextNodeParent);
-
-                                            // Now, checking to see if the next node is the left or right child of its parent
-                                            if(nextNode == nextNodeParent->getLeftNode()) {
-                                                // Making the swap node the new left child of the current parent if the current node was its left
-                                                //      child
-                                                nextNodeParent->setLeftNode(swapNode);
-                                            }
-
-                                            // Else, the swap node will become its right child
-                                            else {
-                                                nextNodeParent->setRightNode(swapNode);
-                                            }
-
-                                            // Now, we handle the parent assignment for the current node
-                                            nextNode->setParentNode(swapNodeParent);
-
-                                            // Now, checking to see if the swap node was the left or right child of its parent
-                                            if(swapNode == swapNodeParent->getLeftNode()) {
-                                                // Making the current node the new left child of the swap parent if the swap node was its left
-                                                //      child
-                                                    swapNodeParent->setLeftNode(nextNode);
-                                                }
-
-                                            // Else, the current node will become its right child
-                                            else {
-                                                swapNodeParent->setRightNode(nextNode);
-                                            }
-
-                                            // Checking to see if we encounter the subcase of the swap node being the node in front of the
-                                            //      nextNode in the chain, this requires special assignment.
-                                            if(swapNode == nextNode->getNextNode()) {
-                                                // Working with the swap node
-                                                // Making the swap node's previous node, next's old previous
-                                                swapNode->setPrevNode(nextNodePrev);
-
-                                                // Making the next node's previous node's next, swap node
-                                                nextNodePrev->setNextNode(swapNode);
-
-                                                // Making swap node's next, the next node
-                                                swapNode->setNextNode(nextNode);
-
-                                                // Working with the next node 
-                                                // Making the next node's previous node, the swap node
-                                                nextNode->setPrevNode(swapNode);
-
-                                                // Making swap node's old next node,  next node's new next node
-                                                nextNode->setNextNode(swapNodeNext);
-
-                                                // Making swap Node next's previous, the next node
-                                                swapNodeNext->setPrevNode(nextNode);
-                                            }
-
-                                            // Else, we have a normal case that can be solved with the same assignments
-                                            else {
-                                                // Now, we handle the assignment of the rest of the nexts and previous nodes
-                                                // Working with the swap node
-                                                // Making swap node's previous node, next's old previous
-                                                swapNode->setPrevNode(nextNodePrev);
-
-                                                // Making next node's previous node's next, swap node
-                                                nextNodePrev->setNextNode(swapNode);
-
-                                                // Making swap node's next, next's old next
-                                                swapNode->setNextNode(nextNodeNext);
-
-                                                // Making the swap node the next node of nextNodeNext
-                                                nextNodeNext->setPrevNode(swapNode);
-
-                                                // Working with the next node
-                                                // Making the next node's previous node, swap's old previous
-                                                nextNode->setPrevNode(swapNodePrev);
-
-                                                // Making swap node's previous node's next, next node
-                                                swapNodePrev->setNextNode(nextNode);
-
-                                                // Making next node's next, swap's old next
-                                                nextNode->setNextNode(swapNodeNext);
-
-                                                // Making the next node the next node of swapNodeNext
-                                                swapNodeNext->setPrevNode(nextNode);
-                                            }
-                                        }
-
-                                        // Else if, the nextNode is the right child and the swapNode is the left child
-                                        else if(nextNode->getParentNode()->getRightNode() == nextNode && swapNode->getParentNode()->getLeftNode() == swapNode){
-                                            // Now, to swap these two nodes, we will first assign the pointers to their original parents
-                                            //      which means, for example, the nextNodeParent will now be the parent of the 
-                                            //      swap node
-                                            // Handling the parent assingment for the swap node
-                                            swapNode->setParentNode(nextNodeParent);
-
-                                            // Now, checking to see if the next node is the left or right child of its parent
-                                            if(nextNode == nextNodeParent->getLeftNode()) {
-                                                // Making the swap node the new left child of the current parent if the current node was its left
-                                                //      child
-                                                nextNodeParent->setLeftNode(swapNode);
-                                            }
-
-                                            // Else, the swap node will become its right child
-                                            else {
-                                                nextNodeParent->setRightNode(swapNode);
-                                            }
-
-                                            // Now, we handle the parent assignment for the current node
-                                            nextNode->setParentNode(swapNodeParent);
-
-                                            // Now, checking to see if the swap node was the left or right child of its parent
-                                            if(swapNode == swapNodeParent->getLeftNode()) {
-                                                // Making the current node the new left child of the swap parent if the swap node was its left
-                                                //      child
-                                                    swapNodeParent->setLeftNode(nextNode);
-                                                }
-
-                                            // Else, the current node will become its right child
-                                            else {
-                                                swapNodeParent->setRightNode(nextNode);
-                                            }
-
-                                            // Now, we wil check if the swap and next nodes are siblings 
-                                            if(nextNode->getNextNode() == swapNode) {
-                                                // We can start to handle the assignment of the next nodes for the swap and next nodes
-                                                // Making the nextNode's old next, the next node
-                                                swapNode->setNextNode(nextNode);
-
-                                                // Making swap node's new previous node, next's old previous
-                                                swapNode->setPrevNode(nextNodePrev);
-
-                                                // Now, for the next node, we will assign its next to the swap's old next
-                                                nextNode->setNextNode(swapNodeNext);
-
-                                                // Making the nextNode's previous pointer, the swap node
-                                                nextNode->setPrevNode(swapNode);
-
-                                                // And assinging the swap node next as the previous next node
-                                                swapNodeNext->setPrevNode(nextNode);
-
-                                                // Assigning nextNodePrev's next node to the swapNode
-                                                nextNodePrev->setNextNode(swapNode);                                     
-                                            }
-                                            
-                                            // Else, they are not siblings
-                                            else {
-                                                // Now, we handle the assignment of the rest of the nexts and previous nodes
-                                                // Working with the swap node
-                                                // Making swap node's previous node, next's old previous
-                                                swapNode->setPrevNode(nextNodePrev);
-
-                                                // Making next node's previous node's next, swap node
-                                                nextNodePrev->setNextNode(swapNode);
-
-                                                // Making swap node's next, next's old next
-                                                swapNode->setNextNode(nextNodeNext);
-
-                                                // Making the swap node the next node of nextNodeNext
-                                                nextNodeNext->setPrevNode(swapNode);
-
-                                                // Working with the next node
-                                                // Making the next node's previous node, swap's old previous
-                                                nextNode->setPrevNode(swapNodePrev);
-
-                                                // Making swap node's previous node's next, next node
-                                                swapNodePrev->setNextNode(nextNode);
-
-                                                // Making next node's next, swap's old next
-                                                nextNode->setNextNode(swapNodeNext);
-
-                                                // Making the next node the next node of swapNodeNext
-                                                swapNodeNext->setPrevNode(nextNode);                                               
-                                            }                                            
-                                        }
-
-                                        // Now, incrementing the height of the swap node's new parent
-                                        swapNode->getParentNode()->updateCount(1);
-                                    }
+                                // Else, the current node will become its right child
+                                else {
+                                    swapNodeParent->setRightNode(nextNode);
+                                }
+
+                                // Checking to see if we encounter the subcase of the swap node being the node in front of the
+                                //      nextNode in the chain, this requires special assignment.
+                                if(swapNode == nextNode->getNextNode()) {
+                                    // Working with the swap node
+                                    // Making the swap node's previous node, next's old previous
+                                    swapNode->setPrevNode(nextNodePrev);
+
+                                    // Making the next node's previous node's next, swap node
+                                    nextNodePrev->setNextNode(swapNode);
+
+                                    // Making swap node's next, the next node
+                                    swapNode->setNextNode(nextNode);
+
+                                    // Working with the next node 
+                                    // Making the next node's previous node, the swap node
+                                    nextNode->setPrevNode(swapNode);
+
+                                    // Making swap node's old next node,  next node's new next node
+                                    nextNode->setNextNode(swapNodeNext);
+
+                                    // Making swap Node next's previous, the next node
+                                    swapNodeNext->setPrevNode(nextNode);
                                 }
 
-                                // Else, if the currentNode is the root, we will just update the current node,
+                                // Else, we have a normal case that can be solved with the same assignments
                                 else {
-                                    currentNode->updateCount(1);
+                                    // Now, we handle the assignment of the rest of the nexts and previous nodes
+                                    // Working with the swap node
+                                    // Making swap node's previous node, next's old previous
+                                    swapNode->setPrevNode(nextNodePrev);
+
+                                    // Making next node's previous node's next, swap node
+                                    nextNodePrev->setNextNode(swapNode);
+
+                                    // Making swap node's next, next's old next
+                                    swapNode->setNextNode(nextNodeNext);
+
+                                    // Making the swap node the next node of nextNodeNext
+                                    nextNodeNext->setPrevNode(swapNode);
+
+                                    // Working with the next node
+                                    // Making the next node's previous node, swap's old previous
+                                    nextNode->setPrevNode(swapNodePrev);
+
+                                    // Making swap node's previous node's next, next node
+                                    swapNodePrev->setNextNode(nextNode);
+
+                                    // Making next node's next, swap's old next
+                                    nextNode->setNextNode(swapNodeNext);
+
+                                    // Making the next node the next node of swapNodeNext
+                                    swapNodeNext->setPrevNode(nextNode);
                                 }
                             }
 
-                            // Else statement that will simply update the count of the swap node's parent 
-                            //      since there is nothing wrong with the chain order
-                            else {
-                                swapNode->getParentNode()->updateCount(1);
-                            }
+                            // Else if, the nextNode is the right child and the swapNode is the left child
+                            else if(nextNode->getParentNode()->getRightNode() == nextNode && swapNode->getParentNode()->getLeftNode() == swapNode){
+                                // Now, to swap these two nodes, we will first assign the pointers to their original parents
+                                //      which means, for example, the nextNodeParent will now be the parent of the 
+                                //      swap node
+                                // Handling the parent assingment for the swap node
+                                swapNode->setParentNode(nextNodeParent);
+
+                                // Now, checking to see if the next node is the left or right child of its parent
+                                if(nextNode == nextNodeParent->getLeftNode()) {
+                                    // Making the swap node the new left child of the current parent if the current node was its left
+                                    //      child
+                                    nextNodeParent->setLeftNode(swapNode);
+                                }
 
-                            // Checking to see if the swap node's parent has a revious node of itself (i.e. if it is not the root)
-                            if(swapNode->getParentNode()->getPrevNode() != nullptr) {
-                                // Traversing up the chain by assigning the previous node to the current node's prevNode and the next node
-                                //      to the original current node
-                                nextNode = swapNode->getParentNode();
-                                prevNode = swapNode->getParentNode()->getPrevNode(); 
-                            }
+                                // Else, the swap node will become its right child
+                                else {
+                                    nextNodeParent->setRightNode(swapNode);
+                                }
+
+                                // Now, we handle the parent assignment for the current node
+                                nextNode->setParentNode(swapNodeParent);
+
+                                // Now, checking to see if the swap node was the left or right child of its parent
+                                if(swapNode == swapNodeParent->getLeftNode()) {
+                                    // Making the current node the new left child of the swap parent if the swap node was its left
+                                    //      child
+                                        swapNodeParent->setLeftNode(nextNode);
+                                    }
+
+                                // Else, the current node will become its right child
+                                else {
+                                    swapNodeParent->setRightNode(nextNode);
+                                }
 
-                            // Else, the current node is the root, so we will stop the traversal process
-                            else {
-                                endOfChain = true;
+                                // Now, we wil check if the swap and next nodes are siblings 
+                                if(nextNode->getNextNode() == swapNode) {
+                                    // We can start to handle the assignment of the next nodes for the swap and next nodes
+                                    // Making the nextNode's old next, the next node
+                                    swapNode->setNextNode(nextNode);
+
+                                    // Making swap node's new previous node, next's old previous
+                                    swapNode->setPrevNode(nextNodePrev);
+
+                                    // Now, for the next node, we will assign its next to the swap's old next
+                                    nextNode->setNextNode(swapNodeNext);
+
+                                    // Making the nextNode's previous pointer, the swap node
+                                    nextNode->setPrevNode(swapNode);
+
+                                    // And assinging the swap node next as the previous next node
+                                    swapNodeNext->setPrevNode(nextNode);
+
+                                    // Assigning nextNodePrev's next node to the swapNode
+                                    nextNodePrev->setNextNode(swapNode);                                     
+                                }
+
+                                // Else, they are not siblings
+                                else {
+                                    // Now, we handle the assignment of the rest of the nexts and previous nodes
+                                    // Working with the swap node
+                                    // Making swap node's previous node, next's old previous
+                                    swapNode->setPrevNode(nextNodePrev);
+
+                                    // Making next node's previous node's next, swap node
+                                    nextNodePrev->setNextNode(swapNode);
+
+                                    // Making swap node's next, next's old next
+                                    swapNode->setNextNode(nextNodeNext);
+
+                                    // Making the swap node the next node of nextNodeNext
+                                    nextNodeNext->setPrevNode(swapNode);
+
+                                    // Working with the next node
+                                    // Making the next node's previous node, swap's old previous
+                                    nextNode->setPrevNode(swapNodePrev);
+
+                                    // Making swap node's previous node's next, next node
+                                    swapNodePrev->setNextNode(nextNode);
+
+                                    // Making next node's next, swap's old next
+                                    nextNode->setNextNode(swapNodeNext);
+
+                                    // Making the next node the next node of swapNodeNext
+                                    swapNodeNext->setPrevNode(nextNode);                                               
+                                }                                            
                             }
-                        }                    
+
+                            // Now, handing on the next node's leadership now that it is further down the chain, and
+                            //      incrementing the height of the swap node's new parent
+                            leaderMovedDown(nextNode, swapNode);
+                            incrementCount(swapNode->getParentNode());
+                        }
                     }
 
-                    // Else if statement that will handle the case where we are dealing with the root node directly with no iteration
-                    //      through the tree. This will update the count of the root node (prevNode) if the sum of its two children
-                    //      are not equal to it.
-                    else if(prevNode->getCount() != (prevNode->getLeftNode()->getCount() + prevNode->getRightNode()->getCount())){
-                        prevNode->updateCount(1);
+                    // Else, if the currentNode is the root, we will just update the current node,
+                    else {
+                        incrementCount(currentNode);
                     }
                 }
 
-                // Else statement that will throw an exception since the character was not in our alphabet
+                // Else statement that will simply update the count of the swap node's parent 
+                //      since there is nothing wrong with the chain order
+                else {
+                    incrementCount(swapNode->getParentNode());
+                }
+
+                // Checking to see if the swap node's parent has a revious node of itself (i.e. if it is not the root)
+                if(swapNode->getParentNode()->getPrevNode() != nullptr) {
+                    // Traversing up the chain by assigning the previous node to the current node's prevNode and the next node
+                    //      to the original current node
+                    nextNode = swapNode->getParentNode();
+                    prevNode = swapNode->getParentNode()->getPrevNode(); 
+                }
+
+                // Else, the current node is the root, so we will stop the traversal process
+                else {
+                    endOfChain = true;
+                }
+            }                    
+        }
+
+        // Else if statement that will handle the case where we are dealing with the root node directly with no iteration
+        //      through the tree. This will update the count of the root node (prevNode) if the sum of its two children
+        //      are not equal to it.
+        else if(prevNode->getCount() != (prevNode->getLeftNode()->getCount() + prevNode->getRightNode()->getCount())){
+            incrementCount(prevNode);
+        }
+
+        // With a code length limit, we halve the counts once the root gets to the count where the tree could
+        //      grow deeper than the limit
+        if(this->rescaleCount != 0 && this->root->getCount() >= Count(this->rescaleCount)) {
+            rescale();
+        }
+    }
+
+    // Function that halves the count of every symbol in the tree and builds the tree again from the new counts.
+    //      The new tree is built the way the static Huffman algorithm builds one, always joining the two smallest
+    //      nodes. Nodes come off the two queues in order of count, so laying them out in reverse gives a chain in
+    //      the order the updates expect: counts never rising, and each right child just before its left sibling
+    void rescale() {
+        // Creating the list of symbols in the tree and their halved counts, which are never less than one
+        vector<pair<Count, int>> characters;
+        characters.reserve(this->symbolCount);
+
+        for(int i = 0; i < this->symbolCount; i++) {
+            Node* characterNode = this->leaves[i];
+
+            if(characterNode != nullptr) {
+                characters.push_back(make_pair(Count((characterNode->getCount() + 1) / 2), i));
+            }
+        }
+
+        // Sorting the symbols by their new count, and by their place in the alphabet when the counts are equal,
+        //      so the encoder and decoder always build the same tree
+        sort(characters.begin(), characters.end());
+        int characterCount = (int)characters.size();
+
+        // Starting over with just the zero node, and making a fresh node for each symbol. The leaves queue is the
+        //      zero node followed by the symbols from the smallest count up
+        resetNodes();
+
+        vector<Node*> queuedLeaves(characterCount + 1);
+        queuedLeaves[0] = this->zeroNode;
+
+        for(int i = 0; i < characterCount; i++) {
+            Node* characterNode = allocateNode();
+            characterNode->setCharacter(this->symbols[characters[i].second]);
+            characterNode->updateCount(int(characters[i].first) - 1);
+            this->leaves[characters[i].second] = characterNode;
+            queuedLeaves[i + 1] = characterNode;
+        }
+
+        // Joining the two smallest nodes until one is left. Counter nodes are made in order of count, so they queue
+        //      up in order too. Each node is recorded in the order it was joined. On equal counts the counter node
+        //      is joined first, which puts it behind the characters of that count in the chain. That way the leader
+        //      of a character's count is never its own parent, which the update expects
+        vector<Node*> counters(characterCount + 1);
+        vector<Node*> joinOrder(2 * characterCount + 2);
+        int leafCount = characterCount + 1;
+        int nextLeaf = 0;
+        int nextCounter = 0;
+        int counterCount = 0;
+        int joined = 0;
+
+        while((leafCount - nextLeaf) + (counterCount - nextCounter) > 1) {
+            Node* smallest[2];
+
+            for(int k = 0; k < 2; k++) {
+                if(nextCounter == counterCount || (nextLeaf < leafCount && queuedLeaves[nextLeaf]->getCount() < counters[nextCounter]->getCount())) {
+                    smallest[k] = queuedLeaves[nextLeaf++];
+                }
                 else {
-                    throw HuffmanException("Invalid Character In Message. Re-Run Program To Try Again.");
-                }  
+                    smallest[k] = counters[nextCounter++];
+                }
+                joinOrder[joined++] = smallest[k];
+            }
+
+            // The smaller node becomes the left child, so the zero node is always a left child like it is after an
+            //      insert
+            Node* counterNode = allocateNode();
+            counterNode->updateCount(int(smallest[0]->getCount() + smallest[1]->getCount()) - 1);
+            counterNode->setLeftNode(smallest[0]);
+            counterNode->setRightNode(smallest[1]);
+            smallest[0]->setParentNode(counterNode);
+            smallest[1]->setParentNode(counterNode);
+            counters[counterCount++] = counterNode;
+        }
+
+        // The last node standing is the root, and the chain runs from it back through the join order
+        this->root = counters[counterCount - 1];
+
+        Node* previous = this->root;
+        for(int i = joined - 1; i >= 0; i--) {
+            previous->setNextNode(joinOrder[i]);
+            joinOrder[i]->setPrevNode(previous);
+            previous = joinOrder[i];
+        }
+    }
+};
+
+// Creating the trees over wider symbols and narrower counts. The 16 bit tree fits token dictionaries, the 32 bit
+//      tree fits scattered values such as Unicode code points, and the compact tree halves the size of a byte
+//      tree's counts for coders that keep many trees around
+using AdaptiveHuffmanTree16 = BasicAdaptiveHuffmanTree<uint16_t, uint32_t, 65536>;
+using AdaptiveHuffmanTree32 = BasicAdaptiveHuffmanTree<uint32_t, uint64_t, 65536>;
+using CompactAdaptiveHuffmanTree = BasicAdaptiveHuffmanTree<uint8_t, uint16_t, 256>;
+
+// Creating the byte tree, which takes its alphabet as a string and codes messages held in strings
+class AdaptiveHuffmanTree : public BasicAdaptiveHuffmanTree<uint8_t, int32_t, 256>
+{
+    private:
+    // Creating the 256 bit membership set of the alphabet, which the vectorized message check works from
+    AlphabetBitmap alphabetBitmap;
+
+    public:
+    // Creating the byte tree's base class
+    using Base = BasicAdaptiveHuffmanTree<uint8_t, int32_t, 256>;
+
+    // Creating our overloaded constructor that takes in the alphabet string as its parameter. The optional second
+    //      parameter caps the length of every code (not counting the eight bits after the zero node's code), so
+    //      that coding a character never walks more than that many levels. Trees only read what trees with the
+    //      same limit wrote
+    AdaptiveHuffmanTree(string alphabet, int maxCodeLength = NO_CODE_LENGTH_LIMIT)
+        : AdaptiveHuffmanTree(parseAlphabet(alphabet), maxCodeLength, true) {}
+
+    // Constructor that takes an alphabet compiled by compileAlphabet. The tree reads the characters, their lookup
+    //      and the membership set in place, so the compiled alphabet has to outlive it, which one declared constexpr
+    //      at namespace scope always does. Only the tree's own nodes are allocated
+    explicit AdaptiveHuffmanTree(const CompiledAlphabet& alphabet, int maxCodeLength = NO_CODE_LENGTH_LIMIT)
+        : Base(alphabet.symbols, alphabet.size, alphabet.symbolIndex, 256, maxCodeLength), alphabetBitmap(alphabet.bitmap) {}
+
+    // Moving a byte tree moves its nodes the same way as the template, and copying is not allowed
+    AdaptiveHuffmanTree(AdaptiveHuffmanTree&& other) noexcept = default;
+    AdaptiveHuffmanTree& operator=(AdaptiveHuffmanTree&& other) noexcept = default;
+
+    // Function that returns an independent deep copy of this tree, including everything it has adapted to so far
+    AdaptiveHuffmanTree clone() const {
+        AdaptiveHuffmanTree copy;
+        cloneInto(copy);
+        copy.alphabetBitmap = this->alphabetBitmap;
+        return copy;
+    }
+
+    // Function that returns the characters of the alphabet, in the order they appear in the alphabet
+    string getAlphabetSymbols() const {
+        return string((const char*)this->symbols, this->symbolCount);
+    }
+
+    // Function that returns the membership set of the alphabet
+    const AlphabetBitmap& getAlphabetBitmap() const noexcept {
+        return this->alphabetBitmap;
+    }
+
+    // Function that checks every character of a message against the alphabet before any tree work is done.
+    //      The result holds the byte offset of the first character that is not in the alphabet
+    HuffmanResult validateMessage(string_view messageString) const noexcept {
+        return scanAlphabet(this->alphabetBitmap, messageString.data(), messageString.size(), nullptr);
+    }
+
+    // Function that does the same check as validateMessage, and also adds the count of every byte value in
+    //      the message to the 256 element histogram passed in, in the same pass over the message
+    HuffmanResult scanMessage(string_view messageString, uint64_t* histogram) const noexcept {
+        return scanAlphabet(this->alphabetBitmap, messageString.data(), messageString.size(), histogram);
+    }
+
+    // Function that checks that an encoded message only holds '0' and '1' characters before any tree work is done
+    HuffmanResult validateEncodedMessage(string_view messageString) const noexcept {
+        for(size_t i = 0; i < messageString.size(); i++) {
+            if(messageString[i] != '0' && messageString[i] != '1') {
+                return huffmanFailure(HUFFMAN_INVALID_BIT, i);
+            }
+        }
+
+        return huffmanSuccess();
+    }
+
+    // Creating our encode method that takes in the string message that will be encoded as a parameter. This method
+    //      then returns the encoded version of the original message as a string, and throws a HuffmanException
+    //      if the message holds a character that is not in the alphabet.
+    string encode(string messageString) {
+        // Creating the string that will hold the encoded message
+        string encodedMessage;
+
+        // Running the non-throwing version of encode, and turning a failed result into an exception
+        HuffmanResult result = encode(string_view(messageString), encodedMessage);
+
+        if(!result.ok()) {
+            throw HuffmanException(string(describeHuffmanStatus(result.status)) + " At Byte " + to_string(result.errorOffset) + ".");
+        }
+
+        return encodedMessage;
+    }
+
+    // Creating the non-throwing encode method. The encoded version of the message is appended to encodedMessage as
+    //      '0'/'1' characters, and the returned result holds the status along with the byte offset of the first bad
+    //      character. Nothing is printed from here, so callers can use this on their hot paths.
+    HuffmanResult encode(string_view messageString, string& encodedMessage) noexcept {
+        AsciiBitWriter writer(encodedMessage);
+        return encodeMessage(messageString.data(), messageString.size(), writer);
+    }
 
+    // Creating the encode method that writes packed bits (eight to a byte, first bit in the high bit) straight
+    //      into a caller's buffer. The result holds the number of bytes and bits written. A buffer of
+    //      maxEncodedBytes(message length) bytes is always big enough; a smaller one may give HUFFMAN_OUTPUT_FULL.
+    HuffmanResult encode(string_view messageString, unsigned char* output, size_t capacity) noexcept {
+        ByteWriter bytes((char*)output, capacity);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(messageString.data(), messageString.size(), writer);
+    }
+
+    // Creating the encode method that writes packed bits into a caller's sink, a few kilobytes at a time
+    HuffmanResult encode(string_view messageString, HuffmanSink& sink) noexcept {
+        ByteWriter bytes(sink);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(messageString.data(), messageString.size(), writer);
+    }
+
+    // Creating our decode method that takes in the encoded string message and decodes it. After decoding, this method
+    //      then returns decoded version of the encoded message, which should be the original message. A HuffmanException
+    //      is thrown if the encoded message is malformed.
+    string decode(string messageString) {
+        // Creating the string that will hold the decoded message
+        string decodedMessage;
+
+        // Running the non-throwing version of decode, and turning a failed result into an exception
+        HuffmanResult result = decode(string_view(messageString), decodedMessage);
+
+        if(!result.ok()) {
+            throw HuffmanException(string(describeHuffmanStatus(result.status)) + " At Byte " + to_string(result.errorOffset) + ".");
+        }
+
+        return decodedMessage;
+    }
+
+    // Creating the non-throwing decode method for the '0'/'1' form. The decoded message is appended to decodedMessage,
+    //      and the returned result holds the status along with the byte offset in the encoded message where decoding failed.
+    HuffmanResult decode(string_view messageString, string& decodedMessage) noexcept {
+        // Before doing any work on the tree, we check that the encoded message only holds bits
+        HuffmanResult validation = validateEncodedMessage(messageString);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+
+        AsciiBitReader reader(messageString.data(), messageString.size());
+        ByteWriter output(decodedMessage);
+        return decodeMessage(reader, output);
+    }
+
+    // Creating the decode method for packed bits, reading bitCount bits from input and writing the decoded characters
+    //      into a caller's buffer. A buffer of bitCount bytes is always big enough, since every character takes at
+    //      least one bit. Error offsets are in bits.
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, char* output, size_t capacity) noexcept {
+        PackedBitReader reader(input, bitCount);
+        ByteWriter bytes(output, capacity);
+        return decodeMessage(reader, bytes);
+    }
+
+    // Creating the decode method for packed bits that writes the decoded characters into a caller's sink
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, HuffmanSink& sink) noexcept {
+        PackedBitReader reader(input, bitCount);
+        ByteWriter bytes(sink);
+        return decodeMessage(reader, bytes);
+    }
+
+#ifdef __cpp_lib_span
+    // Span versions of the buffer methods above, for callers that already hold their buffers as spans
+    HuffmanResult encode(span<const uint8_t> message, span<uint8_t> output) noexcept {
+        return encode(string_view((const char*)message.data(), message.size()), output.data(), output.size());
+    }
+
+    HuffmanResult decode(span<const uint8_t> input, uint64_t bitCount, span<char> output) noexcept {
+        if(bitCount > uint64_t(input.size()) * 8) {
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, uint64_t(input.size()) * 8);
+        }
+        return decode(input.data(), bitCount, output.data(), output.size());
+    }
+#endif
+
+    // The byte tree's coders hold their characters as char, so the per symbol methods take char as well as the
+    //      template's unsigned bytes
+    using Base::decodeSymbol;
+    using Base::decodeSymbolOrEscape;
+
+    template<class BitReader>
+    HuffmanStatus decodeSymbol(BitReader& reader, char& character) {
+        return Base::decodeSymbol(reader, (uint8_t&)character);
+    }
+
+    template<class BitReader>
+    HuffmanStatus decodeSymbolOrEscape(BitReader& reader, char& character, bool& escaped) {
+        return Base::decodeSymbolOrEscape(reader, (uint8_t&)character, escaped);
+    }
+
+    private:
+    // Private constructor for an empty tree, which clone() fills in
+    AdaptiveHuffmanTree() noexcept : Base() {}
+
+    // Private constructor that takes the parsed characters, so they only have to be parsed once
+    AdaptiveHuffmanTree(const string& symbols, int maxCodeLength, bool)
+        : Base((const uint8_t*)symbols.data(), symbols.size(), maxCodeLength) {
+        int symbolIndex[256];
+        buildSymbolIndex(symbols, symbolIndex, this->alphabetBitmap);
+    }
+
+    // Function that runs the encoder over a whole message, writing through the given bit writer
+    template<class BitWriter>
+    HuffmanResult encodeMessage(const char* message, size_t messageLength, BitWriter& writer) noexcept {
+        // Before doing any work on the tree, we check the whole message against the alphabet, so a bad message
+        //      is rejected without changing the tree at all
+        HuffmanResult validation = scanAlphabet(this->alphabetBitmap, message, messageLength, nullptr);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+
+        // Now, we will create a for loop that will iterate through the total length of the string message, and
+        //      encode each character into the writer
+        for(size_t i = 0; i < messageLength; i++) {
+            encodeCharacter(this->symbolIndex[(unsigned char)message[i]], writer);
+
+            // Stopping as soon as the caller's output can't take any more
+            if(writer.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, i);
             }
-            
-            // Finally, returning the fully encoded message
-            return decodedMessage;
         }
-        
-        // Catching the error thrown if a character is not in the alphabet
-        catch(HuffmanException error) {            
-            error.outputError();
-            return "NULL";
+
+        // Flushing the last partial byte, which can also run out of room
+        if(!writer.finish()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, messageLength);
         }
+
+        // Finally, letting the caller know the message was fully encoded
+        return huffmanSuccess(writer.bytesWritten(), writer.bitsWritten());
+    }
+
+    // Function that runs the decoder over a whole encoded message, writing the characters through the byte writer
+    template<class BitReader>
+    HuffmanResult decodeMessage(BitReader& reader, ByteWriter& output) noexcept {
+        // Now, we will create a while loop that will let us iterate through the entire message without
+        //      having a bounds issue
+        while(!reader.atEnd()) {
+            // Keeping the offset of the first bit of this character, which is what we report if it is bad
+            uint64_t symbolOffset = reader.getPosition();
+            int index = -1;
+
+            HuffmanStatus status = decodeCharacter(reader, index);
+            if(status != HUFFMAN_SUCCESS) {
+                return huffmanFailure(status, status == HUFFMAN_TRUNCATED_MESSAGE ? reader.getPosition() : symbolOffset);
+            }
+
+            output.put(char(this->symbols[index]));
+            if(output.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, symbolOffset);
+            }
+        }
+
+        if(!output.flush()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, reader.getPosition());
+        }
+
+        // Finally, letting the caller know the message was fully decoded
+        return huffmanSuccess(output.bytesWritten(), uint64_t(output.bytesWritten()) * 8);
     }
 
+    public:
+
     // Creating a reverse method that will allow us to properly track the path it takes from the root down to the 
     //      desired character.
     string reverseString(string path) {
@@ -0,0 +1,231 @@
+/*
+    Purpose: Check a whole message against the alphabet before the tree ever sees it, and count how
+        often each byte appears while we are at it. The alphabet is kept as a 256 bit membership set,
+        and the check runs sixteen (SSE4.2) or thirty-two (AVX2) bytes at a time, picking the widest
+        version the processor supports at run time. Machines and compilers without those instructions
+        fall back to a plain byte by byte loop that gives the same answers.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "HuffmanResult.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HUFFMAN_HAVE_X86_SIMD 1
+#endif
+
+// Creating the number of bytes we check before counting them into the histogram. The chunk stays in the
+//      L1 cache between the two steps, so the histogram does not cost a second trip to memory
+const size_t ALPHABET_SCAN_CHUNK_SIZE = 4096;
+
+// Creating the 256 bit membership set for an alphabet. Bit b is set when byte value b is in the alphabet
+struct AlphabetBitmap {
+    uint64_t bits[4];
+
+    // Function that adds a byte value to the set
+    constexpr void add(unsigned char character) noexcept {
+        bits[character >> 6] |= uint64_t(1) << (character & 63);
+    }
+
+    // Function that checks if a byte value is in the set
+    constexpr bool contains(unsigned char character) const noexcept {
+        return (bits[character >> 6] >> (character & 63)) & 1;
+    }
+};
+
+// Creating the nibble tables the vector versions use to look up membership. For a byte b, we use its low
+//      four bits to pick a row byte from lowRows (high nibbles 0 to 7) or highRows (high nibbles 8 to 15),
+//      and its high four bits to pick which bit of that row byte to test
+struct AlphabetNibbleTables {
+    alignas(16) unsigned char lowRows[16];
+    alignas(16) unsigned char highRows[16];
+    alignas(16) unsigned char bitForHighNibble[16];
+};
+
+// Function that builds the nibble tables from the membership set
+inline AlphabetNibbleTables buildNibbleTables(const AlphabetBitmap& bitmap) noexcept {
+    AlphabetNibbleTables tables;
+    memset(&tables, 0, sizeof(tables));
+
+    for(int b = 0; b < 256; b++) {
+        if(bitmap.contains((unsigned char)b)) {
+            int low = b & 15;
+            int high = b >> 4;
+
+            if(high < 8) {
+                tables.lowRows[low] |= (unsigned char)(1 << high);
+            }
+            else {
+                tables.highRows[low] |= (unsigned char)(1 << (high - 8));
+            }
+        }
+    }
+
+    for(int high = 0; high < 16; high++) {
+        tables.bitForHighNibble[high] = (unsigned char)(1 << (high & 7));
+    }
+
+    return tables;
+}
+
+// Function that returns the offset of the first byte not in the alphabet, or length if every byte is in it.
+//      This is the plain version every other version has to agree with.
+inline size_t findInvalidByteScalar(const AlphabetBitmap& bitmap, const unsigned char* data, size_t length) noexcept {
+    for(size_t i = 0; i < length; i++) {
+        if(!bitmap.contains(data[i])) {
+            return i;
+        }
+    }
+
+    return length;
+}
+
+#ifdef HUFFMAN_HAVE_X86_SIMD
+// SSE4.2 version, sixteen bytes per step. The blend that picks between the two row tables is what needs
+//      SSE4.1; everything else is SSSE3
+__attribute__((target("sse4.2")))
+inline size_t findInvalidByteSse42(const AlphabetBitmap& bitmap, const unsigned char* data, size_t length) noexcept {
+    AlphabetNibbleTables tables = buildNibbleTables(bitmap);
+    const __m128i lowRows = _mm_load_si128((const __m128i*)tables.lowRows);
+    const __m128i highRows = _mm_load_si128((const __m128i*)tables.highRows);
+    const __m128i bitTable = _mm_load_si128((const __m128i*)tables.bitForHighNibble);
+    const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for(; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i lowNibbles = _mm_and_si128(bytes, nibbleMask);
+        __m128i highNibbles = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibbleMask);
+
+        // The top bit of each byte tells the blend whether to take the row from the high table
+        __m128i rows = _mm_blendv_epi8(_mm_shuffle_epi8(lowRows, lowNibbles), _mm_shuffle_epi8(highRows, lowNibbles), bytes);
+        __m128i bits = _mm_shuffle_epi8(bitTable, highNibbles);
+        __m128i missing = _mm_cmpeq_epi8(_mm_and_si128(rows, bits), zero);
+
+        int mask = _mm_movemask_epi8(missing);
+        if(mask != 0) {
+            return i + __builtin_ctz((unsigned)mask);
+        }
+    }
+
+    size_t tail = findInvalidByteScalar(bitmap, data + i, length - i);
+    return i + tail;
+}
+
+// AVX2 version, thirty-two bytes per step. The shuffles work within each 128 bit lane, so the tables are
+//      copied into both lanes
+__attribute__((target("avx2")))
+inline size_t findInvalidByteAvx2(const AlphabetBitmap& bitmap, const unsigned char* data, size_t length) noexcept {
+    AlphabetNibbleTables tables = buildNibbleTables(bitmap);
+    const __m256i lowRows = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)tables.lowRows));
+    const __m256i highRows = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)tables.highRows));
+    const __m256i bitTable = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)tables.bitForHighNibble));
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for(; i + 32 <= length; i += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i lowNibbles = _mm256_and_si256(bytes, nibbleMask);
+        __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibbleMask);
+
+        __m256i rows = _mm256_blendv_epi8(_mm256_shuffle_epi8(lowRows, lowNibbles), _mm256_shuffle_epi8(highRows, lowNibbles), bytes);
+        __m256i bits = _mm256_shuffle_epi8(bitTable, highNibbles);
+        __m256i missing = _mm256_cmpeq_epi8(_mm256_and_si256(rows, bits), zero);
+
+        unsigned mask = (unsigned)_mm256_movemask_epi8(missing);
+        if(mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    size_t tail = findInvalidByteScalar(bitmap, data + i, length - i);
+    return i + tail;
+}
+#endif
+
+// Creating the type for the functions above, so we only have to pick one once
+typedef size_t (*AlphabetScanFunction)(const AlphabetBitmap&, const unsigned char*, size_t);
+
+// Function that picks the widest version this processor supports. The choice is made the first time
+//      we are called and then kept
+inline AlphabetScanFunction selectAlphabetScanFunction() noexcept {
+    static const AlphabetScanFunction selected = []() -> AlphabetScanFunction {
+#ifdef HUFFMAN_HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return findInvalidByteAvx2;
+        }
+        if(__builtin_cpu_supports("sse4.2")) {
+            return findInvalidByteSse42;
+        }
+#endif
+        return findInvalidByteScalar;
+    }();
+
+    return selected;
+}
+
+// Function that checks a whole buffer against the alphabet and, when histogram is not null, adds the
+//      count of every byte value to it. The buffer is worked through in chunks: each chunk is checked with
+//      the vector version and then counted while it is still in the cache. On failure the result holds
+//      the offset of the first byte not in the alphabet, and the histogram holds the bytes before it.
+inline HuffmanResult scanAlphabet(const AlphabetBitmap& bitmap, const char* message, size_t length, uint64_t* histogram) noexcept {
+    const unsigned char* data = (const unsigned char*)message;
+    AlphabetScanFunction findInvalidByte = selectAlphabetScanFunction();
+
+    // Without a histogram to fill there is no reason to chunk the buffer
+    if(histogram == nullptr) {
+        size_t invalid = findInvalidByte(bitmap, data, length);
+
+        if(invalid != length) {
+            return huffmanFailure(HUFFMAN_INVALID_CHARACTER, invalid);
+        }
+
+        return huffmanSuccess();
+    }
+
+    // Counting into four separate tables, so runs of the same byte don't keep waiting on one counter
+    uint32_t partialCounts[4][256];
+    memset(partialCounts, 0, sizeof(partialCounts));
+
+    for(size_t start = 0; start < length; start += ALPHABET_SCAN_CHUNK_SIZE) {
+        size_t chunkLength = length - start < ALPHABET_SCAN_CHUNK_SIZE ? length - start : ALPHABET_SCAN_CHUNK_SIZE;
+        const unsigned char* chunk = data + start;
+        size_t invalid = findInvalidByte(bitmap, chunk, chunkLength);
+
+        // Only counting the bytes before a bad one, so the histogram always matches what was accepted
+        size_t countLength = invalid;
+        size_t i = 0;
+
+        for(; i + 4 <= countLength; i += 4) {
+            partialCounts[0][chunk[i]]++;
+            partialCounts[1][chunk[i + 1]]++;
+            partialCounts[2][chunk[i + 2]]++;
+            partialCounts[3][chunk[i + 3]]++;
+        }
+
+        for(; i < countLength; i++) {
+            partialCounts[0][chunk[i]]++;
+        }
+
+        // Folding the partial tables into the caller's histogram every so often, well before a 32 bit
+        //      counter could overflow
+        bool lastChunk = (invalid != chunkLength) || (start + chunkLength >= length);
+        if(lastChunk || ((start / ALPHABET_SCAN_CHUNK_SIZE) & 0xffff) == 0xffff) {
+            for(int b = 0; b < 256; b++) {
+                histogram[b] += uint64_t(partialCounts[0][b]) + partialCounts[1][b] + partialCounts[2][b] + partialCounts[3][b];
+            }
+            memset(partialCounts, 0, sizeof(partialCounts));
+        }
+
+        if(invalid != chunkLength) {
+            return huffmanFailure(HUFFMAN_INVALID_CHARACTER, start + invalid);
+        }
+    }
+
+    return huffmanSuccess();
+}
@@ -0,0 +1,198 @@
+/*
+    Purpose: Convert between the text form of an encoded message, where every bit is written out as a '0'
+        or '1' character, and a packed form that stores eight bits per byte. The packed form starts with
+        a small header (the "AHPK" magic and the number of bits as a 64 bit little endian value) followed by
+        the bits, first bit in the high bit of the first byte. With AVX2, thirty-two characters are compared
+        and gathered into a 32 bit mask per step, so existing .encoded files can be moved to the packed
+        form without decoding them.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "HuffmanResult.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HUFFMAN_HAVE_X86_SIMD 1
+#endif
+
+// Creating the magic bytes and the header size of a packed bit file
+const char PACKED_BITS_MAGIC[4] = {'A', 'H', 'P', 'K'};
+const size_t PACKED_BITS_HEADER_SIZE = 12;
+
+// Function that packs '0'/'1' characters into bytes, written to the output array, which must hold
+//      (length + 7) / 8 bytes. The last byte is padded with zero bits. Returns the offset of the first
+//      character that is not a bit, or length when every character was a bit.
+inline size_t packBitsScalar(const char* text, size_t length, unsigned char* output) noexcept {
+    size_t i = 0;
+
+    for(; i + 8 <= length; i += 8) {
+        unsigned value = 0;
+
+        for(int j = 0; j < 8; j++) {
+            unsigned bit = (unsigned char)(text[i + j] - '0');
+            if(bit > 1) {
+                return i + j;
+            }
+            value = (value << 1) | bit;
+        }
+
+        output[i / 8] = (unsigned char)value;
+    }
+
+    if(i < length) {
+        unsigned value = 0;
+        size_t remaining = length - i;
+
+        for(size_t j = 0; j < remaining; j++) {
+            unsigned bit = (unsigned char)(text[i + j] - '0');
+            if(bit > 1) {
+                return i + j;
+            }
+            value = (value << 1) | bit;
+        }
+
+        output[i / 8] = (unsigned char)(value << (8 - remaining));
+    }
+
+    return length;
+}
+
+// Function that writes the first bitCount bits of the packed bytes out as '0'/'1' characters
+inline void unpackBitsScalar(const unsigned char* packed, size_t bitCount, char* text) noexcept {
+    for(size_t i = 0; i < bitCount; i++) {
+        text[i] = char('0' + ((packed[i >> 3] >> (7 - (i & 7))) & 1));
+    }
+}
+
+#ifdef HUFFMAN_HAVE_X86_SIMD
+// AVX2 version of packBitsScalar. Each step reads thirty-two characters, checks they are all bits, reverses
+//      every group of eight so the first character lands in the high bit, and gathers the low bits with a
+//      single movemask into four output bytes
+__attribute__((target("avx2")))
+inline size_t packBitsAvx2(const char* text, size_t length, unsigned char* output) noexcept {
+    const __m256i zeroCharacter = _mm256_set1_epi8('0');
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i reverseGroups = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                                   7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+    size_t i = 0;
+    for(; i + 32 <= length; i += 32) {
+        __m256i characters = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i bits = _mm256_sub_epi8(characters, zeroCharacter);
+
+        // A character is a bit when its distance from '0' is at most one
+        __m256i valid = _mm256_cmpeq_epi8(_mm256_max_epu8(bits, one), one);
+        unsigned validMask = (unsigned)_mm256_movemask_epi8(valid);
+        if(validMask != 0xffffffffu) {
+            return i + __builtin_ctz(~validMask);
+        }
+
+        __m256i reversed = _mm256_shuffle_epi8(bits, reverseGroups);
+        uint32_t packedBits = (uint32_t)_mm256_movemask_epi8(_mm256_slli_epi16(reversed, 7));
+        memcpy(output + i / 8, &packedBits, 4);
+    }
+
+    size_t tail = packBitsScalar(text + i, length - i, output + i / 8);
+    return i + tail;
+}
+
+// AVX2 version of unpackBitsScalar. Each step spreads four packed bytes across thirty-two lanes, tests
+//      one bit per lane, and turns the result into '0'/'1' characters
+__attribute__((target("avx2")))
+inline void unpackBitsAvx2(const unsigned char* packed, size_t bitCount, char* text) noexcept {
+    const __m256i spreadBytes = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                                 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bitSelect = _mm256_setr_epi8((char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                               (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                               (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                               (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m256i zeroCharacter = _mm256_set1_epi8('0');
+
+    size_t i = 0;
+    for(; i + 32 <= bitCount; i += 32) {
+        uint32_t word;
+        memcpy(&word, packed + i / 8, 4);
+
+        __m256i spread = _mm256_shuffle_epi8(_mm256_set1_epi32((int)word), spreadBytes);
+        __m256i isSet = _mm256_cmpeq_epi8(_mm256_and_si256(spread, bitSelect), bitSelect);
+
+        // isSet is -1 for a one bit, so subtracting it from '0' gives '1'
+        _mm256_storeu_si256((__m256i*)(text + i), _mm256_sub_epi8(zeroCharacter, isSet));
+    }
+
+    unpackBitsScalar(packed + i / 8, bitCount - i, text + i);
+}
+#endif
+
+// Function that packs '0'/'1' characters into bytes using the widest version this processor supports
+inline size_t packBits(const char* text, size_t length, unsigned char* output) noexcept {
+#ifdef HUFFMAN_HAVE_X86_SIMD
+    static const bool useAvx2 = __builtin_cpu_supports("avx2");
+    if(useAvx2) {
+        return packBitsAvx2(text, length, output);
+    }
+#endif
+    return packBitsScalar(text, length, output);
+}
+
+// Function that unpacks bits into '0'/'1' characters using the widest version this processor supports
+inline void unpackBits(const unsigned char* packed, size_t bitCount, char* text) noexcept {
+#ifdef HUFFMAN_HAVE_X86_SIMD
+    static const bool useAvx2 = __builtin_cpu_supports("avx2");
+    if(useAvx2) {
+        unpackBitsAvx2(packed, bitCount, text);
+        return;
+    }
+#endif
+    unpackBitsScalar(packed, bitCount, text);
+}
+
+// Function that checks whether a file's contents start with the packed bit header
+inline bool isPackedBitFile(const std::string& contents) noexcept {
+    return contents.size() >= PACKED_BITS_HEADER_SIZE && memcmp(contents.data(), PACKED_BITS_MAGIC, 4) == 0;
+}
+
+// Function that turns an encoded message in '0'/'1' text form into a packed bit file, header included. On
+//      failure the result holds the offset of the first character that is not a bit.
+inline HuffmanResult packBitString(const std::string& bitString, std::string& packedFile) {
+    uint64_t bitCount = bitString.size();
+
+    packedFile.assign(PACKED_BITS_HEADER_SIZE + (bitCount + 7) / 8, '\0');
+    memcpy(&packedFile[0], PACKED_BITS_MAGIC, 4);
+    for(int i = 0; i < 8; i++) {
+        packedFile[4 + i] = char((bitCount >> (8 * i)) & 0xff);
+    }
+
+    size_t invalid = packBits(bitString.data(), bitString.size(), (unsigned char*)&packedFile[PACKED_BITS_HEADER_SIZE]);
+    if(invalid != bitString.size()) {
+        packedFile.clear();
+        return huffmanFailure(HUFFMAN_INVALID_BIT, invalid);
+    }
+
+    return huffmanSuccess();
+}
+
+// Function that turns a packed bit file back into the '0'/'1' text form. A file that is too short for the
+//      bit count in its header is reported as truncated.
+inline HuffmanResult unpackBitString(const std::string& packedFile, std::string& bitString) {
+    if(!isPackedBitFile(packedFile)) {
+        return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, packedFile.size());
+    }
+
+    uint64_t bitCount = 0;
+    for(int i = 0; i < 8; i++) {
+        bitCount |= uint64_t((unsigned char)packedFile[4 + i]) << (8 * i);
+    }
+
+    uint64_t payloadSize = packedFile.size() - PACKED_BITS_HEADER_SIZE;
+    if(bitCount > payloadSize * 8) {
+        return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, packedFile.size());
+    }
+
+    bitString.resize(bitCount);
+    unpackBits((const unsigned char*)packedFile.data() + PACKED_BITS_HEADER_SIZE, bitCount, &bitString[0]);
+    return huffmanSuccess();
+}
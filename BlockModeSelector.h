@@ -0,0 +1,136 @@
+/*
+    Purpose: Pick the mode a block should be coded with, without coding it. A few windows spread evenly
+        over the block are sampled. The counts over all windows give the block's entropy, which is about
+        what the static coder will spend per character. The adaptive tree instead codes each part of the
+        block with the counts of everything before it, so we charge each window what it costs under the
+        counts of the windows before it. When the statistics drift, that cost moves away from the entropy,
+        in either direction. Both estimates are weighed against storing the block raw.
+*/
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "HuffmanContainer.h"
+#include "StaticHuffmanCoder.h"
+using namespace std;
+
+// Creating the size and the most number of the windows we sample
+const size_t SAMPLE_WINDOW_SIZE = 4096;
+const size_t SAMPLE_WINDOW_COUNT = 16;
+
+// Creating the bits the adaptive tree spends on the first sight of a character, and the extra bits per character
+//      we charge it over the entropy, which keeps us on the faster static coder when the two are close
+const double ADAPTIVE_LITERAL_BITS = 8.0;
+const double ADAPTIVE_EXTRA_BITS = 0.05;
+
+// Creating what the sampling found out about a block
+struct BlockEstimate {
+    // The entropy of all the windows together, and the average cost of a window under the counts of the windows
+    //      before it, in bits per character
+    double entropy;
+    double drift;
+
+    // The number of different characters seen
+    int distinctCharacters;
+
+    // The estimated payload bits for each mode
+    double rawBits;
+    double staticBits;
+    double adaptiveBits;
+};
+
+// Function that returns the entropy of a histogram, in bits per character
+inline double histogramEntropy(const uint64_t* histogram, uint64_t total) {
+    double entropy = 0;
+    for(int b = 0; b < 256; b++) {
+        if(histogram[b] != 0) {
+            double probability = double(histogram[b]) / double(total);
+            entropy -= probability * log2(probability);
+        }
+    }
+    return entropy;
+}
+
+// Function that samples the block and estimates what each mode would spend on it
+inline BlockEstimate estimateBlock(string_view block, size_t alphabetSize) {
+    BlockEstimate estimate = {};
+    size_t length = block.size();
+    estimate.rawBits = double(length) * 8;
+
+    if(length == 0) {
+        return estimate;
+    }
+
+    // Spreading the windows evenly over the block. A block shorter than all the windows is split between them
+    size_t windowCount = min(SAMPLE_WINDOW_COUNT, max(size_t(1), length / SAMPLE_WINDOW_SIZE));
+    size_t windowSize = min(SAMPLE_WINDOW_SIZE, length / windowCount);
+    size_t stride = windowCount > 1 ? (length - windowSize) / (windowCount - 1) : 0;
+
+    // Counting each window on its own first, since the adaptive estimate needs them one at a time
+    vector<uint64_t> histograms(windowCount * 256, 0);
+    uint64_t totalHistogram[256] = {0};
+
+    for(size_t w = 0; w < windowCount; w++) {
+        const unsigned char* window = (const unsigned char*)block.data() + w * stride;
+        uint64_t* histogram = &histograms[w * 256];
+
+        for(size_t i = 0; i < windowSize; i++) {
+            histogram[window[i]]++;
+        }
+        for(int b = 0; b < 256; b++) {
+            totalHistogram[b] += histogram[b];
+        }
+    }
+
+    uint64_t sampled = uint64_t(windowSize) * windowCount;
+    estimate.entropy = histogramEntropy(totalHistogram, sampled);
+
+    for(int b = 0; b < 256; b++) {
+        estimate.distinctCharacters += totalHistogram[b] != 0;
+    }
+
+    // The first window is charged its own entropy. Every later one is charged under the counts of the windows
+    //      before it, with half a count for characters not seen yet so they get a long code rather than none
+    double adaptiveSampleBits = histogramEntropy(&histograms[0], windowSize) * windowSize;
+    uint64_t prefixHistogram[256] = {0};
+    uint64_t prefixTotal = 0;
+
+    for(size_t w = 1; w < windowCount; w++) {
+        for(int b = 0; b < 256; b++) {
+            prefixHistogram[b] += histograms[(w - 1) * 256 + b];
+        }
+        prefixTotal += windowSize;
+
+        double modelTotal = double(prefixTotal) + 0.5 * estimate.distinctCharacters;
+        for(int b = 0; b < 256; b++) {
+            uint64_t count = histograms[w * 256 + b];
+            if(count != 0) {
+                adaptiveSampleBits -= double(count) * log2((double(prefixHistogram[b]) + 0.5) / modelTotal);
+            }
+        }
+    }
+
+    estimate.drift = adaptiveSampleBits / double(sampled);
+
+    // The static coder pays the entropy plus its code length header. The adaptive tree pays the cost under the
+    //      earlier counts, plus a literal for every new character
+    estimate.staticBits = double(length) * estimate.entropy + double(STATIC_LENGTH_BITS) * alphabetSize;
+    estimate.adaptiveBits = double(length) * (estimate.drift + ADAPTIVE_EXTRA_BITS) +
+        estimate.distinctCharacters * (ADAPTIVE_LITERAL_BITS + log2(double(estimate.distinctCharacters) + 1));
+
+    return estimate;
+}
+
+// Function that picks the mode with the smallest estimate
+inline HuffmanBlockMode chooseBlockMode(string_view block, size_t alphabetSize) {
+    BlockEstimate estimate = estimateBlock(block, alphabetSize);
+
+    if(estimate.staticBits <= estimate.adaptiveBits && estimate.staticBits < estimate.rawBits) {
+        return BLOCK_MODE_STATIC;
+    }
+    if(estimate.adaptiveBits < estimate.rawBits) {
+        return BLOCK_MODE_ADAPTIVE;
+    }
+    return BLOCK_MODE_RAW;
+}
@@ -0,0 +1,306 @@
+/*
+    Purpose: Implement a Burrows-Wheeler coder for when ratio matters more than speed. Each message is
+        sorted into its Burrows-Wheeler transform (the character before every suffix, with the suffixes in
+        sorted order), which groups characters that come up in similar contexts next to each other. The
+        suffix order comes from SA-IS, so the sort is linear in the message length. Move-to-front then turns
+        those groups into runs of small ranks, and an AdaptiveHuffmanTree codes the ranks.
+
+        Most ranks come out as zero, and a Huffman code can't spend less than a bit on a symbol, so as in
+        bzip2 every run of zeros is written as its length in bijective base two, with the digits RUNA (one)
+        and RUNB (two), lowest digit first. The tree is built over a made-up alphabet (see syntheticAlphabet)
+        of RUNA, RUNB, and the ranks from one up, so it fits alphabets of up to BWT_MAX_ALPHABET_SIZE
+        characters.
+
+        The payload starts with the primary index (four bytes, little endian), the row of the sorted
+        rotations where the message itself ends up, which is all the decoder needs to undo the sort. The
+        coder keeps nothing between messages, so one coder can encode or decode several messages at once
+        on different threads.
+*/
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AdaptiveHuffmanTree.h"
+#include "HuffmanTransforms.h"
+#include "HuffmanContainer.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+#include "SuffixArray.h"
+using namespace std;
+
+// Creating the number of bytes the primary index takes at the front of the payload
+const size_t BWT_INDEX_BYTES = 4;
+
+// Creating the made-up symbols for the two digits of a zero run. The rank r (from one up) is the symbol r + 2
+const unsigned char BWT_RUN_A = 1;
+const unsigned char BWT_RUN_B = 2;
+
+// Creating the largest alphabet the tree has room for, with the two run digits taking the place of rank zero
+const int BWT_MAX_ALPHABET_SIZE = 254;
+
+// Function that appends the Burrows-Wheeler transform of a message that was checked against the alphabet to the
+//      output, and returns its primary index. The message is sorted with a sentinel after it that is smaller than
+//      every character; the sentinel's own place in the last column is the primary index, and it isn't written
+inline uint32_t burrowsWheelerTransform(string_view input, const TransformAlphabet& alphabet, string& output) {
+    int32_t length = (int32_t)input.size() + 1;
+    vector<int32_t> text(length);
+    vector<int32_t> suffixArray(length);
+
+    for(int32_t i = 0; i + 1 < length; i++) {
+        text[i] = alphabet.symbolIndex[(unsigned char)input[i]] + 1;
+    }
+    text[length - 1] = 0;
+
+    buildSuffixArray(text.data(), suffixArray.data(), length, (int32_t)alphabet.symbols.size() + 1);
+
+    uint32_t primaryIndex = 0;
+    output.reserve(output.size() + input.size());
+
+    for(int32_t i = 0; i < length; i++) {
+        if(suffixArray[i] == 0) {
+            primaryIndex = (uint32_t)i;
+        }
+        else {
+            output.push_back(input[suffixArray[i] - 1]);
+        }
+    }
+
+    return primaryIndex;
+}
+
+// Function that undoes burrowsWheelerTransform, appending the message to the output. Each row of the last column
+//      maps to the row that starts with the same character, which is the row of the rotation one step back, so
+//      following the map from the sentinel's row reads the message from its end to its start
+inline HuffmanResult inverseBurrowsWheeler(string_view input, uint32_t primaryIndex, const TransformAlphabet& alphabet, string& output) {
+    size_t length = input.size();
+
+    if(length == 0 ? primaryIndex != 0 : (primaryIndex == 0 || primaryIndex > length)) {
+        return huffmanFailure(HUFFMAN_INVALID_HEADER, 0);
+    }
+
+    // Counting each character, and from the counts the first row that starts with it, after the sentinel's row
+    uint32_t firstRow[256] = {0};
+    for(size_t i = 0; i < length; i++) {
+        int index = alphabet.symbolIndex[(unsigned char)input[i]];
+        if(index == -1) {
+            return huffmanFailure(HUFFMAN_INVALID_CHARACTER, i);
+        }
+        firstRow[index]++;
+    }
+
+    uint32_t row = 1;
+    for(size_t c = 0; c < alphabet.symbols.size(); c++) {
+        uint32_t count = firstRow[c];
+        firstRow[c] = row;
+        row += count;
+    }
+
+    // Building the map over the rows of the last column, where the sentinel sits at the primary index
+    vector<uint32_t> nextRow(length + 1);
+    nextRow[primaryIndex] = 0;
+
+    for(size_t i = 0; i < length; i++) {
+        size_t rowIndex = i < primaryIndex ? i : i + 1;
+        nextRow[rowIndex] = firstRow[alphabet.symbolIndex[(unsigned char)input[i]]]++;
+    }
+
+    size_t start = output.size();
+    output.resize(start + length);
+
+    uint32_t current = 0;
+    for(size_t k = length; k > 0; k--) {
+        output[start + k - 1] = input[current < primaryIndex ? current : current - 1];
+        current = nextRow[current];
+    }
+
+    return huffmanSuccess(length, uint64_t(length) * 8);
+}
+
+// Creating the Burrows-Wheeler coder class
+class BurrowsWheelerHuffmanCoder {
+private:
+    // Creating the parsed alphabet the stages work over, and a fresh tree that every message's tree is cloned from
+    TransformAlphabet transformAlphabet;
+    AdaptiveHuffmanTree freshTree;
+
+    // Function that appends a run of zero ranks as its length in bijective base two
+    static void appendZeroRun(size_t run, string& symbols) {
+        while(run > 0) {
+            if(run & 1) {
+                symbols.push_back(char(BWT_RUN_A));
+                run = (run - 1) / 2;
+            }
+            else {
+                symbols.push_back(char(BWT_RUN_B));
+                run = (run - 2) / 2;
+            }
+        }
+    }
+
+    // Function that replaces each character of the last column with its move-to-front rank, and each run of zero
+    //      ranks with its run digits, as the tree's symbols
+    void moveToFrontWithRuns(string_view lastColumn, string& symbols) const {
+        unsigned char order[256];
+        size_t symbolCount = this->transformAlphabet.symbols.size();
+        size_t run = 0;
+
+        for(size_t i = 0; i < symbolCount; i++) {
+            order[i] = (unsigned char)i;
+        }
+
+        for(size_t i = 0; i < lastColumn.size(); i++) {
+            unsigned char symbol = (unsigned char)this->transformAlphabet.symbolIndex[(unsigned char)lastColumn[i]];
+
+            if(order[0] == symbol) {
+                run++;
+                continue;
+            }
+
+            appendZeroRun(run, symbols);
+            run = 0;
+
+            unsigned char* found = (unsigned char*)memchr(order, symbol, symbolCount);
+            size_t rank = found - order;
+
+            memmove(order + 1, order, rank);
+            order[0] = symbol;
+            symbols.push_back(char(rank + 2));
+        }
+
+        appendZeroRun(run, symbols);
+    }
+
+    // Function that undoes moveToFrontWithRuns, appending the last column. It stops with an error past maxLength
+    //      characters, so a damaged payload can't make it grow without end
+    HuffmanResult undoMoveToFrontWithRuns(string_view symbols, size_t maxLength, string& lastColumn) const {
+        unsigned char order[256];
+        size_t symbolCount = this->transformAlphabet.symbols.size();
+        size_t run = 0;
+        size_t runWeight = 1;
+
+        for(size_t i = 0; i < symbolCount; i++) {
+            order[i] = (unsigned char)i;
+        }
+
+        for(size_t i = 0; i <= symbols.size(); i++) {
+            unsigned char symbol = i < symbols.size() ? (unsigned char)symbols[i] : 0;
+
+            if(symbol == BWT_RUN_A || symbol == BWT_RUN_B) {
+                run += runWeight * symbol;
+                runWeight *= 2;
+
+                if(run > maxLength) {
+                    return huffmanFailure(HUFFMAN_INVALID_HEADER, i);
+                }
+                continue;
+            }
+
+            // Writing out the run that just ended, then the character the rank stands for
+            if(run > 0) {
+                if(lastColumn.size() + run > maxLength) {
+                    return huffmanFailure(HUFFMAN_INVALID_HEADER, i);
+                }
+                lastColumn.append(run, this->transformAlphabet.symbols[order[0]]);
+                run = 0;
+            }
+            runWeight = 1;
+
+            if(i == symbols.size()) {
+                break;
+            }
+
+            size_t rank = symbol - 2;
+            if(rank >= symbolCount) {
+                return huffmanFailure(HUFFMAN_INVALID_CHARACTER, i);
+            }
+
+            unsigned char moved = order[rank];
+            memmove(order + 1, order, rank);
+            order[0] = moved;
+            lastColumn.push_back(this->transformAlphabet.symbols[moved]);
+        }
+
+        return huffmanSuccess(lastColumn.size(), uint64_t(lastColumn.size()) * 8);
+    }
+
+public:
+    // Constructor that takes the alphabet string, in the same form the AdaptiveHuffmanTree takes it, and the code
+    //      length limit for the tree
+    explicit BurrowsWheelerHuffmanCoder(const string& alphabet, int maxCodeLength = NO_CODE_LENGTH_LIMIT)
+        : transformAlphabet(alphabet), freshTree(syntheticAlphabet((int)transformAlphabet.symbols.size() + 1), maxCodeLength) {}
+
+    // Function that tells us whether the alphabet is small enough for the tree's made-up alphabet
+    bool supportsAlphabet() const noexcept {
+        return (int)this->transformAlphabet.symbols.size() <= BWT_MAX_ALPHABET_SIZE;
+    }
+
+    // Function that returns the code length limit of the tree
+    int getMaxCodeLength() const noexcept {
+        return this->freshTree.getMaxCodeLength();
+    }
+
+    // Function that encodes the message, appending the primary index and the packed bits onto the end of the
+    //      string. The result's bit count includes the primary index
+    HuffmanResult encode(string_view message, string& payload) const noexcept {
+        HuffmanResult validation = scanAlphabet(this->transformAlphabet.alphabetBitmap, message.data(), message.size(), nullptr);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+        if(!supportsAlphabet()) {
+            return huffmanFailure(HUFFMAN_INVALID_HEADER, 0);
+        }
+
+        string lastColumn;
+        uint32_t primaryIndex = burrowsWheelerTransform(message, this->transformAlphabet, lastColumn);
+
+        string ranks;
+        moveToFrontWithRuns(lastColumn, ranks);
+
+        appendLittleEndian(payload, primaryIndex, BWT_INDEX_BYTES);
+
+        AdaptiveHuffmanTree tree = this->freshTree.clone();
+        StringSink sink(payload);
+        HuffmanResult result = tree.encode(ranks, sink);
+
+        if(!result.ok()) {
+            return result;
+        }
+
+        return huffmanSuccess(BWT_INDEX_BYTES + result.bytesWritten, BWT_INDEX_BYTES * 8 + result.bitsWritten);
+    }
+
+    // Function that decodes a payload of bitCount bits, appending the characters onto the end of the string. Decoding
+    //      stops with an error once more than maxLength characters come out. Error offsets are in bits from the start
+    //      of the payload
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, size_t maxLength, string& message) const noexcept {
+        if(bitCount < BWT_INDEX_BYTES * 8) {
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, bitCount);
+        }
+
+        uint32_t primaryIndex = (uint32_t)readLittleEndian((const char*)input, BWT_INDEX_BYTES);
+
+        string ranks;
+        AdaptiveHuffmanTree tree = this->freshTree.clone();
+        StringSink sink(ranks);
+        HuffmanResult result = tree.decode(input + BWT_INDEX_BYTES, bitCount - BWT_INDEX_BYTES * 8, sink);
+
+        if(!result.ok()) {
+            return huffmanFailure(result.status, BWT_INDEX_BYTES * 8 + result.errorOffset);
+        }
+
+        string lastColumn;
+        result = undoMoveToFrontWithRuns(ranks, maxLength, lastColumn);
+
+        if(result.ok()) {
+            result = inverseBurrowsWheeler(lastColumn, primaryIndex, this->transformAlphabet, message);
+        }
+        if(!result.ok()) {
+            return huffmanFailure(result.status, 0);
+        }
+
+        return result;
+    }
+};
@@ -0,0 +1,195 @@
+/*
+    Purpose: Build length-limited canonical Huffman codes from symbol counts, for the coders that work
+        from a code table instead of walking a tree. Codes are capped at CANONICAL_MAX_CODE_LENGTH bits, so
+        every code fits one lookup in a table of 2^CANONICAL_MAX_CODE_LENGTH entries, and decoding a symbol
+        is a peek, a table read and a skip, with no branches on the bits themselves. A canonical code is
+        fully described by its code lengths, which is all a stored header needs to carry.
+*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <vector>
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the longest code we allow. 2^12 is comfortably more than the 255 symbols an alphabet can have
+const int CANONICAL_MAX_CODE_LENGTH = 12;
+const int CANONICAL_TABLE_SIZE = 1 << CANONICAL_MAX_CODE_LENGTH;
+const int CANONICAL_MAX_SYMBOLS = 256;
+
+// Creating the code table. Each decode table entry is the symbol shifted left by four, plus the code length;
+//      an entry of zero means no code starts with those bits
+struct CanonicalHuffmanCode {
+    int symbolCount;
+    uint8_t lengths[CANONICAL_MAX_SYMBOLS];
+    uint16_t codes[CANONICAL_MAX_SYMBOLS];
+    uint16_t decodeTable[CANONICAL_TABLE_SIZE];
+};
+
+// Function that works out Huffman code lengths for the symbols, capped at maxLength. Symbols with a count of
+//      zero get no code (length zero). Ties are broken by symbol number, so the encoder and decoder always
+//      arrive at the same lengths from the same counts
+inline void buildCodeLengths(const uint64_t* counts, int symbolCount, int maxLength, uint8_t* lengths) {
+    memset(lengths, 0, symbolCount);
+
+    // Creating the list of symbols that actually need a code
+    vector<int> used;
+    for(int i = 0; i < symbolCount; i++) {
+        if(counts[i] != 0) {
+            used.push_back(i);
+        }
+    }
+
+    if(used.empty()) {
+        return;
+    }
+
+    // A lone symbol still needs one bit, so the decoder knows a symbol is there
+    if(used.size() == 1) {
+        lengths[used[0]] = 1;
+        return;
+    }
+
+    // Building the Huffman tree with a priority queue of (count, node). Leaves are nodes 0 to symbolCount - 1,
+    //      and every merge creates the next node number after that
+    typedef pair<uint64_t, int> WeightedNode;
+    priority_queue<WeightedNode, vector<WeightedNode>, greater<WeightedNode>> queue;
+    vector<int> parent(2 * symbolCount, -1);
+
+    for(size_t i = 0; i < used.size(); i++) {
+        queue.push(WeightedNode(counts[used[i]], used[i]));
+    }
+
+    int nextNode = symbolCount;
+    while(queue.size() > 1) {
+        WeightedNode first = queue.top();
+        queue.pop();
+        WeightedNode second = queue.top();
+        queue.pop();
+
+        parent[first.second] = nextNode;
+        parent[second.second] = nextNode;
+        queue.push(WeightedNode(first.first + second.first, nextNode));
+        nextNode++;
+    }
+
+    // Each leaf's code length is its depth. Parents always have higher numbers than their children, so we can
+    //      work out every internal node's depth from the top down
+    vector<int> depth(nextNode, 0);
+    for(int node = nextNode - 2; node >= symbolCount; node--) {
+        depth[node] = depth[parent[node]] + 1;
+    }
+
+    int longest = 0;
+    for(size_t i = 0; i < used.size(); i++) {
+        int length = depth[parent[used[i]]] + 1;
+        lengths[used[i]] = (uint8_t)min(length, maxLength);
+        longest = max(longest, length);
+    }
+
+    if(longest <= maxLength) {
+        return;
+    }
+
+    // Clamping the long codes broke the Kraft inequality, so we lengthen codes until the lengths fit again,
+    //      starting with the rarest symbols, which cost the least to lengthen
+    sort(used.begin(), used.end(), [&](int a, int b) {
+        return counts[a] != counts[b] ? counts[a] < counts[b] : a < b;
+    });
+
+    uint64_t capacity = uint64_t(1) << maxLength;
+    uint64_t kraft = 0;
+    for(size_t i = 0; i < used.size(); i++) {
+        kraft += uint64_t(1) << (maxLength - lengths[used[i]]);
+    }
+
+    while(kraft > capacity) {
+        for(size_t i = 0; i < used.size() && kraft > capacity; i++) {
+            int symbol = used[i];
+            if(lengths[symbol] < maxLength) {
+                kraft -= uint64_t(1) << (maxLength - lengths[symbol] - 1);
+                lengths[symbol]++;
+            }
+        }
+    }
+}
+
+// Function that assigns canonical codes from the code lengths already in the table, and fills the decode table.
+//      Codes are handed out in order of length, and by symbol number within a length. Returns false if the
+//      lengths describe more codes than fit, which only happens with a corrupt stored header
+inline bool buildCanonicalCode(CanonicalHuffmanCode& code) {
+    int lengthCounts[CANONICAL_MAX_CODE_LENGTH + 1] = {0};
+    for(int i = 0; i < code.symbolCount; i++) {
+        if(code.lengths[i] > CANONICAL_MAX_CODE_LENGTH) {
+            return false;
+        }
+        lengthCounts[code.lengths[i]]++;
+    }
+    lengthCounts[0] = 0;
+
+    // Finding the first code of each length
+    uint32_t nextCode[CANONICAL_MAX_CODE_LENGTH + 2] = {0};
+    uint32_t codeValue = 0;
+    for(int length = 1; length <= CANONICAL_MAX_CODE_LENGTH; length++) {
+        codeValue = (codeValue + lengthCounts[length - 1]) << 1;
+        nextCode[length] = codeValue;
+        if(codeValue + lengthCounts[length] > (uint32_t(1) << length)) {
+            return false;
+        }
+    }
+
+    memset(code.decodeTable, 0, sizeof(code.decodeTable));
+
+    for(int i = 0; i < code.symbolCount; i++) {
+        int length = code.lengths[i];
+        if(length == 0) {
+            continue;
+        }
+
+        code.codes[i] = (uint16_t)nextCode[length]++;
+
+        // Every table entry whose top bits match the code decodes to this symbol
+        int shift = CANONICAL_MAX_CODE_LENGTH - length;
+        uint32_t first = uint32_t(code.codes[i]) << shift;
+        uint16_t entry = (uint16_t)((i << 4) | length);
+        for(uint32_t j = 0; j < (uint32_t(1) << shift); j++) {
+            code.decodeTable[first + j] = entry;
+        }
+    }
+
+    return true;
+}
+
+// Function that builds a complete code table from symbol counts
+inline void buildCanonicalCodeFromCounts(const uint64_t* counts, int symbolCount, CanonicalHuffmanCode& code) {
+    code.symbolCount = symbolCount;
+    buildCodeLengths(counts, symbolCount, CANONICAL_MAX_CODE_LENGTH, code.lengths);
+    buildCanonicalCode(code);
+}
+
+// Function that writes a symbol's code
+template<class BitWriter>
+inline void writeCanonicalSymbol(const CanonicalHuffmanCode& code, int symbol, BitWriter& writer) {
+    writer.putBits(code.codes[symbol], code.lengths[symbol]);
+}
+
+// Function that reads one symbol with a single table lookup. Returns HUFFMAN_TRUNCATED_MESSAGE when the code
+//      runs past the end of the bits, and HUFFMAN_INVALID_BIT when no code starts with the bits we see
+inline HuffmanStatus readCanonicalSymbol(const CanonicalHuffmanCode& code, PackedBitReader& reader, int& symbol) {
+    uint16_t entry = code.decodeTable[reader.peekBits(CANONICAL_MAX_CODE_LENGTH)];
+    int length = entry & 15;
+
+    if(length == 0) {
+        return HUFFMAN_INVALID_BIT;
+    }
+    if((uint64_t)length > reader.remaining()) {
+        return HUFFMAN_TRUNCATED_MESSAGE;
+    }
+
+    reader.skipBits(length);
+    symbol = entry >> 4;
+    return HUFFMAN_SUCCESS;
+}
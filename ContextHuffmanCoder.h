@@ -0,0 +1,198 @@
+/*
+    Purpose: Implement an order-1 context coder. Every character is coded with an AdaptiveHuffmanTree of its
+        own for the character before it, so each tree only has to learn what tends to follow one character,
+        which on text and logs is far more predictable than the message as a whole. A context's tree is
+        only made the first time the context comes up, and the trees live one after another in an arena,
+        so memory grows with the contexts the message actually has.
+
+        A character a context's tree has not seen yet is coded as an escape (the tree's zero node code),
+        followed by the character coded with a shared order-0 tree. The very first character of a message
+        has no context and goes straight to the order-0 tree.
+*/
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AdaptiveHuffmanTree.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the context coder class
+class ContextHuffmanCoder {
+private:
+    // Creating the shared order-0 tree, and a fresh tree that new context trees are cloned from
+    AdaptiveHuffmanTree orderZeroTree;
+    AdaptiveHuffmanTree freshTree;
+
+    // Creating the arena of context trees, and how many of them are in use. Trees past contextsUsed are left over
+    //      from an earlier message, already reset, and are handed out again before any new tree is made
+    vector<AdaptiveHuffmanTree> contextTrees;
+    size_t contextsUsed;
+
+    // Creating the lookup from a previous character to its tree in the arena, -1 for contexts not seen yet
+    int contextSlot[256];
+
+    // Function that returns the tree for the context, making it if this is the context's first time
+    AdaptiveHuffmanTree& contextTree(unsigned char previous) {
+        if(this->contextSlot[previous] == -1) {
+            if(this->contextsUsed == this->contextTrees.size()) {
+                this->contextTrees.push_back(this->freshTree.clone());
+            }
+            this->contextSlot[previous] = (int)this->contextsUsed++;
+        }
+        return this->contextTrees[this->contextSlot[previous]];
+    }
+
+    // Function that encodes one character after the given previous character
+    template<class BitWriter>
+    void encodeCharacter(unsigned char previous, unsigned char character, BitWriter& writer) {
+        if(!contextTree(previous).encodeSymbolOrEscape(character, writer)) {
+            this->orderZeroTree.encodeSymbol(character, writer);
+        }
+    }
+
+    // Function that decodes one character after the given previous character
+    template<class BitReader>
+    HuffmanStatus decodeCharacter(unsigned char previous, BitReader& reader, char& character) {
+        AdaptiveHuffmanTree& tree = contextTree(previous);
+        bool escaped = false;
+
+        HuffmanStatus status = tree.decodeSymbolOrEscape(reader, character, escaped);
+        if(status != HUFFMAN_SUCCESS || !escaped) {
+            return status;
+        }
+
+        status = this->orderZeroTree.decodeSymbol(reader, character);
+        if(status == HUFFMAN_SUCCESS) {
+            tree.addEscapedSymbol((unsigned char)character);
+        }
+        return status;
+    }
+
+    // Function that encodes a whole message through the bit writer
+    HuffmanResult encodeMessage(string_view message, PackedBitWriter& writer) noexcept {
+        HuffmanResult validation = this->orderZeroTree.validateMessage(message);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+
+        for(size_t i = 0; i < message.size(); i++) {
+            if(i == 0) {
+                this->orderZeroTree.encodeSymbol((unsigned char)message[0], writer);
+            }
+            else {
+                encodeCharacter((unsigned char)message[i - 1], (unsigned char)message[i], writer);
+            }
+
+            if(writer.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, i);
+            }
+        }
+
+        if(!writer.finish()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, message.size());
+        }
+
+        return huffmanSuccess(writer.bytesWritten(), writer.bitsWritten());
+    }
+
+    // Function that decodes bitCount bits into the byte writer
+    HuffmanResult decodeMessage(const unsigned char* input, uint64_t bitCount, ByteWriter& output) noexcept {
+        PackedBitReader reader(input, bitCount);
+        bool first = true;
+        char previous = 0;
+
+        while(!reader.atEnd()) {
+            uint64_t symbolOffset = reader.getPosition();
+            char character = 0;
+            HuffmanStatus status;
+
+            if(first) {
+                status = this->orderZeroTree.decodeSymbol(reader, character);
+                first = false;
+            }
+            else {
+                status = decodeCharacter((unsigned char)previous, reader, character);
+            }
+
+            if(status != HUFFMAN_SUCCESS) {
+                return huffmanFailure(status, status == HUFFMAN_TRUNCATED_MESSAGE ? reader.getPosition() : symbolOffset);
+            }
+
+            output.put(character);
+            if(output.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, symbolOffset);
+            }
+
+            previous = character;
+        }
+
+        if(!output.flush()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, bitCount);
+        }
+
+        return huffmanSuccess(output.bytesWritten(), uint64_t(output.bytesWritten()) * 8);
+    }
+
+public:
+    // Constructor that takes the alphabet string, in the same form the AdaptiveHuffmanTree takes it, and the code
+    //      length limit for every tree
+    explicit ContextHuffmanCoder(const string& alphabet, int maxCodeLength = NO_CODE_LENGTH_LIMIT)
+        : orderZeroTree(alphabet, maxCodeLength), freshTree(orderZeroTree.clone()), contextsUsed(0) {
+        for(int i = 0; i < 256; i++) {
+            this->contextSlot[i] = -1;
+        }
+    }
+
+    // Function that forgets every context, so the next message starts from nothing. The context trees are reset
+    //      and kept for reuse rather than freed
+    void reset() {
+        this->orderZeroTree.reset();
+
+        for(size_t i = 0; i < this->contextsUsed; i++) {
+            this->contextTrees[i].reset();
+        }
+        this->contextsUsed = 0;
+
+        for(int i = 0; i < 256; i++) {
+            this->contextSlot[i] = -1;
+        }
+    }
+
+    // Function that returns the number of contexts that have a tree
+    size_t getContextCount() const noexcept {
+        return this->contextsUsed;
+    }
+
+    // Function that returns the code length limit of the trees
+    int getMaxCodeLength() const noexcept {
+        return this->orderZeroTree.getMaxCodeLength();
+    }
+
+    // Encode methods, writing packed bits into a caller's sink, or onto the end of a string
+    HuffmanResult encode(string_view message, HuffmanSink& sink) noexcept {
+        ByteWriter bytes(sink);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(message, writer);
+    }
+
+    HuffmanResult encode(string_view message, string& packed) noexcept {
+        ByteWriter bytes(packed);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(message, writer);
+    }
+
+    // Decode methods, reading bitCount packed bits and writing the characters into a caller's sink, or onto the end
+    //      of a string. Error offsets are in bits
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, HuffmanSink& sink) noexcept {
+        ByteWriter bytes(sink);
+        return decodeMessage(input, bitCount, bytes);
+    }
+
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, string& message) noexcept {
+        ByteWriter bytes(message);
+        return decodeMessage(input, bitCount, bytes);
+    }
+};
@@ -0,0 +1,190 @@
+/*
+    Purpose: Turn an alphabet string, as read from the alphabet file, into the list of characters it stands
+        for. A backslash followed by a letter is an escape sequence (\n for a newline, \t for a tab, and so on)
+        that stands for a single character. Every coder builds its symbols from this list, so they all agree
+        on what an alphabet means.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "AlphabetScanner.h"
+using namespace std;
+
+// Creating a const variable for the backslash and single quote ASCII value
+const int BACKSLASH_ASCII_VALUE = 92;
+const int SINGLE_QUOTE_ASCII_VALUE = 39;
+
+// Function that adds a character to the symbol list, unless it is already there. The NULL character can't be
+//      a symbol, since the tree uses it to mark nodes that don't hold a character
+inline void addAlphabetSymbol(string& symbols, char character) {
+    if(character != char(0) && symbols.find(character) == string::npos) {
+        symbols.push_back(character);
+    }
+}
+
+// Function that returns the character an escape sequence stands for, given the character after the backslash.
+//      An escape this doesn't know stands for the backslash itself. It is constexpr so alphabets compiled ahead
+//      of time read escapes exactly the way parseAlphabet does
+constexpr char alphabetEscape(char next) {
+    // Switch statement that will look at the character after the backslash, and depending on its ascii
+    //      value, return a non-printable character
+    switch(int(next)) {
+        // Our case for the Alert escape sequence
+        case int('a'):
+            return '\a';
+
+        // Case to handle the Backspace
+        case int('b'):
+            return '\b';
+
+        // Case to handle the Form Feed (new page)
+        case int('\f'):
+            return '\f';
+
+        // Case to handle the Vertical Tab
+        case int('v'):
+            return '\v';
+
+        // Case to handle the New-line
+        case int('n'):
+            return '\n';
+
+        // Case to handle the Horizontal Tab
+        case int('t'):
+            return '\t';
+
+        // Case to handle the Carriage Return
+        case int('r'):
+            return '\r';
+
+        // Case to handle the Backslash
+        case int('\\'):
+            return '\\';
+
+        // Case to handle the Single Quotation Mark. Note with this, we are just using
+        //      the ascii value itself
+        case SINGLE_QUOTE_ASCII_VALUE:
+            return '\'';
+
+        // Case to handle the Double Quotation Mark
+        case int('"'):
+            return '\"';
+
+        // Case to handle the Question Mark
+        case int('?'):
+            return '\?';
+    }
+
+    return '\\';
+}
+
+// Function that parses an alphabet string into its distinct characters, in the order they first appear
+inline string parseAlphabet(const string& alphabet) {
+    // Creating the list of characters we will return
+    string symbols;
+
+    // Casting the alphabet into a c-string, so we stop at the first NULL character the same way the file reading does
+    const char* alphabetCString = alphabet.c_str();
+    size_t alphabetLength = strlen(alphabetCString);
+
+    // Now, we will run through the entire alphabet with a for loop based on the length of the string
+    for(size_t i = 0; i < alphabetLength; i++) {
+        // With this if statement, we are checking to see if the current character we are reading in
+        //      is a single backslash. If it is, we know that the following chracter will have to be attached
+        //      to and it will create a single character with the escape sequence, not a backslash and a character
+        if(int(alphabetCString[i]) == BACKSLASH_ASCII_VALUE) {
+            addAlphabetSymbol(symbols, alphabetEscape(alphabetCString[i + 1]));
+
+            // Incrementing the i value, since we already read the next character and need
+            //      to jump to the one after it in the sequence
+            i++;
+        }
+
+        // Else, the character is normal, so we place it into the symbol list
+        else {
+            addAlphabetSymbol(symbols, alphabetCString[i]);
+        }
+    }
+
+    return symbols;
+}
+
+// Function that fills a 256 element lookup table from byte value to the character's position in the symbol
+//      list, with -1 for characters that are not in it, along with the alphabet's membership set
+inline void buildSymbolIndex(const string& symbols, int* symbolIndex, AlphabetBitmap& bitmap) {
+    memset(&bitmap, 0, sizeof(bitmap));
+
+    for(int i = 0; i < 256; i++) {
+        symbolIndex[i] = -1;
+    }
+
+    for(size_t i = 0; i < symbols.size(); i++) {
+        symbolIndex[(unsigned char)symbols[i]] = (int)i;
+        bitmap.add((unsigned char)symbols[i]);
+    }
+}
+
+// Function that makes an alphabet string for count made-up symbols, for coders whose trees code something other
+//      than the message's own characters. Symbol k is the byte k + 1, so count can be at most 255. The backslash
+//      is written as an escape, so parseAlphabet reads it back as itself
+inline string syntheticAlphabet(int count) {
+    string alphabet;
+
+    for(int k = 0; k < count && k < 255; k++) {
+        char symbol = char(k + 1);
+        if(symbol == '\\') {
+            alphabet.push_back('\\');
+        }
+        alphabet.push_back(symbol);
+    }
+
+    return alphabet;
+}
+
+// Creating an alphabet compiled ahead of time: its characters in order, the lookup from every byte value to the
+//      character's place (-1 when it isn't in the alphabet), and its membership set. This is everything a byte
+//      tree needs from its alphabet, so a tree built on one reads it in place instead of parsing anything
+struct CompiledAlphabet {
+    uint8_t symbols[256];
+    int32_t symbolIndex[256];
+    AlphabetBitmap bitmap;
+    int size;
+};
+
+// Function that compiles an alphabet string literal, reading it the same way parseAlphabet and buildSymbolIndex do.
+//      Declared constexpr, the whole thing is done by the compiler:
+//          constexpr CompiledAlphabet LOG_ALPHABET = compileAlphabet("abcdefghijklmnopqrstuvwxyz \\n\\t");
+template<size_t N>
+constexpr CompiledAlphabet compileAlphabet(const char (&alphabet)[N]) {
+    CompiledAlphabet compiled = {};
+
+    for(int i = 0; i < 256; i++) {
+        compiled.symbolIndex[i] = -1;
+    }
+
+    // Stopping at the first NULL character, which is the end of the literal unless it holds one of its own
+    size_t length = 0;
+    while(length < N && alphabet[length] != char(0)) {
+        length++;
+    }
+
+    for(size_t i = 0; i < length; i++) {
+        char character = alphabet[i];
+
+        if(int(character) == BACKSLASH_ASCII_VALUE) {
+            character = alphabetEscape(alphabet[i + 1]);
+            i++;
+        }
+
+        unsigned char byte = (unsigned char)character;
+        if(byte != 0 && compiled.symbolIndex[byte] == -1) {
+            compiled.symbolIndex[byte] = compiled.size;
+            compiled.symbols[compiled.size++] = byte;
+            compiled.bitmap.add(byte);
+        }
+    }
+
+    return compiled;
+}
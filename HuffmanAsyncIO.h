@@ -0,0 +1,810 @@
+/*
+    Purpose: Keep many file reads and writes in flight at once, so the coders aren't left idle while one
+        blocking read or write at a time goes out to the disk. On Linux the reads and writes go through an
+        io_uring, set up with the raw system calls so no library is needed. Buffers the caller registers are
+        pinned by the kernel once, instead of on every read or write. Where io_uring isn't built in, or the
+        kernel won't set one up, the same calls run as pread and pwrite on a few threads of our own. Either way
+        one thread submits and waits, and any thread may wake it, so a thread waiting on the disk can also hear
+        about coders that have finished.
+
+        AsyncInputBuffer and AsyncOutputBuffer put this behind a streambuf, for the streaming commands. The
+        input reads ahead several buffers at a time, and the output writes behind several buffers at a time.
+        Both read and write regular files at offsets, so pipes and terminals go through PipeInputBuffer and
+        PipeOutputBuffer instead, which read and write one buffer at a time where the descriptor already is.
+*/
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "HuffmanThreadPool.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define HUFFMAN_HAVE_IO_URING 1
+#endif
+#endif
+using namespace std;
+
+// Creating the default number of reads and writes in flight, the number of threads the fallback runs them on, and
+//      the size and number of the buffers each streaming buffer reads ahead or writes behind with
+const unsigned DEFAULT_IO_QUEUE_DEPTH = 64;
+const size_t DEFAULT_IO_THREADS = 4;
+const size_t DEFAULT_IO_BUFFER_SIZE = size_t(1) << 20;
+const size_t DEFAULT_IO_BUFFER_COUNT = 4;
+
+// Creating the most bytes one read or write asks the kernel for. Longer ones are split, and finish as one
+const size_t MAX_IO_LENGTH = size_t(1) << 30;
+
+// Creating the ways reads and writes can be run
+enum HuffmanIOBackend {
+    // io_uring when it is built in and the kernel sets one up, and threads otherwise
+    IO_BACKEND_AUTO,
+
+    // pread and pwrite on threads of our own
+    IO_BACKEND_THREADS
+};
+
+// Creating what wait() gives back: the tag of a read or write that has finished, with the number of bytes it moved
+//      or a negative errno, or a wake from another thread
+struct IOCompletion {
+    uint64_t tag;
+    int64_t result;
+    bool woken;
+};
+
+// Creating the asynchronous I/O class. Only one thread may submit and wait, and any thread may call wake()
+class HuffmanAsyncIO {
+private:
+    // Creating one read or write in flight. The slot it sits in is what the kernel or the thread hands back
+    struct Operation {
+        int fd;
+        uint64_t offset;
+        char* data;
+        size_t length;
+        size_t done;
+        uint64_t tag;
+        bool write;
+        int fixedBuffer;
+    };
+
+    vector<Operation> operations;
+    vector<size_t> freeSlots;
+    unsigned queueDepth;
+
+    // Creating the fallback's threads, and the queue of finished slots they hand back with its lock and signal.
+    //      A wake is a flag in the same place
+    unique_ptr<HuffmanThreadPool> ioThreads;
+    mutex completionMutex;
+    condition_variable completionSignal;
+    deque<pair<size_t, int64_t>> finished;
+    bool wakeRequested;
+
+#ifdef HUFFMAN_HAVE_IO_URING
+    // Creating the user data of the read we keep on the eventfd, which wake() writes to
+    static constexpr uint64_t WAKE_SLOT = UINT64_MAX;
+
+    // Creating the ring, its eventfd, and the shared memory of its submission and completion queues
+    int ringFd;
+    int wakeFd;
+    uint64_t wakeValue;
+    void* submissionRing;
+    size_t submissionRingSize;
+    void* completionRing;
+    size_t completionRingSize;
+    io_uring_sqe* submissionEntries;
+    size_t submissionEntriesSize;
+    unsigned* submissionTail;
+    unsigned* submissionMask;
+    unsigned* submissionArray;
+    unsigned* completionHead;
+    unsigned* completionTail;
+    unsigned* completionMask;
+    io_uring_cqe* completionEntries;
+    unsigned unsubmitted;
+
+    // Function that sets up the ring, returning false (with nothing left open) if the kernel won't
+    bool setUpRing() {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+
+        // One more entry than our depth, for the read on the eventfd
+        int fd = int(syscall(__NR_io_uring_setup, this->queueDepth + 1, &params));
+        if(fd < 0) {
+            return false;
+        }
+
+        size_t submissionSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        size_t completionSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(singleMap) {
+            submissionSize = completionSize = max(submissionSize, completionSize);
+        }
+
+        void* submission = mmap(nullptr, submissionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        void* completion = singleMap ? submission
+                                     : mmap(nullptr, completionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        size_t entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* entries = mmap(nullptr, entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        int eventFd = eventfd(0, EFD_CLOEXEC);
+
+        if(submission == MAP_FAILED || completion == MAP_FAILED || entries == MAP_FAILED || eventFd < 0) {
+            if(entries != MAP_FAILED) {
+                munmap(entries, entriesSize);
+            }
+            if(completion != MAP_FAILED && !singleMap) {
+                munmap(completion, completionSize);
+            }
+            if(submission != MAP_FAILED) {
+                munmap(submission, submissionSize);
+            }
+            if(eventFd >= 0) {
+                close(eventFd);
+            }
+            close(fd);
+            return false;
+        }
+
+        char* submissionBytes = (char*)submission;
+        char* completionBytes = (char*)completion;
+        this->ringFd = fd;
+        this->wakeFd = eventFd;
+        this->submissionRing = submission;
+        this->submissionRingSize = submissionSize;
+        this->completionRing = singleMap ? nullptr : completion;
+        this->completionRingSize = completionSize;
+        this->submissionEntries = (io_uring_sqe*)entries;
+        this->submissionEntriesSize = entriesSize;
+        this->submissionTail = (unsigned*)(submissionBytes + params.sq_off.tail);
+        this->submissionMask = (unsigned*)(submissionBytes + params.sq_off.ring_mask);
+        this->submissionArray = (unsigned*)(submissionBytes + params.sq_off.array);
+        this->completionHead = (unsigned*)(completionBytes + params.cq_off.head);
+        this->completionTail = (unsigned*)(completionBytes + params.cq_off.tail);
+        this->completionMask = (unsigned*)(completionBytes + params.cq_off.ring_mask);
+        this->completionEntries = (io_uring_cqe*)(completionBytes + params.cq_off.cqes);
+
+        armWake();
+        return true;
+    }
+
+    // Function that puts an entry on the submission queue. It goes to the kernel the next time we flush or wait
+    void queueEntry(uint8_t opcode, int fd, uint64_t offset, const void* data, size_t length, int fixedBuffer, uint64_t userData) {
+        unsigned tail = *this->submissionTail;
+        unsigned index = tail & *this->submissionMask;
+        io_uring_sqe* entry = &this->submissionEntries[index];
+
+        memset(entry, 0, sizeof(*entry));
+        entry->opcode = opcode;
+        entry->fd = fd;
+        entry->off = offset;
+        entry->addr = (uint64_t)(uintptr_t)data;
+        entry->len = (uint32_t)length;
+        entry->buf_index = (uint16_t)(fixedBuffer < 0 ? 0 : fixedBuffer);
+        entry->user_data = userData;
+
+        this->submissionArray[index] = index;
+        __atomic_store_n(this->submissionTail, tail + 1, __ATOMIC_RELEASE);
+        this->unsubmitted++;
+    }
+
+    // Function that queues the read on the eventfd that a wake finishes
+    void armWake() {
+        queueEntry(IORING_OP_READ, this->wakeFd, 0, &this->wakeValue, sizeof(this->wakeValue), -1, WAKE_SLOT);
+    }
+
+    // Function that submits what is queued and, if asked, waits for at least one completion
+    void enterRing(unsigned minimumComplete) {
+        while(true) {
+            int submitted = int(syscall(__NR_io_uring_enter, this->ringFd, this->unsubmitted, minimumComplete,
+                                        minimumComplete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+            if(submitted >= 0) {
+                this->unsubmitted -= unsigned(submitted);
+                return;
+            }
+            if(errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                return;
+            }
+        }
+    }
+#endif
+
+    // Function that sends a slot's operation on its way, or the rest of it after a short read or write
+    void startOperation(size_t slot) {
+        Operation& operation = this->operations[slot];
+        size_t length = min(operation.length - operation.done, MAX_IO_LENGTH);
+
+#ifdef HUFFMAN_HAVE_IO_URING
+        if(this->ringFd >= 0) {
+            uint8_t opcode = operation.fixedBuffer >= 0 ? (operation.write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED)
+                                                        : (operation.write ? IORING_OP_WRITE : IORING_OP_READ);
+            queueEntry(opcode, operation.fd, operation.offset + operation.done, operation.data + operation.done, length, operation.fixedBuffer, slot);
+            return;
+        }
+#endif
+
+        // The fallback runs the whole operation on one of its threads, so it is never handed back part done
+        Operation copy = operation;
+        this->ioThreads->submit([this, slot, copy] {
+            size_t done = copy.done;
+            int64_t result = 0;
+
+            while(done < copy.length) {
+                size_t length = min(copy.length - done, MAX_IO_LENGTH);
+                ssize_t moved = copy.write ? pwrite(copy.fd, copy.data + done, length, off_t(copy.offset + done))
+                                           : pread(copy.fd, copy.data + done, length, off_t(copy.offset + done));
+                if(moved < 0 && errno == EINTR) {
+                    continue;
+                }
+                if(moved < 0) {
+                    result = -errno;
+                    break;
+                }
+                if(moved == 0) {
+                    break;
+                }
+                done += size_t(moved);
+            }
+
+            // Signalling under the lock, so the waiting thread can't take the completion and destroy us first
+            lock_guard<mutex> lock(this->completionMutex);
+            this->finished.emplace_back(slot, result < 0 ? result : int64_t(done - copy.done));
+            this->completionSignal.notify_one();
+        });
+    }
+
+    // Function that queues a read or write in a free slot
+    bool submit(int fd, uint64_t offset, char* data, size_t length, uint64_t tag, bool write, int fixedBuffer) {
+        if(this->freeSlots.empty()) {
+            return false;
+        }
+
+        size_t slot = this->freeSlots.back();
+        this->freeSlots.pop_back();
+        this->operations[slot] = Operation{fd, offset, data, length, 0, tag, write, fixedBuffer};
+        startOperation(slot);
+        return true;
+    }
+
+    // Function that takes what a slot's operation did this time round. It gives back true with the completion once
+    //      the operation is over, and false if the rest of it was sent off again
+    bool finishOperation(size_t slot, int64_t result, IOCompletion& completion) {
+        Operation& operation = this->operations[slot];
+
+        if(result == -EINTR || result == -EAGAIN) {
+            startOperation(slot);
+            return false;
+        }
+
+        if(result > 0) {
+            operation.done += size_t(result);
+
+            // A short read or write only goes round again if it moved something, so a read at the end of the
+            //      file finishes with what it has
+            if(operation.done < operation.length && this->ioThreads == nullptr) {
+                startOperation(slot);
+                return false;
+            }
+        }
+
+        completion = IOCompletion{operation.tag, result < 0 ? result : int64_t(operation.done), false};
+        this->freeSlots.push_back(slot);
+        return true;
+    }
+
+public:
+    // Constructor that sets up the backend, with room for the given number of reads and writes in flight
+    explicit HuffmanAsyncIO(HuffmanIOBackend backend = IO_BACKEND_AUTO, unsigned queueDepth = DEFAULT_IO_QUEUE_DEPTH)
+        : queueDepth(queueDepth == 0 ? 1 : queueDepth), wakeRequested(false) {
+        this->operations.resize(this->queueDepth);
+        for(size_t i = this->queueDepth; i > 0; i--) {
+            this->freeSlots.push_back(i - 1);
+        }
+
+#ifdef HUFFMAN_HAVE_IO_URING
+        this->ringFd = -1;
+        this->wakeFd = -1;
+        this->unsubmitted = 0;
+        if(backend == IO_BACKEND_AUTO && setUpRing()) {
+            return;
+        }
+#endif
+        this->ioThreads = make_unique<HuffmanThreadPool>(DEFAULT_IO_THREADS);
+    }
+
+    // The kernel and the threads point back at our slots, so we can be neither copied nor moved
+    HuffmanAsyncIO(const HuffmanAsyncIO&) = delete;
+    HuffmanAsyncIO& operator=(const HuffmanAsyncIO&) = delete;
+
+    // Destructor that waits for everything still in flight, since it reads into or writes from the caller's memory,
+    //      and then takes down the ring or the threads
+    ~HuffmanAsyncIO() {
+        while(inFlight() > 0) {
+            wait();
+        }
+
+#ifdef HUFFMAN_HAVE_IO_URING
+        if(this->ringFd >= 0) {
+            munmap(this->submissionEntries, this->submissionEntriesSize);
+            if(this->completionRing != nullptr) {
+                munmap(this->completionRing, this->completionRingSize);
+            }
+            munmap(this->submissionRing, this->submissionRingSize);
+            close(this->ringFd);
+            close(this->wakeFd);
+        }
+#endif
+    }
+
+    // Function that tells us whether the reads and writes go through an io_uring
+    bool usesRing() const noexcept {
+#ifdef HUFFMAN_HAVE_IO_URING
+        return this->ringFd >= 0;
+#else
+        return false;
+#endif
+    }
+
+    // Function that returns how many more reads and writes can be put in flight, and how many are
+    size_t freeCapacity() const noexcept {
+        return this->freeSlots.size();
+    }
+
+    size_t inFlight() const noexcept {
+        return this->queueDepth - this->freeSlots.size();
+    }
+
+    // Function that registers buffers with the kernel, so reads and writes that name one by its place in the list
+    //      don't have to pin its pages every time. Returns false if they couldn't be registered (the kernel caps how
+    //      much memory can be pinned), in which case nothing should name them. The fallback takes any buffers
+    bool registerBuffers(const vector<iovec>& buffers) {
+#ifdef HUFFMAN_HAVE_IO_URING
+        if(this->ringFd >= 0) {
+            return syscall(__NR_io_uring_register, this->ringFd, IORING_REGISTER_BUFFERS, buffers.data(), unsigned(buffers.size())) == 0;
+        }
+#endif
+        return true;
+    }
+
+    // Functions that queue a read into, or a write from, the caller's memory, which has to stay put until the tag
+    //      comes back from wait(). A fixed buffer is the place of a registered buffer the memory lies inside, or -1.
+    //      They return false, and queue nothing, when there is no free capacity
+    bool submitRead(int fd, uint64_t offset, char* data, size_t length, uint64_t tag, int fixedBuffer = -1) {
+        return submit(fd, offset, data, length, tag, false, fixedBuffer);
+    }
+
+    bool submitWrite(int fd, uint64_t offset, const char* data, size_t length, uint64_t tag, int fixedBuffer = -1) {
+        return submit(fd, offset, (char*)data, length, tag, true, fixedBuffer);
+    }
+
+    // Function that hands the reads and writes queued so far to the kernel without waiting for any of them. wait()
+    //      does this too, so it only matters to a caller with something else to do first
+    void flush() {
+#ifdef HUFFMAN_HAVE_IO_URING
+        if(this->ringFd >= 0 && this->unsubmitted > 0) {
+            enterRing(0);
+        }
+#endif
+    }
+
+    // Function that waits for the next read or write to finish, or for a wake from another thread. A read finishes
+    //      short only at the end of the file
+    IOCompletion wait() {
+        IOCompletion completion;
+
+#ifdef HUFFMAN_HAVE_IO_URING
+        if(this->ringFd >= 0) {
+            while(true) {
+                unsigned head = *this->completionHead;
+                unsigned tail = __atomic_load_n(this->completionTail, __ATOMIC_ACQUIRE);
+
+                if(head == tail) {
+                    enterRing(1);
+                    continue;
+                }
+
+                io_uring_cqe entry = this->completionEntries[head & *this->completionMask];
+                __atomic_store_n(this->completionHead, head + 1, __ATOMIC_RELEASE);
+
+                if(entry.user_data == WAKE_SLOT) {
+                    armWake();
+                    enterRing(0);
+                    return IOCompletion{0, 0, true};
+                }
+
+                bool over = finishOperation(size_t(entry.user_data), entry.res, completion);
+                if(this->unsubmitted > 0) {
+                    enterRing(0);
+                }
+                if(over) {
+                    return completion;
+                }
+            }
+        }
+#endif
+
+        while(true) {
+            pair<size_t, int64_t> next;
+            {
+                unique_lock<mutex> lock(this->completionMutex);
+                this->completionSignal.wait(lock, [this] { return !this->finished.empty() || this->wakeRequested; });
+
+                if(this->finished.empty()) {
+                    this->wakeRequested = false;
+                    return IOCompletion{0, 0, true};
+                }
+
+                next = this->finished.front();
+                this->finished.pop_front();
+            }
+
+            if(finishOperation(next.first, next.second, completion)) {
+                return completion;
+            }
+        }
+    }
+
+    // Function that makes the waiting thread's wait() come back, or its next one if it isn't waiting. Several wakes
+    //      before it looks may come back as one
+    void wake() {
+#ifdef HUFFMAN_HAVE_IO_URING
+        if(this->ringFd >= 0) {
+            uint64_t one = 1;
+            while(write(this->wakeFd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+            return;
+        }
+#endif
+        lock_guard<mutex> lock(this->completionMutex);
+        this->wakeRequested = true;
+        this->completionSignal.notify_one();
+    }
+};
+
+// Creating the streaming buffers' shared part: the buffers themselves, registered with the ring when they can be,
+//      and what each one is doing
+class AsyncFileBuffer {
+protected:
+    // The buffers come first, so they are still there while the destructor of the I/O waits out reads in flight
+    vector<unique_ptr<char[]>> buffers;
+    HuffmanAsyncIO io;
+    int fd;
+    size_t bufferSize;
+    bool registered;
+
+    // Constructor that makes the buffers and tries to register them
+    AsyncFileBuffer(int fd, HuffmanIOBackend backend, size_t bufferSize, size_t bufferCount)
+        : io(backend, unsigned(max<size_t>(bufferCount, 1))), fd(fd), bufferSize(max<size_t>(bufferSize, 1)) {
+        vector<iovec> vectors;
+
+        for(size_t i = 0; i < max<size_t>(bufferCount, 1); i++) {
+            this->buffers.push_back(make_unique<char[]>(this->bufferSize));
+            vectors.push_back(iovec{this->buffers.back().get(), this->bufferSize});
+        }
+
+        this->registered = this->io.registerBuffers(vectors);
+    }
+
+    // Function that returns the registered place of a buffer, or -1 if they aren't registered
+    int fixedBuffer(size_t index) const noexcept {
+        return this->registered ? int(index) : -1;
+    }
+};
+
+// Creating the read ahead buffer over a regular file, read from the start. Every buffer is kept reading the next
+//      piece of the file not yet asked for, and the stream is handed the buffers in order as they come in. A read
+//      that fails makes the stream bad
+class AsyncInputBuffer : public streambuf, private AsyncFileBuffer {
+private:
+    // Creating the next offset to read from, the buffer the stream gets next, how much each buffer got (or -1 while
+    //      it is still reading), and whether a read has come up short
+    uint64_t nextOffset;
+    size_t nextBuffer;
+    vector<int64_t> filled;
+    bool reachedEnd;
+
+    // Function that sends a buffer off for the next piece of the file
+    void startRead(size_t index) {
+        this->filled[index] = -1;
+        this->io.submitRead(this->fd, this->nextOffset, this->buffers[index].get(), this->bufferSize, index, fixedBuffer(index));
+        this->nextOffset += this->bufferSize;
+    }
+
+protected:
+    // Function that the stream calls once it has used up the buffer it had
+    int_type underflow() override {
+        if(gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        // Sending the buffer the stream just used up off for more, unless the file has already ended
+        if(eback() != nullptr) {
+            size_t used = (this->nextBuffer + this->buffers.size() - 1) % this->buffers.size();
+            this->filled[used] = 0;
+            if(!this->reachedEnd) {
+                startRead(used);
+                this->io.flush();
+            }
+            setg(nullptr, nullptr, nullptr);
+        }
+
+        while(this->filled[this->nextBuffer] == -1 && this->io.inFlight() > 0) {
+            IOCompletion completion = this->io.wait();
+            if(!completion.woken) {
+                this->filled[completion.tag] = completion.result;
+            }
+        }
+
+        int64_t got = this->filled[this->nextBuffer];
+        if(got < 0) {
+            // Throwing is how a streambuf makes its stream bad
+            throw ios_base::failure("Error When Reading");
+        }
+
+        if(size_t(got) < this->bufferSize) {
+            this->reachedEnd = true;
+        }
+        if(got == 0) {
+            return traits_type::eof();
+        }
+
+        char* start = this->buffers[this->nextBuffer].get();
+        setg(start, start, start + got);
+        this->nextBuffer = (this->nextBuffer + 1) % this->buffers.size();
+        return traits_type::to_int_type(*gptr());
+    }
+
+public:
+    // Constructor that takes the open file, and starts reading the first buffers of it
+    explicit AsyncInputBuffer(int fd, HuffmanIOBackend backend = IO_BACKEND_AUTO, size_t bufferSize = DEFAULT_IO_BUFFER_SIZE,
+                              size_t bufferCount = DEFAULT_IO_BUFFER_COUNT)
+        : AsyncFileBuffer(fd, backend, bufferSize, bufferCount), nextOffset(0), nextBuffer(0), reachedEnd(false) {
+        this->filled.assign(this->buffers.size(), 0);
+        for(size_t i = 0; i < this->buffers.size(); i++) {
+            startRead(i);
+        }
+        this->io.flush();
+    }
+
+    // Function that tells us whether reads go through an io_uring
+    bool usesRing() const noexcept {
+        return this->io.usesRing();
+    }
+};
+
+// Creating the write behind buffer over a file, written from the start. The stream fills one buffer while the
+//      others are being written, and only waits when all of them are. A write that fails makes the stream bad,
+//      at the latest when it is flushed
+class AsyncOutputBuffer : public streambuf, private AsyncFileBuffer {
+private:
+    // Creating the offset the next buffer is written at, the buffers free to fill, the one being filled, and
+    //      whether a write has failed
+    uint64_t nextOffset;
+    vector<size_t> freeBuffers;
+    size_t currentBuffer;
+    bool failed;
+
+    // Function that takes in a finished write, putting its buffer back on the free list
+    void collect(const IOCompletion& completion) {
+        if(completion.woken) {
+            return;
+        }
+        if(completion.result < 0) {
+            this->failed = true;
+        }
+        this->freeBuffers.push_back(size_t(completion.tag));
+    }
+
+    // Function that sends what is in the current buffer off to be written, and starts filling a free one,
+    //      waiting for one if it has to
+    bool writeCurrent() {
+        size_t length = size_t(pptr() - pbase());
+
+        if(length > 0) {
+            this->io.submitWrite(this->fd, this->nextOffset, pbase(), length, this->currentBuffer, fixedBuffer(this->currentBuffer));
+            this->io.flush();
+            this->nextOffset += length;
+
+            while(this->freeBuffers.empty()) {
+                collect(this->io.wait());
+            }
+
+            this->currentBuffer = this->freeBuffers.back();
+            this->freeBuffers.pop_back();
+        }
+
+        char* start = this->buffers[this->currentBuffer].get();
+        setp(start, start + this->bufferSize);
+        return !this->failed;
+    }
+
+protected:
+    // Function that the stream calls when the buffer it is filling is full
+    int_type overflow(int_type character) override {
+        if(!writeCurrent()) {
+            return traits_type::eof();
+        }
+
+        if(!traits_type::eq_int_type(character, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(character);
+            pbump(1);
+        }
+        return traits_type::not_eof(character);
+    }
+
+    // Function that the stream calls when it is flushed: write out what is left and wait for every write
+    int sync() override {
+        bool written = writeCurrent();
+
+        while(this->io.inFlight() > 0) {
+            collect(this->io.wait());
+        }
+        return written && !this->failed ? 0 : -1;
+    }
+
+public:
+    // Constructor that takes the open file
+    explicit AsyncOutputBuffer(int fd, HuffmanIOBackend backend = IO_BACKEND_AUTO, size_t bufferSize = DEFAULT_IO_BUFFER_SIZE,
+                               size_t bufferCount = DEFAULT_IO_BUFFER_COUNT)
+        : AsyncFileBuffer(fd, backend, bufferSize, bufferCount), nextOffset(0), currentBuffer(0), failed(false) {
+        for(size_t i = this->buffers.size() - 1; i > 0; i--) {
+            this->freeBuffers.push_back(i);
+        }
+
+        char* start = this->buffers[0].get();
+        setp(start, start + this->bufferSize);
+    }
+
+    // Destructor that writes out whatever the stream didn't flush
+    ~AsyncOutputBuffer() override {
+        sync();
+    }
+
+    // Function that tells us whether writes go through an io_uring
+    bool usesRing() const noexcept {
+        return this->io.usesRing();
+    }
+};
+
+// Creating the buffer for input that can't be read at an offset, such as a pipe or a terminal. It reads with plain
+//      blocking reads into one buffer, and a read that fails makes the stream bad
+class PipeInputBuffer : public streambuf {
+private:
+    int fd;
+    unique_ptr<char[]> buffer;
+    size_t bufferSize;
+
+    // Function that reads once into the buffer, after what the stream hasn't taken yet, returning how many bytes came
+    size_t readMore() {
+        while(true) {
+            ssize_t got = read(this->fd, egptr(), size_t(this->buffer.get() + this->bufferSize - egptr()));
+
+            if(got >= 0) {
+                setg(eback(), gptr(), egptr() + got);
+                return size_t(got);
+            }
+            if(errno != EINTR) {
+                throw ios_base::failure("Error When Reading");
+            }
+        }
+    }
+
+protected:
+    // Function that the stream calls once it has used up the buffer
+    int_type underflow() override {
+        if(gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        setg(this->buffer.get(), this->buffer.get(), this->buffer.get());
+        if(readMore() == 0) {
+            return traits_type::eof();
+        }
+        return traits_type::to_int_type(*gptr());
+    }
+
+public:
+    // Constructor that takes the open pipe, or any other descriptor read from where it is
+    explicit PipeInputBuffer(int fd, size_t bufferSize = DEFAULT_IO_BUFFER_SIZE)
+        : fd(fd), buffer(make_unique<char[]>(max<size_t>(bufferSize, 1))), bufferSize(max<size_t>(bufferSize, 1)) {
+        setg(this->buffer.get(), this->buffer.get(), this->buffer.get());
+    }
+
+    // Function that returns the first bytes of the input without taking them, reading until there are count of them
+    //      or the input ends. It is for before the stream has taken anything, and count has to fit in the buffer
+    string peek(size_t count) {
+        try {
+            while(size_t(egptr() - gptr()) < count && readMore() > 0) {}
+        }
+        catch(const ios_base::failure&) {
+            // The stream will meet the same error when it reads
+        }
+        return string(gptr(), min(count, size_t(egptr() - gptr())));
+    }
+};
+
+// Creating the buffer for output that can't be written at an offset, such as a pipe or a terminal. It writes with
+//      plain blocking writes each time the buffer fills, and a write that fails makes the stream bad
+class PipeOutputBuffer : public streambuf {
+private:
+    int fd;
+    unique_ptr<char[]> buffer;
+    size_t bufferSize;
+    bool failed;
+
+    // Function that writes all of the bytes, unless the pipe fails
+    bool writeAll(const char* data, size_t length) {
+        while(length > 0 && !this->failed) {
+            ssize_t written = write(this->fd, data, min(length, MAX_IO_LENGTH));
+
+            if(written < 0) {
+                this->failed = errno != EINTR;
+                continue;
+            }
+            data += written;
+            length -= size_t(written);
+        }
+        return !this->failed;
+    }
+
+    // Function that writes out the buffer and starts filling it again
+    bool writeBuffer() {
+        bool written = writeAll(pbase(), size_t(pptr() - pbase()));
+        setp(this->buffer.get(), this->buffer.get() + this->bufferSize);
+        return written;
+    }
+
+protected:
+    // Function that the stream calls when the buffer is full
+    int_type overflow(int_type character) override {
+        if(!writeBuffer()) {
+            return traits_type::eof();
+        }
+
+        if(!traits_type::eq_int_type(character, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(character);
+            pbump(1);
+        }
+        return traits_type::not_eof(character);
+    }
+
+    // Function that the stream calls to write many characters at once. Anything as big as the buffer is written
+    //      straight from the caller's memory
+    streamsize xsputn(const char* data, streamsize count) override {
+        if(size_t(count) < this->bufferSize) {
+            return streambuf::xsputn(data, count);
+        }
+        return writeBuffer() && writeAll(data, size_t(count)) ? count : 0;
+    }
+
+    // Function that the stream calls when it is flushed
+    int sync() override {
+        return writeBuffer() ? 0 : -1;
+    }
+
+public:
+    // Constructor that takes the open pipe, or any other descriptor written where it is
+    explicit PipeOutputBuffer(int fd, size_t bufferSize = DEFAULT_IO_BUFFER_SIZE)
+        : fd(fd), buffer(make_unique<char[]>(max<size_t>(bufferSize, 1))), bufferSize(max<size_t>(bufferSize, 1)), failed(false) {
+        setp(this->buffer.get(), this->buffer.get() + this->bufferSize);
+    }
+
+    // Destructor that writes out whatever the stream didn't flush
+    ~PipeOutputBuffer() override {
+        sync();
+    }
+};
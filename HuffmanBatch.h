@@ -0,0 +1,371 @@
+/*
+    Purpose: Code many messages in one run, for the batch commands. Building a compressor parses the
+        alphabet and builds every coder, so the batch coder builds one for each thread of the pool up front and
+        reuses them for every message. Each message is split into its blocks, and the blocks are coded on the
+        pool as tasks of their own. A batch of many small files then keeps every thread busy with whole files,
+        while the blocks of a huge one are stolen by the threads that run out of files. Every block is coded on
+        its own, so the containers are the same as the compressor writes one file at a time.
+
+        codeFiles does the reading and writing too, on the calling thread, through HuffmanAsyncIO, keeping many
+        files in flight while the pool codes others. Small files are read straight into buffers registered with
+        the kernel and coded from there, and a cap on the bytes held at once keeps a run of huge files from
+        being read faster than it can be coded.
+*/
+#pragma once
+#include <cerrno>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "HuffmanAsyncIO.h"
+#include "HuffmanCompressor.h"
+#include "HuffmanContainer.h"
+#include "HuffmanThreadPool.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the size of the registered buffers small files are read into, and the most bytes of larger files and
+//      of coded output the batch holds at once, past the first file
+const size_t BATCH_STAGING_SIZE = size_t(256) << 10;
+const size_t BATCH_MEMORY_LIMIT = size_t(256) << 20;
+
+// Creating what happened to one file of a batch: the coder's result, and the errno of the read or write that
+//      failed, or zero
+struct HuffmanFileResult {
+    HuffmanResult result;
+    int readError;
+    int writeError;
+};
+
+// Creating the batch coder class
+class HuffmanBatchCoder {
+private:
+    // Creating the pool the blocks are coded on, and a compressor for each of its threads, with one more for the
+    //      thread the batch is run from
+    HuffmanThreadPool& pool;
+    vector<unique_ptr<HuffmanCompressor>> compressors;
+
+    // Creating the mode and transforms messages are compressed with
+    HuffmanBlockMode mode;
+    uint8_t transforms;
+
+    // Function that returns the compressor that belongs to the thread we are running on
+    HuffmanCompressor& threadCompressor() {
+        return *this->compressors[this->pool.getCurrentThreadIndex()];
+    }
+
+public:
+    // Constructor that takes the pool, the alphabet string, the block size, the mode and transforms to compress with,
+    //      the level of the LZ77 match finder, the token dictionary, and the code length limit for the adaptive trees
+    HuffmanBatchCoder(HuffmanThreadPool& pool, const string& alphabet, size_t blockSize = DEFAULT_BLOCK_SIZE,
+                      HuffmanBlockMode mode = BLOCK_MODE_ADAPTIVE, uint8_t transforms = TRANSFORM_NONE,
+                      int level = DEFAULT_LZ77_LEVEL, const vector<string>& tokens = vector<string>(),
+                      int maxCodeLength = NO_CODE_LENGTH_LIMIT)
+        : pool(pool), mode(mode), transforms(transforms) {
+        for(size_t i = 0; i <= pool.getThreadCount(); i++) {
+            this->compressors.push_back(make_unique<HuffmanCompressor>(alphabet, blockSize, maxCodeLength, level));
+            this->compressors.back()->useTokenDictionary(tokens);
+        }
+    }
+
+    // Function that compresses the message into a container, appended onto the end of the string, with its blocks
+    //      coded in parallel. Safe to call from several tasks of the pool at once. Error offsets are in characters
+    //      of the message
+    HuffmanResult compress(string_view message, string& container) {
+        HuffmanCompressor& compressor = threadCompressor();
+        size_t startSize = container.size();
+        compressor.startContainer(container, this->transforms);
+
+        // Cutting the message where compressBlocks would, so the blocks come out the same
+        vector<size_t> blockStarts;
+        size_t blockStart = 0;
+
+        do {
+            blockStarts.push_back(blockStart);
+            blockStart = compressor.nextBlockEnd(message, blockStart, this->mode);
+        } while(blockStart < message.size());
+        blockStarts.push_back(message.size());
+
+        size_t blockCount = blockStarts.size() - 1;
+        vector<string> blocks(blockCount);
+        vector<HuffmanResult> results(blockCount);
+
+        this->pool.parallelFor(blockCount, [&](size_t i) {
+            string_view block = message.substr(blockStarts[i], blockStarts[i + 1] - blockStarts[i]);
+            results[i] = threadCompressor().compressBlocks(block, this->mode, blocks[i], this->transforms);
+        });
+
+        uint64_t totalBits = uint64_t(CONTAINER_HEADER_SIZE) * 8;
+
+        for(size_t i = 0; i < blockCount; i++) {
+            if(!results[i].ok()) {
+                container.resize(startSize);
+                return huffmanFailure(results[i].status, blockStarts[i] + results[i].errorOffset);
+            }
+
+            container.append(blocks[i]);
+            totalBits += results[i].bitsWritten;
+        }
+
+        return huffmanSuccess(container.size() - startSize, totalBits);
+    }
+
+    // Function that decompresses a container, appending the message onto the end of the string, with its blocks
+    //      decoded in parallel. Safe to call from several tasks of the pool at once. Error offsets are in bytes of
+    //      the container
+    HuffmanResult decompress(string_view container, string& message) {
+        uint8_t containerTransforms = TRANSFORM_NONE;
+        HuffmanResult result = threadCompressor().startDecompressing(container, containerTransforms);
+
+        if(!result.ok()) {
+            return result;
+        }
+
+        // Finding where every block starts and ends, so each one can be handed out on its own
+        vector<size_t> blockStarts;
+        size_t offset = CONTAINER_HEADER_SIZE;
+
+        while(offset < container.size()) {
+            BlockHeader blockHeader;
+            blockStarts.push_back(offset);
+            result = readBlockHeader(container, offset, blockHeader);
+
+            if(!result.ok()) {
+                return result;
+            }
+            offset += size_t(blockHeader.payloadBytes());
+        }
+        blockStarts.push_back(offset);
+
+        size_t blockCount = blockStarts.size() - 1;
+        vector<string> blockMessages(blockCount);
+        vector<HuffmanResult> results(blockCount);
+
+        // Every thread's compressor reads the container header first, for its code length limit
+        this->pool.parallelFor(blockCount, [&](size_t i) {
+            HuffmanCompressor& compressor = threadCompressor();
+            uint8_t blockTransforms = TRANSFORM_NONE;
+            results[i] = compressor.startDecompressing(container, blockTransforms);
+
+            if(results[i].ok()) {
+                string_view block = container.substr(blockStarts[i], blockStarts[i + 1] - blockStarts[i]);
+                results[i] = compressor.decompressBlocks(block, blockTransforms, blockMessages[i], blockStarts[i]);
+            }
+        });
+
+        size_t startSize = message.size();
+
+        for(size_t i = 0; i < blockCount; i++) {
+            if(!results[i].ok()) {
+                message.resize(startSize);
+                return results[i];
+            }
+            message.append(blockMessages[i]);
+        }
+
+        return huffmanSuccess(message.size() - startSize, uint64_t(message.size() - startSize) * 8);
+    }
+
+    // Function that compresses or decompresses every input file into the output file of the same place in the list,
+    //      reading and writing on this thread while the pool codes. A file that fails gets no output file, and the
+    //      others go on. This thread must not be one of the pool's
+    vector<HuffmanFileResult> codeFiles(bool compressing, const vector<string>& inputNames, const vector<string>& outputNames,
+                                        HuffmanIOBackend backend = IO_BACKEND_AUTO, unsigned queueDepth = DEFAULT_IO_QUEUE_DEPTH) {
+        // Creating what we know about each file on its way through: its descriptor, the input (in a staging buffer
+        //      or a string of its own), the output, and the bytes of both that count against the memory cap
+        struct FileState {
+            int fd = -1;
+            int stagingBuffer = -1;
+            bool writing = false;
+            string input;
+            string_view view;
+            string output;
+            size_t memory = 0;
+        };
+
+        size_t fileCount = inputNames.size();
+        vector<HuffmanFileResult> results(fileCount, HuffmanFileResult{huffmanSuccess(), 0, 0});
+        vector<FileState> files(fileCount);
+        HuffmanAsyncIO io(backend, queueDepth);
+
+        // Creating the staging buffers, one for each read we can have in flight
+        vector<unique_ptr<char[]>> staging;
+        vector<iovec> stagingVectors;
+        vector<int> freeStaging;
+
+        for(size_t i = 0; i < min<size_t>(queueDepth, fileCount); i++) {
+            staging.push_back(make_unique<char[]>(BATCH_STAGING_SIZE));
+            stagingVectors.push_back(iovec{staging.back().get(), BATCH_STAGING_SIZE});
+            freeStaging.push_back(int(i));
+        }
+        bool registered = io.registerBuffers(stagingVectors);
+
+        // Creating the files the coders are done with, which they hand back under the lock and wake us for
+        mutex codedMutex;
+        vector<size_t> coded;
+        deque<size_t> waitingToWrite;
+
+        size_t nextFile = 0;
+        size_t activeFiles = 0;
+        size_t memoryInUse = 0;
+
+        auto finishFile = [&](size_t i) {
+            FileState& file = files[i];
+            if(file.fd >= 0) {
+                close(file.fd);
+            }
+            memoryInUse -= file.memory;
+            activeFiles--;
+            file = FileState();
+        };
+
+        auto startCoding = [&](size_t i) {
+            close(files[i].fd);
+            files[i].fd = -1;
+
+            this->pool.submit([&, i] {
+                FileState& file = files[i];
+                results[i].result = compressing ? compress(file.view, file.output) : decompress(file.view, file.output);
+
+                // Waking the loop before letting go of the lock, so it can't see the last file done and tear down
+                //      the I/O while we are still waking it
+                lock_guard<mutex> lock(codedMutex);
+                coded.push_back(i);
+                io.wake();
+            });
+        };
+
+        while(true) {
+            // Taking back the files the coders are done with, and giving their staging buffers to the next reads
+            vector<size_t> done;
+            {
+                lock_guard<mutex> lock(codedMutex);
+                done.swap(coded);
+            }
+
+            for(size_t i : done) {
+                FileState& file = files[i];
+                if(file.stagingBuffer >= 0) {
+                    freeStaging.push_back(file.stagingBuffer);
+                }
+                file.stagingBuffer = -1;
+                file.view = string_view();
+                memoryInUse -= file.input.size();
+                file.memory -= file.input.size();
+                string().swap(file.input);
+
+                if(!results[i].result.ok()) {
+                    finishFile(i);
+                    continue;
+                }
+
+                file.memory += file.output.size();
+                memoryInUse += file.output.size();
+                waitingToWrite.push_back(i);
+            }
+
+            // Writing out coded files first, so their memory comes back as soon as it can
+            while(!waitingToWrite.empty() && io.freeCapacity() > 0) {
+                size_t i = waitingToWrite.front();
+                waitingToWrite.pop_front();
+                FileState& file = files[i];
+
+                file.fd = open(outputNames[i].c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if(file.fd < 0) {
+                    results[i].writeError = errno;
+                    finishFile(i);
+                    continue;
+                }
+
+                if(file.output.empty()) {
+                    finishFile(i);
+                    continue;
+                }
+
+                file.writing = true;
+                io.submitWrite(file.fd, 0, file.output.data(), file.output.size(), i);
+            }
+
+            // Opening more files and reading them while there is room, and memory to spare
+            while(nextFile < fileCount && io.freeCapacity() > 0 && (activeFiles == 0 || memoryInUse < BATCH_MEMORY_LIMIT)) {
+                size_t i = nextFile++;
+                FileState& file = files[i];
+                struct stat information;
+
+                file.fd = open(inputNames[i].c_str(), O_RDONLY | O_CLOEXEC);
+                if(file.fd < 0 || fstat(file.fd, &information) != 0) {
+                    results[i].readError = errno;
+                    if(file.fd >= 0) {
+                        close(file.fd);
+                    }
+                    file.fd = -1;
+                    continue;
+                }
+
+                activeFiles++;
+                size_t size = size_t(information.st_size);
+                char* data;
+
+                if(size <= BATCH_STAGING_SIZE && !freeStaging.empty()) {
+                    file.stagingBuffer = freeStaging.back();
+                    freeStaging.pop_back();
+                    data = staging[file.stagingBuffer].get();
+                }
+                else {
+                    file.input.resize(size);
+                    data = &file.input[0];
+                    file.memory = size;
+                    memoryInUse += size;
+                }
+
+                file.view = string_view(data, size);
+                if(size == 0) {
+                    startCoding(i);
+                    continue;
+                }
+
+                io.submitRead(file.fd, 0, data, size, i, registered ? file.stagingBuffer : -1);
+            }
+
+            if(activeFiles == 0 && nextFile == fileCount) {
+                break;
+            }
+
+            // Waiting for a read or write to finish, or for a coder to wake us
+            IOCompletion completion = io.wait();
+            if(completion.woken) {
+                continue;
+            }
+
+            size_t i = size_t(completion.tag);
+            FileState& file = files[i];
+
+            if(file.writing) {
+                if(completion.result != int64_t(file.output.size())) {
+                    results[i].writeError = completion.result < 0 ? int(-completion.result) : EIO;
+                    unlink(outputNames[i].c_str());
+                }
+                finishFile(i);
+            }
+            else if(completion.result < 0) {
+                results[i].readError = int(-completion.result);
+                if(file.stagingBuffer >= 0) {
+                    freeStaging.push_back(file.stagingBuffer);
+                }
+                finishFile(i);
+            }
+            else {
+                // A file that shrank since we looked at its size is coded as it is now
+                file.view = string_view(file.view.data(), size_t(completion.result));
+                startCoding(i);
+            }
+        }
+
+        return results;
+    }
+};
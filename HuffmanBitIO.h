@@ -0,0 +1,304 @@
+/*
+    Purpose: Provide the bit and byte writers and readers the coders work through. The encoders write
+        bits either as '0'/'1' characters (the original .encoded format) or packed eight to a byte,
+        first bit in the high bit. Packed bits and decoded characters go to a ByteWriter, which writes
+        straight into a caller's buffer, into a caller's sink, or onto the end of a string, so a caller
+        that already owns its buffers never pays for an extra copy.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Creating the number of bytes a ByteWriter gathers before handing them to a sink
+const size_t HUFFMAN_SINK_BUFFER_SIZE = 4096;
+
+// Creating the interface for a caller supplied destination of bytes. The write function returns false
+//      when the destination cannot take any more, which the coders report as HUFFMAN_OUTPUT_FULL
+class HuffmanSink {
+public:
+    virtual ~HuffmanSink() {}
+    virtual bool write(const char* data, size_t length) = 0;
+};
+
+// Creating a sink that appends to a string, mostly useful for testing the sink paths
+class StringSink : public HuffmanSink {
+private:
+    std::string& output;
+
+public:
+    explicit StringSink(std::string& output) : output(output) {}
+
+    bool write(const char* data, size_t length) override {
+        output.append(data, length);
+        return true;
+    }
+};
+
+// Creating the byte writer. It writes into exactly one of: a fixed caller buffer, a sink (through a
+//      small staging buffer), or the end of a string
+class ByteWriter {
+private:
+    char* buffer;
+    size_t capacity;
+    size_t position;
+    HuffmanSink* sink;
+    std::string* text;
+    size_t flushed;
+    bool full;
+    char staging[HUFFMAN_SINK_BUFFER_SIZE];
+
+public:
+    // Constructor for writing into a caller's buffer of the given capacity
+    ByteWriter(char* buffer, size_t capacity)
+        : buffer(buffer), capacity(capacity), position(0), sink(nullptr), text(nullptr), flushed(0), full(false) {}
+
+    // Constructor for writing into a caller's sink
+    explicit ByteWriter(HuffmanSink& sink)
+        : buffer(staging), capacity(HUFFMAN_SINK_BUFFER_SIZE), position(0), sink(&sink), text(nullptr), flushed(0), full(false) {}
+
+    // Constructor for appending onto a string
+    explicit ByteWriter(std::string& text)
+        : buffer(nullptr), capacity(0), position(0), sink(nullptr), text(&text), flushed(0), full(false) {}
+
+    // Function that writes one byte. Once the output is full every later byte is dropped
+    void put(char byte) {
+        if(text != nullptr) {
+            text->push_back(byte);
+            position++;
+            return;
+        }
+
+        if(position == capacity) {
+            if(sink == nullptr || !flush()) {
+                full = true;
+                return;
+            }
+        }
+
+        buffer[position++] = byte;
+    }
+
+    // Function that hands the staged bytes to the sink, returning false if it would not take them
+    bool flush() {
+        if(sink != nullptr && position != 0 && !full) {
+            if(!sink->write(staging, position)) {
+                full = true;
+                return false;
+            }
+            flushed += position;
+            position = 0;
+        }
+        return !full;
+    }
+
+    // Function that tells us whether a byte had to be dropped
+    bool failed() const {
+        return full;
+    }
+
+    // Function that returns how many bytes have been written so far, including ones still staged
+    size_t bytesWritten() const {
+        return flushed + position;
+    }
+};
+
+// Creating the writer for the original '0'/'1' text form, which appends one character per bit to a string
+class AsciiBitWriter {
+private:
+    std::string& output;
+    uint64_t bitCount;
+
+public:
+    explicit AsciiBitWriter(std::string& output) : output(output), bitCount(0) {}
+
+    // Function that writes the low count bits of value, highest bit first. Count is at most 57
+    void putBits(uint64_t value, int count) {
+        for(int i = count - 1; i >= 0; i--) {
+            output.push_back(char('0' + ((value >> i) & 1)));
+        }
+        bitCount += count;
+    }
+
+    bool failed() const {
+        return false;
+    }
+
+    bool finish() {
+        return true;
+    }
+
+    uint64_t bitsWritten() const {
+        return bitCount;
+    }
+
+    size_t bytesWritten() const {
+        return bitCount;
+    }
+};
+
+// Creating the writer for packed bits. Bits gather in a 64 bit register and leave it a byte at a time
+class PackedBitWriter {
+private:
+    ByteWriter& bytes;
+    uint64_t accumulator;
+    int pendingBits;
+    uint64_t bitCount;
+
+public:
+    explicit PackedBitWriter(ByteWriter& bytes) : bytes(bytes), accumulator(0), pendingBits(0), bitCount(0) {}
+
+    // Function that writes the low count bits of value, highest bit first. Count is at most 57
+    void putBits(uint64_t value, int count) {
+        accumulator = (accumulator << count) | (value & ((uint64_t(1) << count) - 1));
+        pendingBits += count;
+        bitCount += count;
+
+        while(pendingBits >= 8) {
+            pendingBits -= 8;
+            bytes.put(char((accumulator >> pendingBits) & 0xff));
+        }
+    }
+
+    // Function that pads the last partial byte with zero bits and flushes the byte writer
+    bool finish() {
+        if(pendingBits > 0) {
+            bytes.put(char((accumulator << (8 - pendingBits)) & 0xff));
+            pendingBits = 0;
+        }
+        return bytes.flush();
+    }
+
+    bool failed() const {
+        return bytes.failed();
+    }
+
+    uint64_t bitsWritten() const {
+        return bitCount;
+    }
+
+    size_t bytesWritten() const {
+        return bytes.bytesWritten();
+    }
+};
+
+// Creating the reader for the '0'/'1' text form. Its position is both the bit and the byte offset
+class AsciiBitReader {
+private:
+    const char* bits;
+    size_t length;
+    size_t position;
+
+public:
+    AsciiBitReader(const char* bits, size_t length) : bits(bits), length(length), position(0) {}
+
+    // Function that reads one bit, returning false at the end of the message
+    bool getBit(unsigned& bit) {
+        if(position == length) {
+            return false;
+        }
+        bit = (unsigned)(bits[position++] == '1');
+        return true;
+    }
+
+    // Function that reads count bits, highest bit first. Count is at most 32
+    bool getBits(int count, unsigned& value) {
+        if(length - position < (size_t)count) {
+            return false;
+        }
+        value = 0;
+        for(int i = 0; i < count; i++) {
+            value = (value << 1) | (unsigned)(bits[position++] == '1');
+        }
+        return true;
+    }
+
+    bool atEnd() const {
+        return position == length;
+    }
+
+    uint64_t getPosition() const {
+        return position;
+    }
+};
+
+// Creating the reader for packed bits. Its position is in bits
+class PackedBitReader {
+private:
+    const unsigned char* data;
+    uint64_t bitCount;
+    uint64_t position;
+
+public:
+    PackedBitReader(const unsigned char* data, uint64_t bitCount) : data(data), bitCount(bitCount), position(0) {}
+
+    // Function that reads one bit, returning false at the end of the message
+    bool getBit(unsigned& bit) {
+        if(position == bitCount) {
+            return false;
+        }
+        bit = (data[position >> 3] >> (7 - (position & 7))) & 1;
+        position++;
+        return true;
+    }
+
+    // Function that reads count bits, highest bit first. Count is at most 32
+    bool getBits(int count, unsigned& value) {
+        if(bitCount - position < (uint64_t)count) {
+            return false;
+        }
+        value = 0;
+        for(int i = 0; i < count; i++) {
+            value = (value << 1) | ((data[position >> 3] >> (7 - (position & 7))) & 1);
+            position++;
+        }
+        return true;
+    }
+
+    // Function that returns the next count bits without consuming them, highest bit first, with zero bits
+    //      standing in for anything past the end. Count is at most 57. Eight bytes are loaded at once
+    //      whenever they are all inside the buffer
+    uint64_t peekBits(int count) const {
+        uint64_t byteIndex = position >> 3;
+        uint64_t byteLength = (bitCount + 7) >> 3;
+        uint64_t word = 0;
+
+        if(byteIndex + 8 <= byteLength) {
+            memcpy(&word, data + byteIndex, 8);
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            word = __builtin_bswap64(word);
+#elif !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+            word = 0;
+            for(int i = 0; i < 8; i++) {
+                word = (word << 8) | data[byteIndex + i];
+            }
+#endif
+        }
+        else {
+            for(int i = 0; i < 8; i++) {
+                word = (word << 8) | (byteIndex + i < byteLength ? data[byteIndex + i] : 0);
+            }
+        }
+
+        return (word << (position & 7)) >> (64 - count);
+    }
+
+    // Function that consumes count bits that were looked at with peekBits
+    void skipBits(int count) {
+        position += count;
+    }
+
+    // Function that returns how many bits are left to read
+    uint64_t remaining() const {
+        return bitCount - position;
+    }
+
+    bool atEnd() const {
+        return position == bitCount;
+    }
+
+    uint64_t getPosition() const {
+        return position;
+    }
+};
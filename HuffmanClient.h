@@ -0,0 +1,244 @@
+/*
+    Purpose: Let a program hand its messages to huffmand instead of coding them itself. A client holds one
+        connection to the daemon and sends its requests over it one at a time, getting back the same
+        containers and messages HuffmanCompressor would give it. The input goes out on a thread of its own
+        while the calling thread takes in the reply, since the daemon starts replying before a request has
+        finished arriving, and a client that sent everything before reading anything could fill the socket
+        in both directions and wait forever. A client is for one thread at a time; threads that want to code
+        at the same time each open their own.
+*/
+#pragma once
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "HuffmanContainer.h"
+#include "HuffmanResult.h"
+#include "HuffmanSocket.h"
+#include "HuffmanTransforms.h"
+using namespace std;
+
+// Creating the client class
+class HuffmanClient {
+private:
+    // Creating the connected socket, or -1
+    int fd;
+
+    // Function that runs one request: sends the frame that starts it, then the input from sendInput on another
+    //      thread, and hands each piece of the reply to takeOutput. A failure of the input or output is only
+    //      reported once the reply is in, so the connection stays ready for the next request. A connection that
+    //      fails, or a daemon that sends something we don't understand, is closed
+    HuffmanResult runRequest(HuffmanFrameType type, const string& settings, const function<bool()>& sendInput,
+                             const function<bool(const string&)>& takeOutput, size_t& inputLength) {
+        if(this->fd < 0 || !sendFrame(this->fd, type, settings.data(), settings.size())) {
+            disconnect();
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, 0);
+        }
+
+        bool inputFailed = false;
+        thread sender([this, &sendInput, &inputFailed] {
+            inputFailed = !sendInput();
+            sendFrame(this->fd, FRAME_END, nullptr, 0);
+        });
+
+        size_t received = 0;
+        bool outputFailed = false;
+        bool connectionFailed = false;
+        string piece;
+        HuffmanResult result = huffmanSuccess();
+
+        while(true) {
+            uint8_t frameType = 0;
+            uint32_t length = 0;
+
+            if(!receiveFrameHeader(this->fd, frameType, length) || length > MAX_FRAME_LENGTH || (frameType != FRAME_DATA && frameType != FRAME_RESULT)) {
+                connectionFailed = true;
+                break;
+            }
+
+            piece.resize(length);
+            if(length > 0 && !receiveBytes(this->fd, &piece[0], length)) {
+                connectionFailed = true;
+                break;
+            }
+
+            if(frameType == FRAME_RESULT) {
+                connectionFailed = !readResultPayload(piece, result);
+                break;
+            }
+
+            if(!outputFailed && !takeOutput(piece)) {
+                outputFailed = true;
+            }
+            received += length;
+        }
+
+        // Waking the sender if it is stuck on a connection that has failed, before waiting for it
+        if(connectionFailed) {
+            shutdown(this->fd, SHUT_RDWR);
+        }
+        sender.join();
+
+        if(connectionFailed) {
+            disconnect();
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, received);
+        }
+        if(inputFailed) {
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, inputLength);
+        }
+        if(outputFailed && result.ok()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, received);
+        }
+        return result;
+    }
+
+    // Function that sends the view as DATA frames. A socket that fails just stops us, since the reply reports it
+    void sendView(string_view input, size_t& inputLength) {
+        for(size_t start = 0; start < input.size(); start += MAX_FRAME_LENGTH) {
+            size_t length = min(input.size() - start, MAX_FRAME_LENGTH);
+
+            if(!sendFrame(this->fd, FRAME_DATA, input.data() + start, length)) {
+                return;
+            }
+            inputLength += length;
+        }
+    }
+
+    // Function that sends the rest of the stream as DATA frames, the same way. Returns false if the stream goes
+    //      bad, and the daemon is then sent no more of it
+    bool sendStream(istream& input, size_t& inputLength) {
+        string piece(MAX_FRAME_LENGTH, '\0');
+
+        while(input) {
+            input.read(&piece[0], streamsize(piece.size()));
+            size_t got = size_t(input.gcount());
+
+            if(input.bad()) {
+                return false;
+            }
+            if(got > 0 && !sendFrame(this->fd, FRAME_DATA, piece.data(), got)) {
+                return true;
+            }
+            inputLength += got;
+        }
+        return true;
+    }
+
+    // Function that makes the payload of an ENCODE frame
+    static string encodeSettings(HuffmanBlockMode mode, uint8_t transforms) {
+        string settings;
+        settings.push_back(char(mode));
+        settings.push_back(char(transforms));
+        return settings;
+    }
+
+public:
+    // Constructor for a client that isn't connected yet
+    HuffmanClient() noexcept : fd(-1) {}
+
+    // A client owns its connection, so it can be neither copied nor moved
+    HuffmanClient(const HuffmanClient&) = delete;
+    HuffmanClient& operator=(const HuffmanClient&) = delete;
+
+    // Destructor that closes the connection
+    ~HuffmanClient() {
+        disconnect();
+    }
+
+    // Function that connects to the daemon listening on the socket at the path, closing any connection we already
+    //      had. Returns 0, or the errno of the call that failed
+    int connectTo(const string& path = DEFAULT_DAEMON_SOCKET) {
+        disconnect();
+
+        sockaddr_un address;
+        if(!makeSocketAddress(path, address)) {
+            return ENAMETOOLONG;
+        }
+
+        int socketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(socketFd < 0) {
+            return errno;
+        }
+
+        if(::connect(socketFd, (const sockaddr*)&address, sizeof(address)) != 0) {
+            int error = errno;
+            close(socketFd);
+            return error;
+        }
+
+        this->fd = socketFd;
+        return 0;
+    }
+
+    // Function that tells us whether we have a connection. A request whose connection fails closes it, and it
+    //      has to be opened again with connectTo
+    bool isConnected() const noexcept {
+        return this->fd >= 0;
+    }
+
+    // Function that closes the connection, if there is one
+    void disconnect() noexcept {
+        if(this->fd >= 0) {
+            close(this->fd);
+            this->fd = -1;
+        }
+    }
+
+    // Function that has the daemon compress the message into a container, appended onto the end of the string. A
+    //      failed request appends nothing. Error offsets are in characters of the message, and a connection that
+    //      fails is reported as HUFFMAN_TRUNCATED_MESSAGE
+    HuffmanResult compress(string_view message, string& container, HuffmanBlockMode mode = BLOCK_MODE_ADAPTIVE, uint8_t transforms = TRANSFORM_NONE) {
+        size_t startSize = container.size();
+        size_t inputLength = 0;
+
+        HuffmanResult result = runRequest(FRAME_ENCODE, encodeSettings(mode, transforms),
+            [&] { sendView(message, inputLength); return true; },
+            [&](const string& piece) { container.append(piece); return true; }, inputLength);
+
+        if(!result.ok()) {
+            container.resize(startSize);
+        }
+        return result;
+    }
+
+    // Function that has the daemon decompress the container, appending the message onto the end of the string. A
+    //      failed request appends nothing. Error offsets are in bytes of the container
+    HuffmanResult decompress(string_view container, string& message) {
+        size_t startSize = message.size();
+        size_t inputLength = 0;
+
+        HuffmanResult result = runRequest(FRAME_DECODE, string(),
+            [&] { sendView(container, inputLength); return true; },
+            [&](const string& piece) { message.append(piece); return true; }, inputLength);
+
+        if(!result.ok()) {
+            message.resize(startSize);
+        }
+        return result;
+    }
+
+    // Function that has the daemon compress the rest of the input stream into a container written to the output
+    //      stream, a piece at a time in both directions. On failure, part of the output may have been written
+    HuffmanResult compress(istream& input, ostream& output, HuffmanBlockMode mode = BLOCK_MODE_ADAPTIVE, uint8_t transforms = TRANSFORM_NONE) {
+        size_t inputLength = 0;
+
+        return runRequest(FRAME_ENCODE, encodeSettings(mode, transforms),
+            [&] { return sendStream(input, inputLength); },
+            [&](const string& piece) { return bool(output.write(piece.data(), streamsize(piece.size()))); }, inputLength);
+    }
+
+    // Function that has the daemon decompress a container from the input stream, writing the message to the output
+    //      stream. On failure, part of the output may have been written
+    HuffmanResult decompress(istream& input, ostream& output) {
+        size_t inputLength = 0;
+
+        return runRequest(FRAME_DECODE, string(),
+            [&] { return sendStream(input, inputLength); },
+            [&](const string& piece) { return bool(output.write(piece.data(), streamsize(piece.size()))); }, inputLength);
+    }
+};
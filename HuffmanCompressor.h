@@ -0,0 +1,476 @@
+/*
+    Purpose: Tie the coders to the container. The compressor splits a message into blocks, codes every
+        block with the mode the caller picked (adaptive, semi-adaptive, static, context, LZ77, Burrows-Wheeler,
+        token or UTF-8), or with the mode the selector picks for that block in auto mode, and
+        writes each one into the container behind its block header. UTF-8 blocks end on a character boundary.
+        Each coder is reset before each block, so every block stands on its own. Decompressing reads the mode
+        out of each block header, so it needs only the alphabet, and the token dictionary if any block was
+        coded with one. The code length limit of the adaptive tree, if it has one, and the transform stages
+        each block went through before coding are kept in the container header.
+
+        Because blocks stand on their own, a container can also be written and read a piece at a time, with
+        the container header handled first and then runs of whole blocks, which is what the pipeline does.
+
+        Burrows-Wheeler blocks are slow to code but share no state, so given a thread pool the compressor
+        codes them in parallel, one block per task, in both directions.
+*/
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AdaptiveHuffmanTree.h"
+#include "SemiAdaptiveHuffmanCoder.h"
+#include "StaticHuffmanCoder.h"
+#include "ContextHuffmanCoder.h"
+#include "LZ77HuffmanCoder.h"
+#include "BurrowsWheelerCoder.h"
+#include "TokenHuffmanCoder.h"
+#include "Utf8HuffmanTree.h"
+#include "HuffmanThreadPool.h"
+#include "HuffmanTransforms.h"
+#include "HuffmanContainer.h"
+#include "BlockModeSelector.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the compressor class
+class HuffmanCompressor {
+private:
+    // Creating the alphabet string, which we need again if a container's tree has a different code length limit,
+    //      and the parsed alphabet the transform stages work over
+    string alphabet;
+    TransformAlphabet transformAlphabet;
+
+    // Creating one coder of each kind, all on the same alphabet
+    AdaptiveHuffmanTree tree;
+    SemiAdaptiveHuffmanCoder semiAdaptiveCoder;
+    StaticHuffmanCoder staticCoder;
+    ContextHuffmanCoder contextCoder;
+    LZ77HuffmanCoder lz77Coder;
+    BurrowsWheelerHuffmanCoder bwtCoder;
+    TokenHuffmanCoder tokenCoder;
+
+    // Creating the code point tree, over the alphabet read as UTF-8. An alphabet that isn't valid UTF-8 gives it no
+    //      symbols, and its UTF-8 blocks are adaptive
+    Utf8HuffmanTree utf8Tree;
+
+    // Creating the thread pool that Burrows-Wheeler blocks are coded on, or nullptr to code them one at a time
+    HuffmanThreadPool* threadPool;
+
+    // Creating the largest number of characters in a block, and the code length limit we compress with
+    size_t blockSize;
+    int maxCodeLength;
+
+public:
+    // Constructor that takes the alphabet string, in the same form the AdaptiveHuffmanTree takes it, the block size,
+    //      the code length limit for the adaptive trees, and the level of the LZ77 match finder
+    explicit HuffmanCompressor(const string& alphabet, size_t blockSize = DEFAULT_BLOCK_SIZE, int maxCodeLength = NO_CODE_LENGTH_LIMIT,
+                               int level = DEFAULT_LZ77_LEVEL)
+        : alphabet(alphabet), transformAlphabet(alphabet), tree(alphabet, maxCodeLength), semiAdaptiveCoder(alphabet), staticCoder(alphabet),
+          contextCoder(alphabet, maxCodeLength), lz77Coder(alphabet, level, maxCodeLength),
+          bwtCoder(alphabet, maxCodeLength), tokenCoder(alphabet, vector<string>(), maxCodeLength),
+          utf8Tree(isUtf8Alphabet(alphabet) ? alphabet : string(), maxCodeLength), threadPool(nullptr),
+          blockSize(blockSize == 0 || blockSize > UINT32_MAX ? DEFAULT_BLOCK_SIZE : blockSize),
+          maxCodeLength(tree.getMaxCodeLength()) {}
+
+    // Function that gives the compressor a thread pool to code Burrows-Wheeler blocks on. The pool has to outlive
+    //      the compressor's use of it; nullptr goes back to coding them one at a time
+    void useThreadPool(HuffmanThreadPool* pool) noexcept {
+        this->threadPool = pool;
+    }
+
+    // Function that gives the token coder its dictionary. Token blocks are only written when it holds tokens, and
+    //      decompressing them takes the same dictionary they were compressed with
+    void useTokenDictionary(const vector<string>& tokens) {
+        this->tokenCoder = TokenHuffmanCoder(this->alphabet, tokens, this->tokenCoder.getMaxCodeLength());
+    }
+
+    // Function that returns the largest number of characters in a block
+    size_t getBlockSize() const noexcept {
+        return this->blockSize;
+    }
+
+    // Function that compresses the message into a container, appended onto the end of the string. The transforms
+    //      are TRANSFORM_ flags for the stages each block goes through before it is coded. Error offsets are in
+    //      characters of the message
+    HuffmanResult compress(string_view message, HuffmanBlockMode mode, string& container, uint8_t transforms = TRANSFORM_NONE) noexcept {
+        size_t startSize = container.size();
+        startContainer(container, transforms);
+
+        HuffmanResult result = compressBlocks(message, mode, container, transforms);
+        if(!result.ok()) {
+            container.resize(startSize);
+            return result;
+        }
+
+        return huffmanSuccess(container.size() - startSize, uint64_t(CONTAINER_HEADER_SIZE) * 8 + result.bitsWritten);
+    }
+
+    // Function that writes the container header onto the end of the string. A container can then be compressed a
+    //      piece of the message at a time, by calling compressBlocks with the same transforms for each piece
+    void startContainer(string& container, uint8_t transforms) noexcept {
+        useCodeLengthLimit(this->maxCodeLength);
+        writeContainerHeader(container, transforms & TRANSFORM_ALL, (uint8_t)this->maxCodeLength);
+    }
+
+    // Function that splits the message into blocks and appends each one onto the end of the container, without a
+    //      container header. An empty message still gets one block. Nothing is appended on failure, and error
+    //      offsets are in characters of the message
+    HuffmanResult compressBlocks(string_view message, HuffmanBlockMode mode, string& container, uint8_t transforms = TRANSFORM_NONE) noexcept {
+        useCodeLengthLimit(this->maxCodeLength);
+        transforms &= TRANSFORM_ALL;
+
+        size_t startSize = container.size();
+        uint64_t totalBits = 0;
+
+        // Always writing at least one block, so an empty message still makes a complete container
+        size_t blockCount = message.empty() ? 1 : (message.size() + this->blockSize - 1) / this->blockSize;
+
+        // Burrows-Wheeler blocks on a pool are each coded into a string of their own, which are copied in order. An
+        //      alphabet the coder can't take turns them into adaptive blocks, which share our tree, so they stay serial
+        if(mode == BLOCK_MODE_BWT && this->bwtCoder.supportsAlphabet() && this->threadPool != nullptr && blockCount > 1) {
+            vector<string> blockContainers(blockCount);
+            vector<HuffmanResult> results(blockCount);
+
+            this->threadPool->parallelFor(blockCount, [&](size_t i) {
+                string_view block = message.substr(i * this->blockSize, this->blockSize);
+                results[i] = transformAndCompressBlock(block, mode, transforms, blockContainers[i]);
+            });
+
+            for(size_t i = 0; i < blockCount; i++) {
+                if(!results[i].ok()) {
+                    container.resize(startSize);
+                    return huffmanFailure(results[i].status, i * this->blockSize + results[i].errorOffset);
+                }
+
+                container.append(blockContainers[i]);
+                totalBits += uint64_t(BLOCK_HEADER_SIZE) * 8 + results[i].bitsWritten;
+            }
+
+            return huffmanSuccess(container.size() - startSize, totalBits);
+        }
+
+        size_t blockStart = 0;
+
+        do {
+            size_t blockEnd = nextBlockEnd(message, blockStart, mode);
+            string_view block = message.substr(blockStart, blockEnd - blockStart);
+            HuffmanResult result = transformAndCompressBlock(block, mode, transforms, container);
+
+            if(!result.ok()) {
+                container.resize(startSize);
+                return huffmanFailure(result.status, blockStart + result.errorOffset);
+            }
+
+            totalBits += uint64_t(BLOCK_HEADER_SIZE) * 8 + result.bitsWritten;
+            blockStart = blockEnd;
+        } while(blockStart < message.size());
+
+        return huffmanSuccess(container.size() - startSize, totalBits);
+    }
+
+    // Function that returns where compressBlocks ends the block of the message that starts at the given place
+    size_t nextBlockEnd(string_view message, size_t blockStart, HuffmanBlockMode mode) const noexcept {
+        size_t blockEnd = min(blockStart + this->blockSize, message.size());
+
+        // Moving the end of a UTF-8 block back to the start of the character it falls in, so no character is split
+        //      between two blocks
+        if(mode == BLOCK_MODE_UTF8) {
+            blockEnd = blockStart + utf8CharacterBoundary(message.substr(blockStart), blockEnd - blockStart);
+        }
+        return blockEnd;
+    }
+
+    // Function that decompresses a container, appending the message onto the end of the string. Error offsets
+    //      are in bytes of the container
+    HuffmanResult decompress(string_view container, string& message) noexcept {
+        uint8_t transforms = TRANSFORM_NONE;
+        HuffmanResult result = startDecompressing(container, transforms);
+
+        if(!result.ok()) {
+            return result;
+        }
+
+        return decompressBlocks(container.substr(CONTAINER_HEADER_SIZE), transforms, message, CONTAINER_HEADER_SIZE);
+    }
+
+    // Function that reads the container header at the start of the string and gets ready to decompress its blocks,
+    //      giving back the transforms they went through. Error offsets are in bytes of the container
+    HuffmanResult startDecompressing(string_view container, uint8_t& transforms) noexcept {
+        ContainerHeader containerHeader;
+        HuffmanResult result = readContainerHeader(container, containerHeader);
+
+        if(!result.ok()) {
+            return result;
+        }
+
+        // Decoding with the container's code length limit, which has to be one a tree could have been built with
+        int maxCodeLength = containerHeader.maxCodeLength;
+        if(maxCodeLength != NO_CODE_LENGTH_LIMIT && (maxCodeLength < MIN_CODE_LENGTH_LIMIT || maxCodeLength > MAX_CODE_LENGTH_LIMIT)) {
+            return huffmanFailure(HUFFMAN_INVALID_HEADER, 6);
+        }
+        useCodeLengthLimit(maxCodeLength);
+
+        transforms = containerHeader.flags;
+        if((transforms & ~TRANSFORM_ALL) != 0) {
+            return huffmanFailure(HUFFMAN_INVALID_HEADER, 5);
+        }
+
+        return huffmanSuccess();
+    }
+
+    // Function that decompresses whole blocks that follow a container header read by startDecompressing, appending
+    //      the message onto the end of the string. The offset is where the blocks start in the container, which
+    //      error offsets are counted from
+    HuffmanResult decompressBlocks(string_view blocks, uint8_t transforms, string& message, size_t containerOffset = 0) noexcept {
+        // Reading every block header first, so we know where each payload starts and whether they can be decoded
+        //      in parallel
+        vector<BlockHeader> blockHeaders;
+        vector<size_t> payloadOffsets;
+        bool allBurrowsWheeler = true;
+        size_t offset = 0;
+
+        while(offset < blocks.size()) {
+            BlockHeader blockHeader;
+            HuffmanResult result = readBlockHeader(blocks, offset, blockHeader);
+
+            if(!result.ok()) {
+                return huffmanFailure(result.status, containerOffset + result.errorOffset);
+            }
+
+            blockHeaders.push_back(blockHeader);
+            payloadOffsets.push_back(offset);
+            allBurrowsWheeler = allBurrowsWheeler && blockHeader.mode == BLOCK_MODE_BWT;
+            offset += size_t(blockHeader.payloadBytes());
+        }
+
+        size_t startSize = message.size();
+        size_t blockCount = blockHeaders.size();
+
+        if(allBurrowsWheeler && this->threadPool != nullptr && blockCount > 1) {
+            vector<string> blockMessages(blockCount);
+            vector<HuffmanResult> results(blockCount);
+
+            this->threadPool->parallelFor(blockCount, [&](size_t i) {
+                results[i] = decompressAndUntransformBlock(blocks, payloadOffsets[i], blockHeaders[i], transforms, blockMessages[i]);
+            });
+
+            for(size_t i = 0; i < blockCount; i++) {
+                if(!results[i].ok()) {
+                    return huffmanFailure(results[i].status, containerOffset + results[i].errorOffset);
+                }
+                message.append(blockMessages[i]);
+            }
+        }
+        else {
+            for(size_t i = 0; i < blockCount; i++) {
+                HuffmanResult result = decompressAndUntransformBlock(blocks, payloadOffsets[i], blockHeaders[i], transforms, message);
+
+                if(!result.ok()) {
+                    return huffmanFailure(result.status, containerOffset + result.errorOffset);
+                }
+            }
+        }
+
+        return huffmanSuccess(message.size() - startSize, uint64_t(message.size() - startSize) * 8);
+    }
+
+private:
+    // Function that swaps in trees with the given code length limit, if ours have a different one
+    void useCodeLengthLimit(int limit) {
+        if(limit != this->tree.getMaxCodeLength()) {
+            this->tree = AdaptiveHuffmanTree(this->alphabet, limit);
+            this->contextCoder = ContextHuffmanCoder(this->alphabet, limit);
+            this->lz77Coder = LZ77HuffmanCoder(this->alphabet, this->lz77Coder.getLevel(), limit);
+            this->bwtCoder = BurrowsWheelerHuffmanCoder(this->alphabet, limit);
+            this->tokenCoder = TokenHuffmanCoder(this->alphabet, this->tokenCoder.getTokens(), limit);
+            this->utf8Tree = Utf8HuffmanTree(isUtf8Alphabet(this->alphabet) ? this->alphabet : string(), limit);
+        }
+    }
+
+    // Function that runs the transform stages over one block and then codes it, appending its header and payload to
+    //      the container. For Burrows-Wheeler blocks this only reads the compressor, so several threads can run it
+    //      at once. Error offsets are in characters of the block
+    HuffmanResult transformAndCompressBlock(string_view block, HuffmanBlockMode mode, uint8_t transforms, string& container) noexcept {
+        if(transforms == TRANSFORM_NONE) {
+            return compressBlock(block, mode, container);
+        }
+
+        // The stages need a message that is all in the alphabet, so the block is checked before they run
+        HuffmanResult validation = this->tree.validateMessage(block);
+        if(!validation.ok()) {
+            return validation;
+        }
+
+        string transformed;
+        applyTransforms(transforms, block, this->transformAlphabet, transformed);
+        return compressBlock(transformed, mode, container);
+    }
+
+    // Function that decodes the block whose payload starts at offset and undoes its transform stages, appending
+    //      the characters onto the end of the message. Like transformAndCompressBlock, this only reads the
+    //      compressor for Burrows-Wheeler blocks. Error offsets are in bytes of the container
+    HuffmanResult decompressAndUntransformBlock(string_view container, size_t offset, const BlockHeader& header, uint8_t transforms,
+                                                string& message) noexcept {
+        // With transforms, the block decodes into a string of its own, which the stages are undone from
+        string transformed;
+        string& blockMessage = transforms != TRANSFORM_NONE ? transformed : message;
+
+        size_t blockStart = blockMessage.size();
+        const unsigned char* payload = (const unsigned char*)container.data() + offset;
+        HuffmanResult result = decompressBlock(header, payload, blockMessage);
+
+        if(!result.ok()) {
+            return huffmanFailure(result.status, offset + size_t(result.errorOffset / 8));
+        }
+
+        // The header's character count has to match what the payload decoded to
+        if(blockMessage.size() - blockStart != header.rawLength) {
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, offset);
+        }
+
+        if(transforms != TRANSFORM_NONE) {
+            result = undoTransforms(transforms, transformed, this->transformAlphabet, message);
+
+            if(!result.ok()) {
+                return huffmanFailure(result.status, offset);
+            }
+        }
+
+        return huffmanSuccess(header.rawLength, uint64_t(header.rawLength) * 8);
+    }
+
+    // Function that codes one block and appends its header and payload to the container
+    HuffmanResult compressBlock(string_view block, HuffmanBlockMode mode, string& container) noexcept {
+        // Leaving room for the block header, which is filled in once we know how many bits the payload took
+        size_t headerPosition = container.size();
+        container.append(BLOCK_HEADER_SIZE, '\0');
+
+        // In auto mode the selector picks the block's mode, and a block that would come out bigger than it went in
+        //      is stored raw instead
+        bool automatic = mode == BLOCK_MODE_AUTO;
+        if(automatic) {
+            mode = chooseBlockMode(block, this->staticCoder.getAlphabetSymbols().size());
+        }
+
+        // An alphabet too big to share a tree with the length codes can't use LZ77, one too big for the run digits
+        //      can't use Burrows-Wheeler, and token mode without a dictionary would escape every character, so those
+        //      blocks are adaptive
+        if((mode == BLOCK_MODE_LZ77 && !this->lz77Coder.supportsAlphabet()) || (mode == BLOCK_MODE_BWT && !this->bwtCoder.supportsAlphabet()) ||
+           (mode == BLOCK_MODE_TOKEN && !this->tokenCoder.hasTokens())) {
+            mode = BLOCK_MODE_ADAPTIVE;
+        }
+
+        HuffmanResult result;
+
+        if(mode == BLOCK_MODE_ADAPTIVE) {
+            this->tree.reset();
+            StringSink sink(container);
+            result = this->tree.encode(block, sink);
+        }
+        else if(mode == BLOCK_MODE_SEMI_ADAPTIVE) {
+            this->semiAdaptiveCoder.reset();
+            result = this->semiAdaptiveCoder.encode(block, container);
+        }
+        else if(mode == BLOCK_MODE_STATIC) {
+            result = this->staticCoder.encode(block, container);
+        }
+        else if(mode == BLOCK_MODE_CONTEXT) {
+            this->contextCoder.reset();
+            result = this->contextCoder.encode(block, container);
+        }
+        else if(mode == BLOCK_MODE_LZ77) {
+            result = this->lz77Coder.encode(block, container);
+        }
+        else if(mode == BLOCK_MODE_BWT) {
+            result = this->bwtCoder.encode(block, container);
+        }
+        else if(mode == BLOCK_MODE_TOKEN) {
+            result = this->tokenCoder.encode(block, container);
+        }
+        else if(mode == BLOCK_MODE_UTF8) {
+            this->utf8Tree.reset();
+            StringSink sink(container);
+            result = this->utf8Tree.encode(block, sink);
+
+            // A block that isn't UTF-8 over the alphabet's characters, such as one the transform stages have been
+            //      over, is coded a byte at a time instead
+            if(result.status == HUFFMAN_INVALID_CHARACTER) {
+                container.resize(headerPosition);
+                return compressBlock(block, BLOCK_MODE_ADAPTIVE, container);
+            }
+        }
+        else {
+            result = this->tree.validateMessage(block);
+            if(result.ok()) {
+                container.append(block.data(), block.size());
+                result = huffmanSuccess(block.size(), uint64_t(block.size()) * 8);
+            }
+        }
+
+        if(!result.ok()) {
+            return result;
+        }
+
+        if(automatic && mode != BLOCK_MODE_RAW && result.bitsWritten >= uint64_t(block.size()) * 8) {
+            container.resize(headerPosition);
+            return compressBlock(block, BLOCK_MODE_RAW, container);
+        }
+
+        BlockHeader header;
+        header.mode = (uint8_t)mode;
+        header.rawLength = (uint32_t)block.size();
+        header.payloadBits = result.bitsWritten;
+
+        string headerBytes;
+        writeBlockHeader(headerBytes, header);
+        container.replace(headerPosition, BLOCK_HEADER_SIZE, headerBytes);
+
+        return result;
+    }
+
+    // Function that decodes one block's payload onto the end of the message. Error offsets are in bits
+    HuffmanResult decompressBlock(const BlockHeader& header, const unsigned char* payload, string& message) noexcept {
+        if(header.mode == BLOCK_MODE_ADAPTIVE) {
+            this->tree.reset();
+            StringSink sink(message);
+            return this->tree.decode(payload, header.payloadBits, sink);
+        }
+        else if(header.mode == BLOCK_MODE_SEMI_ADAPTIVE) {
+            this->semiAdaptiveCoder.reset();
+            return this->semiAdaptiveCoder.decode(payload, header.payloadBits, message);
+        }
+        else if(header.mode == BLOCK_MODE_STATIC) {
+            return this->staticCoder.decode(payload, header.payloadBits, message);
+        }
+        else if(header.mode == BLOCK_MODE_CONTEXT) {
+            this->contextCoder.reset();
+            return this->contextCoder.decode(payload, header.payloadBits, message);
+        }
+        else if(header.mode == BLOCK_MODE_LZ77) {
+            return this->lz77Coder.decode(payload, header.payloadBits, header.rawLength, message);
+        }
+        else if(header.mode == BLOCK_MODE_BWT) {
+            return this->bwtCoder.decode(payload, header.payloadBits, header.rawLength, message);
+        }
+        else if(header.mode == BLOCK_MODE_TOKEN) {
+            return this->tokenCoder.decode(payload, header.payloadBits, header.rawLength, message);
+        }
+        else if(header.mode == BLOCK_MODE_UTF8) {
+            this->utf8Tree.reset();
+            return this->utf8Tree.decode(payload, header.payloadBits, message);
+        }
+
+        // Raw blocks are the characters themselves, which still have to be in the alphabet
+        string_view block((const char*)payload, size_t(header.payloadBytes()));
+        HuffmanResult result = this->tree.validateMessage(block);
+
+        if(!result.ok()) {
+            return huffmanFailure(result.status, result.errorOffset * 8);
+        }
+
+        message.append(block.data(), block.size());
+        return huffmanSuccess(block.size(), uint64_t(block.size()) * 8);
+    }
+};
@@ -0,0 +1,154 @@
+/*
+    Purpose: Define the container that the packed coders store their output in. A container file starts
+        with an eight byte header: the "AHTC" magic, a version byte, a flags byte (the transform stages the
+        blocks went through before coding), the code length limit the adaptive blocks were coded with (zero
+        for none), and a reserved byte. After it come the blocks. Every block starts with a thirteen byte
+        header: the mode the block was coded with, the number of characters it holds (after any transform
+        stages), and the number of payload bits, followed by the payload itself, padded out to a whole byte.
+        Each block is coded on its own, starting from a fresh coder, so blocks can be decoded without the ones
+        before them. All numbers are little endian.
+*/
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the magic bytes, version and header sizes of the container
+const char CONTAINER_MAGIC[4] = {'A', 'H', 'T', 'C'};
+const uint8_t CONTAINER_VERSION = 1;
+const size_t CONTAINER_HEADER_SIZE = 8;
+const size_t BLOCK_HEADER_SIZE = 13;
+
+// Creating the default number of characters in a block
+const size_t DEFAULT_BLOCK_SIZE = size_t(1) << 20;
+
+// Creating the modes a block can be coded with
+enum HuffmanBlockMode {
+    // The characters are stored as they are
+    BLOCK_MODE_RAW = 0,
+
+    // The characters are coded with a fresh AdaptiveHuffmanTree
+    BLOCK_MODE_ADAPTIVE = 1,
+
+    // The characters are coded with a fresh SemiAdaptiveHuffmanCoder
+    BLOCK_MODE_SEMI_ADAPTIVE = 2,
+
+    // The characters are coded with a static canonical code, whose code lengths start the payload
+    BLOCK_MODE_STATIC = 3,
+
+    // The characters are coded with an order-1 ContextHuffmanCoder, one tree per previous character
+    BLOCK_MODE_CONTEXT = 4,
+
+    // The characters go through an LZ77HuffmanCoder, as literals and matches coded with two fresh trees
+    BLOCK_MODE_LZ77 = 5,
+
+    // The characters are coded with a BurrowsWheelerHuffmanCoder, whose payload starts with the primary index
+    BLOCK_MODE_BWT = 6,
+
+    // The characters are coded with a TokenHuffmanCoder, whose payload starts with the dictionary's fingerprint
+    BLOCK_MODE_TOKEN = 7,
+
+    // The characters are read as UTF-8 and their code points coded with a fresh Utf8HuffmanTree
+    BLOCK_MODE_UTF8 = 8,
+
+    // Never written to a block header. It asks the compressor to pick one of the modes above for every block
+    BLOCK_MODE_AUTO = 255
+};
+
+// Creating the container header and block header types
+struct ContainerHeader {
+    uint8_t version;
+    uint8_t flags;
+    uint8_t maxCodeLength;
+};
+
+struct BlockHeader {
+    uint8_t mode;
+    uint32_t rawLength;
+    uint64_t payloadBits;
+
+    // Function that returns the number of bytes the payload takes up in the file
+    uint64_t payloadBytes() const {
+        return (payloadBits + 7) / 8;
+    }
+};
+
+// Functions that write and read little endian numbers
+inline void appendLittleEndian(string& output, uint64_t value, int bytes) {
+    for(int i = 0; i < bytes; i++) {
+        output.push_back(char((value >> (8 * i)) & 0xff));
+    }
+}
+
+inline uint64_t readLittleEndian(const char* input, int bytes) {
+    uint64_t value = 0;
+    for(int i = 0; i < bytes; i++) {
+        value |= uint64_t((unsigned char)input[i]) << (8 * i);
+    }
+    return value;
+}
+
+// Function that checks whether a file's contents start with the container header
+inline bool isContainerFile(string_view contents) {
+    return contents.size() >= CONTAINER_HEADER_SIZE && memcmp(contents.data(), CONTAINER_MAGIC, 4) == 0;
+}
+
+// Function that appends a container header
+inline void writeContainerHeader(string& output, uint8_t flags, uint8_t maxCodeLength) {
+    output.append(CONTAINER_MAGIC, 4);
+    output.push_back(char(CONTAINER_VERSION));
+    output.push_back(char(flags));
+    output.push_back(char(maxCodeLength));
+    output.push_back(char(0));
+}
+
+// Function that reads a container header from the start of the contents
+inline HuffmanResult readContainerHeader(string_view contents, ContainerHeader& header) {
+    if(!isContainerFile(contents)) {
+        return huffmanFailure(HUFFMAN_INVALID_HEADER, 0);
+    }
+
+    header.version = (uint8_t)contents[4];
+    header.flags = (uint8_t)contents[5];
+    header.maxCodeLength = (uint8_t)contents[6];
+
+    if(header.version != CONTAINER_VERSION) {
+        return huffmanFailure(HUFFMAN_INVALID_HEADER, 4);
+    }
+
+    return huffmanSuccess();
+}
+
+// Function that appends a block header
+inline void writeBlockHeader(string& output, const BlockHeader& header) {
+    output.push_back(char(header.mode));
+    appendLittleEndian(output, header.rawLength, 4);
+    appendLittleEndian(output, header.payloadBits, 8);
+}
+
+// Function that reads the block header at offset, moving offset past it, and checks the payload is all there
+inline HuffmanResult readBlockHeader(string_view contents, size_t& offset, BlockHeader& header) {
+    if(contents.size() - offset < BLOCK_HEADER_SIZE) {
+        return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, contents.size());
+    }
+
+    const char* data = contents.data() + offset;
+    header.mode = (uint8_t)data[0];
+    header.rawLength = (uint32_t)readLittleEndian(data + 1, 4);
+    header.payloadBits = readLittleEndian(data + 5, 8);
+
+    if(header.mode > BLOCK_MODE_UTF8) {
+        return huffmanFailure(HUFFMAN_INVALID_HEADER, offset);
+    }
+
+    offset += BLOCK_HEADER_SIZE;
+
+    if(header.payloadBits > uint64_t(contents.size() - offset) * 8) {
+        return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, contents.size());
+    }
+
+    return huffmanSuccess();
+}
@@ -0,0 +1,334 @@
+/*
+    Purpose: Serve encode and decode requests over a Unix domain socket, for programs that would otherwise
+        start the command line program for every message and pass it files. The daemon parses the alphabet
+        and builds its compressors once, when it starts, and keeps them and the thread pool Burrows-Wheeler
+        blocks are coded on for as long as it runs, so a request costs no process start, no alphabet parsing
+        and no trip through the disk. Every connection has a thread of its own, and each request on it
+        borrows a built compressor for as long as it is being coded, waiting for one if they are all busy.
+        Only so many connections are served at once. Past that, new ones wait in the listen backlog until
+        one closes, so clients can't make us start threads without end, and every thread is joined before
+        serve returns.
+        A request is streamed through the same pipeline the command line streams containers through, so the
+        first of the reply goes back while the rest of the request is still arriving, and neither is ever
+        held whole. See HuffmanSocket.h for the frames, and HuffmanClient.h for the other end.
+*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "HuffmanCompressor.h"
+#include "HuffmanPipeline.h"
+#include "HuffmanSocket.h"
+#include "HuffmanThreadPool.h"
+using namespace std;
+
+// Creating the number of connections the kernel holds for us while we are busy accepting others, and how long we
+//      wait before accepting again when we are out of file descriptors
+const int DAEMON_LISTEN_BACKLOG = 64;
+const chrono::milliseconds DAEMON_ACCEPT_RETRY(10);
+
+// Creating the most connections served at once when the caller doesn't say
+const size_t DEFAULT_DAEMON_CONNECTIONS = 256;
+
+// Creating the daemon class
+class HuffmanDaemon {
+private:
+    // Creating the pool the compressors code Burrows-Wheeler blocks on, and the compressors no request is using,
+    //      with the lock and signal a request waits on for one
+    HuffmanThreadPool& pool;
+    vector<unique_ptr<HuffmanCompressor>> idleCompressors;
+    mutex compressorMutex;
+    condition_variable compressorSignal;
+
+    // Creating the listening socket and its path, and whether we have been asked to stop
+    int listenFd;
+    string socketPath;
+    atomic<bool> stopping;
+
+    // Creating the open connections, each with whether it is in the middle of a request, the most we serve at once,
+    //      and the lock and signal that serve waits on for one of them to close
+    map<int, bool> connections;
+    size_t maxConnections;
+    mutex connectionMutex;
+    condition_variable connectionSignal;
+
+    // Creating the threads serving the connections, and the ones among them that have finished and can be joined
+    vector<thread> connectionThreads;
+    vector<thread::id> finishedThreads;
+
+    // Function that joins the connection threads that have finished, so they don't pile up while we run
+    void joinFinishedThreads() {
+        vector<thread> finished;
+
+        {
+            lock_guard<mutex> lock(this->connectionMutex);
+
+            for(size_t i = 0; i < this->connectionThreads.size(); ) {
+                if(find(this->finishedThreads.begin(), this->finishedThreads.end(), this->connectionThreads[i].get_id()) != this->finishedThreads.end()) {
+                    finished.push_back(std::move(this->connectionThreads[i]));
+                    this->connectionThreads[i] = std::move(this->connectionThreads.back());
+                    this->connectionThreads.pop_back();
+                }
+                else {
+                    i++;
+                }
+            }
+            this->finishedThreads.clear();
+        }
+
+        for(size_t i = 0; i < finished.size(); i++) {
+            finished[i].join();
+        }
+    }
+
+    // Function that takes a compressor, waiting until a request gives one back if none are free
+    unique_ptr<HuffmanCompressor> borrowCompressor() {
+        unique_lock<mutex> lock(this->compressorMutex);
+        this->compressorSignal.wait(lock, [this] { return !this->idleCompressors.empty(); });
+
+        unique_ptr<HuffmanCompressor> compressor = std::move(this->idleCompressors.back());
+        this->idleCompressors.pop_back();
+        return compressor;
+    }
+
+    // Function that gives a compressor back for the next request. Every block resets the coders, so it needs
+    //      nothing done to it first
+    void giveBackCompressor(unique_ptr<HuffmanCompressor> compressor) {
+        lock_guard<mutex> lock(this->compressorMutex);
+        this->idleCompressors.push_back(std::move(compressor));
+        this->compressorSignal.notify_one();
+    }
+
+    // Function that marks a connection as in or out of a request. Returns false if we are stopping, so the
+    //      connection starts no new request
+    bool markBusy(int fd, bool busy) {
+        lock_guard<mutex> lock(this->connectionMutex);
+        this->connections[fd] = busy;
+        return !this->stopping;
+    }
+
+    // Function that codes one request, whose first frame has just been read, and sends back its reply. Returns
+    //      false if the connection can't carry another request
+    bool serveRequest(int fd, uint8_t type, uint32_t length) {
+        if(!((type == FRAME_ENCODE && length == ENCODE_FRAME_LENGTH) || (type == FRAME_DECODE && length == 0))) {
+            return false;
+        }
+
+        char settings[ENCODE_FRAME_LENGTH] = {0, 0};
+        if(length > 0 && !receiveBytes(fd, settings, length)) {
+            return false;
+        }
+
+        bool encoding = type == FRAME_ENCODE;
+        uint8_t mode = uint8_t(settings[0]);
+        uint8_t transforms = uint8_t(settings[1]);
+
+        FrameInputBuffer inputBuffer(fd, FRAME_END);
+        FrameOutputBuffer outputBuffer(fd);
+        HuffmanResult result;
+
+        // A mode this build doesn't know is turned down before anything is coded, and so is a transform flag
+        if(encoding && ((mode > BLOCK_MODE_UTF8 && mode != BLOCK_MODE_AUTO) || (transforms & ~TRANSFORM_ALL) != 0)) {
+            result = huffmanFailure(HUFFMAN_INVALID_HEADER, 0);
+        }
+        else {
+            unique_ptr<HuffmanCompressor> compressor = borrowCompressor();
+            istream input(&inputBuffer);
+            ostream output(&outputBuffer);
+
+            result = encoding
+                ? compressStream(input, output, *compressor, HuffmanBlockMode(mode), transforms, this->pool.getThreadCount())
+                : decompressStream(input, output, *compressor, this->pool.getThreadCount());
+
+            giveBackCompressor(std::move(compressor));
+
+            if(result.ok() && !output.flush()) {
+                result = huffmanFailure(HUFFMAN_OUTPUT_FULL, result.bytesWritten);
+            }
+        }
+
+        // The reply is only sent once the whole request has been read, even if it failed part way, so the next
+        //      frame on the socket is the start of the next request
+        if(!inputBuffer.finish() || outputBuffer.isBroken()) {
+            return false;
+        }
+
+        string payload = resultPayload(result);
+        return sendFrame(fd, FRAME_RESULT, payload.data(), payload.size());
+    }
+
+    // Function that each connection's thread runs: serve requests until the client hangs up or we stop
+    void serveConnection(int fd) {
+        uint8_t type = 0;
+        uint32_t length = 0;
+
+        while(receiveFrameHeader(fd, type, length) && markBusy(fd, true)) {
+            bool open = serveRequest(fd, type, length);
+
+            if(!markBusy(fd, false) || !open) {
+                break;
+            }
+        }
+
+        // Closing under the lock, so stop can't shut down a descriptor that has already been reused, and signalling
+        //      under it too, so serve can't return and destroy the signal while we are still using it
+        lock_guard<mutex> lock(this->connectionMutex);
+        this->connections.erase(fd);
+        this->finishedThreads.push_back(this_thread::get_id());
+        close(fd);
+        this->connectionSignal.notify_all();
+    }
+
+public:
+    // Constructor that builds the given number of compressors over the alphabet, each using the pool for its
+    //      Burrows-Wheeler blocks, holding the token dictionary and compressing with the code length limit, and
+    //      serving up to maxConnections connections at once. A HuffmanException is thrown for a bad alphabet
+    HuffmanDaemon(HuffmanThreadPool& pool, const string& alphabet, size_t compressorCount, int level = DEFAULT_LZ77_LEVEL,
+                  const vector<string>& tokens = vector<string>(), size_t blockSize = DEFAULT_BLOCK_SIZE,
+                  int maxCodeLength = NO_CODE_LENGTH_LIMIT, size_t maxConnections = DEFAULT_DAEMON_CONNECTIONS)
+        : pool(pool), listenFd(-1), stopping(false), maxConnections(max<size_t>(maxConnections, 1)) {
+        for(size_t i = 0; i < max<size_t>(compressorCount, 1); i++) {
+            this->idleCompressors.push_back(make_unique<HuffmanCompressor>(alphabet, blockSize, maxCodeLength, level));
+            this->idleCompressors.back()->useThreadPool(&pool);
+            this->idleCompressors.back()->useTokenDictionary(tokens);
+        }
+    }
+
+    // The connection threads point back at the daemon, so it can be neither copied nor moved
+    HuffmanDaemon(const HuffmanDaemon&) = delete;
+    HuffmanDaemon& operator=(const HuffmanDaemon&) = delete;
+
+    // Destructor that closes the listening socket and removes it, if serve didn't already
+    ~HuffmanDaemon() {
+        if(this->listenFd >= 0) {
+            close(this->listenFd);
+            unlink(this->socketPath.c_str());
+        }
+    }
+
+    // Function that creates the socket at the path and starts listening on it. A socket file left behind by a
+    //      daemon that is no longer running is replaced, but not one that still answers. Returns 0, or the errno of
+    //      the call that failed
+    int listenOn(const string& path) {
+        sockaddr_un address;
+        if(!makeSocketAddress(path, address)) {
+            return ENAMETOOLONG;
+        }
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(fd < 0) {
+            return errno;
+        }
+
+        if(::connect(fd, (const sockaddr*)&address, sizeof(address)) == 0) {
+            close(fd);
+            return EADDRINUSE;
+        }
+        if(errno == ECONNREFUSED) {
+            unlink(path.c_str());
+        }
+        close(fd);
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(fd < 0) {
+            return errno;
+        }
+
+        if(::bind(fd, (const sockaddr*)&address, sizeof(address)) != 0 || ::listen(fd, DAEMON_LISTEN_BACKLOG) != 0) {
+            int error = errno;
+            close(fd);
+            return error;
+        }
+
+        this->listenFd = fd;
+        this->socketPath = path;
+        return 0;
+    }
+
+    // Function that accepts connections and serves them until stop is called. It then lets every request already
+    //      being coded finish and send its reply, closes the connections, joins their threads, and removes the socket
+    void serve() {
+        while(!this->stopping) {
+            // Waiting for a connection to close while we are serving as many as we take. Clients that connect in
+            //      the meantime wait in the listen backlog
+            {
+                unique_lock<mutex> lock(this->connectionMutex);
+                this->connectionSignal.wait(lock, [this] { return this->stopping || this->connections.size() < this->maxConnections; });
+            }
+            joinFinishedThreads();
+
+            if(this->stopping) {
+                break;
+            }
+
+            int fd = accept4(this->listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+
+            if(fd < 0) {
+                if(this->stopping) {
+                    break;
+                }
+                if(errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    this_thread::sleep_for(DAEMON_ACCEPT_RETRY);
+                }
+                else if(errno != EINTR && errno != ECONNABORTED) {
+                    break;
+                }
+                continue;
+            }
+
+            {
+                lock_guard<mutex> lock(this->connectionMutex);
+                if(this->stopping) {
+                    close(fd);
+                    break;
+                }
+                this->connections[fd] = false;
+
+                // Starting the thread under the lock, so it can't be marked finished before it is in the list
+                this->connectionThreads.emplace_back(&HuffmanDaemon::serveConnection, this, fd);
+            }
+        }
+
+        stop();
+
+        {
+            unique_lock<mutex> lock(this->connectionMutex);
+            this->connectionSignal.wait(lock, [this] { return this->connections.empty(); });
+        }
+
+        // Every connection has closed, so every thread is finished or about to be
+        joinFinishedThreads();
+
+        close(this->listenFd);
+        unlink(this->socketPath.c_str());
+        this->listenFd = -1;
+    }
+
+    // Function that asks serve to return, from any thread. Connections waiting for their next request are closed
+    //      now, and the rest once their current request has been answered
+    void stop() {
+        lock_guard<mutex> lock(this->connectionMutex);
+        this->stopping = true;
+
+        if(this->listenFd >= 0) {
+            shutdown(this->listenFd, SHUT_RDWR);
+        }
+        this->connectionSignal.notify_all();
+
+        for(const pair<const int, bool>& connection : this->connections) {
+            if(!connection.second) {
+                shutdown(connection.first, SHUT_RDWR);
+            }
+        }
+    }
+};
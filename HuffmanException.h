@@ -30,8 +30,9 @@ public:
         errorOutput = s;
     }
 
-    // Function that will print the error output on the screen
-    void outputError() {
-        cout << this->errorOutput << endl;
+    // Function that will print the error output on the screen, or on another stream, such as cerr when the coded
+    //      output is going to the screen
+    void outputError(ostream& output = cout) {
+        output << this->errorOutput << endl;
     };
 };
\ No newline at end of file
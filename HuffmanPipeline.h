@@ -0,0 +1,412 @@
+/*
+    Purpose: Overlap reading, coding and writing, so a large file isn't read whole before any of it is coded,
+        and the coder isn't left waiting on the disk. A reader thread, the coder (on the calling thread) and
+        a writer thread each work on a different chunk of the stream. They hand chunks to each other through
+        lock-free single-producer single-consumer rings, and hand the emptied chunks back the same way, so a
+        fixed number of buffers is reused for the whole stream. When the coder falls behind, the reader runs
+        out of empty chunks and waits, and when the writer falls behind the coder does, so no more than the
+        pipeline's depth of chunks is ever held at each end. The first stage to fail stops the other two.
+
+        compressStream and decompressStream run containers through the pipeline a run of whole blocks at a
+        time. Blocks stand on their own, so the container comes out the same as the compressor would write
+        it in one call, except that UTF-8 blocks may be cut at different characters.
+*/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HuffmanCompressor.h"
+#include "HuffmanContainer.h"
+#include "HuffmanUtf8.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the default number of chunks in flight at each end of the pipeline, and how many times a stage spins
+//      on a ring before it starts sleeping between looks
+const size_t DEFAULT_PIPELINE_DEPTH = 4;
+const unsigned PIPELINE_SPIN_LIMIT = 64;
+const chrono::microseconds PIPELINE_SLEEP(50);
+
+// Creating the size of a cache line, which the two ends of a ring are kept apart by
+const size_t PIPELINE_CACHE_LINE = 64;
+
+// Creating the largest piece of a block payload the decompressing reader asks for at once, so a damaged header
+//      that claims a huge payload can't make it allocate one up front
+const size_t PIPELINE_READ_PIECE = size_t(1) << 20;
+
+// Function that a stage calls each time it finds a ring it is waiting on still full or still empty. It yields
+//      at first, and then sleeps, so a stage waiting on a slow disk doesn't hold on to a core
+inline void pipelineBackOff(unsigned spins) {
+    if(spins < PIPELINE_SPIN_LIMIT) {
+        this_thread::yield();
+    }
+    else {
+        this_thread::sleep_for(PIPELINE_SLEEP);
+    }
+}
+
+// Creating the single-producer single-consumer ring. Only one thread may push and only one may pop. Each end only
+//      writes its own counter, so neither needs a lock, and the counters sit on cache lines of their own so the two
+//      threads don't keep taking the line from each other
+template<class T>
+class SpscRing {
+private:
+    // Creating the slots, whose count is a power of two so a counter can be turned into a slot with a mask
+    vector<T> slots;
+    size_t mask;
+
+    // Creating the number of values ever popped, written by the consumer, and ever pushed, written by the producer
+    alignas(PIPELINE_CACHE_LINE) atomic<size_t> head;
+    alignas(PIPELINE_CACHE_LINE) atomic<size_t> tail;
+
+public:
+    // Constructor that makes room for at least the given number of values
+    explicit SpscRing(size_t capacity) : head(0), tail(0) {
+        size_t size = 1;
+        while(size < capacity) {
+            size <<= 1;
+        }
+
+        this->slots.resize(size);
+        this->mask = size - 1;
+    }
+
+    // Function that pushes a value if there is room, returning false if the ring is full
+    bool tryPush(const T& value) noexcept {
+        size_t tail = this->tail.load(memory_order_relaxed);
+
+        if(tail - this->head.load(memory_order_acquire) == this->slots.size()) {
+            return false;
+        }
+
+        this->slots[tail & this->mask] = value;
+        this->tail.store(tail + 1, memory_order_release);
+        return true;
+    }
+
+    // Function that pops the oldest value if there is one, returning false if the ring is empty
+    bool tryPop(T& value) noexcept {
+        size_t head = this->head.load(memory_order_relaxed);
+
+        if(head == this->tail.load(memory_order_acquire)) {
+            return false;
+        }
+
+        value = this->slots[head & this->mask];
+        this->head.store(head + 1, memory_order_release);
+        return true;
+    }
+
+    // Function that waits until there is room and pushes the value, giving up and returning false if the flag is
+    //      set first
+    bool push(const T& value, const atomic<bool>& cancelled) {
+        for(unsigned spins = 0; !tryPush(value); spins++) {
+            if(cancelled.load(memory_order_acquire)) {
+                return false;
+            }
+            pipelineBackOff(spins);
+        }
+        return true;
+    }
+
+    // Function that waits until there is a value and pops it, giving up and returning false if the flag is set first
+    bool pop(T& value, const atomic<bool>& cancelled) {
+        for(unsigned spins = 0; !tryPop(value); spins++) {
+            if(cancelled.load(memory_order_acquire)) {
+                return false;
+            }
+            pipelineBackOff(spins);
+        }
+        return true;
+    }
+};
+
+// Creating one chunk of the stream. The last chunk of the stream is marked, and may be empty
+struct PipelineChunk {
+    string data;
+    bool last;
+};
+
+// Creating the pipeline class
+class HuffmanPipeline {
+public:
+    // Creating the stages. The read stage fills an empty chunk with the next piece of the stream and marks it if it
+    //      is the last. The code stage turns an input chunk into an output chunk, and the write stage takes each
+    //      output chunk in order. A stage that fails stops the pipeline, and its result is what run gives back
+    typedef function<HuffmanResult(PipelineChunk& chunk)> ReadStage;
+    typedef function<HuffmanResult(const PipelineChunk& input, PipelineChunk& output)> CodeStage;
+    typedef function<HuffmanResult(const PipelineChunk& chunk)> WriteStage;
+
+private:
+    size_t depth;
+
+public:
+    // Constructor that takes the number of chunks in flight at each end of the pipeline
+    explicit HuffmanPipeline(size_t depth = DEFAULT_PIPELINE_DEPTH) : depth(depth == 0 ? 1 : depth) {}
+
+    // Function that runs the stream through the three stages until the last chunk has been written or a stage fails
+    HuffmanResult run(const ReadStage& read, const CodeStage& code, const WriteStage& write) {
+        // Creating the chunks, which start out in the rings of empty chunks, and the rings that carry them on
+        vector<PipelineChunk> inputChunks(this->depth);
+        vector<PipelineChunk> outputChunks(this->depth);
+        SpscRing<PipelineChunk*> emptyInputs(this->depth);
+        SpscRing<PipelineChunk*> filledInputs(this->depth);
+        SpscRing<PipelineChunk*> emptyOutputs(this->depth);
+        SpscRing<PipelineChunk*> filledOutputs(this->depth);
+
+        for(size_t i = 0; i < this->depth; i++) {
+            emptyInputs.tryPush(&inputChunks[i]);
+            emptyOutputs.tryPush(&outputChunks[i]);
+        }
+
+        atomic<bool> failed(false);
+        HuffmanResult readResult = huffmanSuccess();
+        HuffmanResult codeResult = huffmanSuccess();
+        HuffmanResult writeResult = huffmanSuccess();
+
+        thread reader([&] {
+            for(bool last = false; !last; ) {
+                PipelineChunk* chunk = nullptr;
+                if(!emptyInputs.pop(chunk, failed)) {
+                    return;
+                }
+
+                chunk->data.clear();
+                chunk->last = false;
+                readResult = read(*chunk);
+
+                if(!readResult.ok()) {
+                    failed.store(true, memory_order_release);
+                    return;
+                }
+
+                last = chunk->last;
+                if(!filledInputs.push(chunk, failed)) {
+                    return;
+                }
+            }
+        });
+
+        thread writer([&] {
+            for(bool last = false; !last; ) {
+                PipelineChunk* chunk = nullptr;
+                if(!filledOutputs.pop(chunk, failed)) {
+                    return;
+                }
+
+                writeResult = write(*chunk);
+
+                if(!writeResult.ok()) {
+                    failed.store(true, memory_order_release);
+                    return;
+                }
+
+                last = chunk->last;
+                if(!emptyOutputs.push(chunk, failed)) {
+                    return;
+                }
+            }
+        });
+
+        // Coding on this thread, a chunk at a time, handing each input chunk back to the reader once it is coded
+        for(bool last = false; !last; ) {
+            PipelineChunk* input = nullptr;
+            PipelineChunk* output = nullptr;
+            if(!filledInputs.pop(input, failed) || !emptyOutputs.pop(output, failed)) {
+                break;
+            }
+
+            output->data.clear();
+            output->last = input->last;
+            codeResult = code(*input, *output);
+            last = input->last;
+
+            if(!codeResult.ok()) {
+                failed.store(true, memory_order_release);
+                break;
+            }
+
+            if(!emptyInputs.push(input, failed) || !filledOutputs.push(output, failed)) {
+                break;
+            }
+        }
+
+        reader.join();
+        writer.join();
+
+        if(!readResult.ok()) {
+            return readResult;
+        }
+        if(!codeResult.ok()) {
+            return codeResult;
+        }
+        return writeResult;
+    }
+};
+
+// Function that reads up to count more bytes from the stream onto the end of the string, returning how many it got
+inline size_t readStreamBytes(istream& input, string& data, size_t count) {
+    size_t start = data.size();
+    data.resize(start + count);
+    input.read(&data[start], streamsize(count));
+
+    size_t got = size_t(input.gcount());
+    data.resize(start + got);
+    return got;
+}
+
+// Function that returns a write stage that writes each chunk to the stream, counting the bytes into written
+inline HuffmanPipeline::WriteStage streamWriteStage(ostream& output, size_t& written) {
+    return [&output, &written](const PipelineChunk& chunk) {
+        output.write(chunk.data.data(), streamsize(chunk.data.size()));
+        if(!output) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, written);
+        }
+
+        written += chunk.data.size();
+        return huffmanSuccess();
+    };
+}
+
+// Function that compresses the rest of the input stream into a container written to the output stream. Each chunk
+//      holds the given number of blocks, so a compressor with a thread pool has that many Burrows-Wheeler blocks to
+//      code at once. The result counts the bytes written, and error offsets are in bytes of the input
+inline HuffmanResult compressStream(istream& input, ostream& output, HuffmanCompressor& compressor, HuffmanBlockMode mode,
+                                    uint8_t transforms = TRANSFORM_NONE, size_t blocksPerChunk = 1, size_t depth = DEFAULT_PIPELINE_DEPTH) {
+    size_t chunkSize = compressor.getBlockSize() * (blocksPerChunk == 0 ? 1 : blocksPerChunk);
+    size_t bytesRead = 0;
+    size_t bytesCoded = 0;
+    size_t written = 0;
+    bool started = false;
+
+    // UTF-8 chunks end on a character boundary, and the bytes of the character cut off start the next chunk
+    string carried;
+
+    HuffmanPipeline::ReadStage read = [&](PipelineChunk& chunk) {
+        chunk.data.assign(carried);
+        carried.clear();
+
+        bytesRead += readStreamBytes(input, chunk.data, chunkSize - chunk.data.size());
+        if(input.bad()) {
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, bytesRead);
+        }
+
+        chunk.last = chunk.data.size() < chunkSize;
+
+        // Carrying the last character over if it doesn't decode, which is most often because it runs past the end
+        //      of the chunk. Anything else wrong with it is reported at its place in the next chunk
+        if(mode == BLOCK_MODE_UTF8 && !chunk.last) {
+            size_t boundary = utf8CharacterBoundary(chunk.data, chunk.data.size() - 1);
+            uint32_t codePoint = 0;
+
+            if(boundary > 0 && decodeUtf8Character((const unsigned char*)chunk.data.data() + boundary, chunk.data.size() - boundary, codePoint) == 0) {
+                carried.assign(chunk.data, boundary, string::npos);
+                chunk.data.resize(boundary);
+            }
+        }
+        return huffmanSuccess();
+    };
+
+    HuffmanPipeline::CodeStage code = [&](const PipelineChunk& in, PipelineChunk& out) {
+        // The first chunk starts the container, and gets a block even if it is empty. An empty chunk after it
+        //      only marks the end of the stream
+        if(!started) {
+            compressor.startContainer(out.data, transforms);
+            started = true;
+        }
+        else if(in.data.empty()) {
+            return huffmanSuccess();
+        }
+
+        HuffmanResult result = compressor.compressBlocks(in.data, mode, out.data, transforms);
+        if(!result.ok()) {
+            return huffmanFailure(result.status, bytesCoded + result.errorOffset);
+        }
+
+        bytesCoded += in.data.size();
+        return huffmanSuccess();
+    };
+
+    HuffmanResult result = HuffmanPipeline(depth).run(read, code, streamWriteStage(output, written));
+    if(!result.ok()) {
+        return result;
+    }
+    return huffmanSuccess(written, uint64_t(written) * 8);
+}
+
+// Function that decompresses a container from the input stream, writing the message to the output stream. Whole
+//      blocks are gathered into chunks of about the given number of blocks. The result counts the bytes written,
+//      and error offsets are in bytes of the container
+inline HuffmanResult decompressStream(istream& input, ostream& output, HuffmanCompressor& compressor, size_t blocksPerChunk = 1,
+                                      size_t depth = DEFAULT_PIPELINE_DEPTH) {
+    size_t chunkSize = compressor.getBlockSize() * (blocksPerChunk == 0 ? 1 : blocksPerChunk);
+    size_t bytesRead = 0;
+    size_t containerOffset = 0;
+    size_t written = 0;
+    bool headerRead = false;
+    uint8_t transforms = TRANSFORM_NONE;
+
+    // The first chunk is just the container header. Every chunk after it is whole blocks, found by reading each
+    //      block header for the size of its payload, apart from a damaged last block, which the coder reports
+    HuffmanPipeline::ReadStage read = [&](PipelineChunk& chunk) {
+        if(!headerRead) {
+            headerRead = true;
+            bytesRead += readStreamBytes(input, chunk.data, CONTAINER_HEADER_SIZE);
+            chunk.last = chunk.data.size() < CONTAINER_HEADER_SIZE;
+        }
+        else {
+            while(!chunk.last && chunk.data.size() < chunkSize) {
+                size_t headerStart = chunk.data.size();
+                size_t got = readStreamBytes(input, chunk.data, BLOCK_HEADER_SIZE);
+                bytesRead += got;
+
+                if(got < BLOCK_HEADER_SIZE) {
+                    chunk.last = true;
+                    break;
+                }
+
+                uint64_t payloadBits = readLittleEndian(chunk.data.data() + headerStart + 5, 8);
+                uint64_t payloadBytes = payloadBits / 8 + (payloadBits % 8 != 0 ? 1 : 0);
+
+                while(payloadBytes > 0 && !chunk.last) {
+                    size_t piece = size_t(min(payloadBytes, uint64_t(PIPELINE_READ_PIECE)));
+                    got = readStreamBytes(input, chunk.data, piece);
+                    bytesRead += got;
+                    payloadBytes -= got;
+                    chunk.last = got < piece;
+                }
+            }
+        }
+
+        if(input.bad()) {
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, bytesRead);
+        }
+        return huffmanSuccess();
+    };
+
+    HuffmanPipeline::CodeStage code = [&](const PipelineChunk& in, PipelineChunk& out) {
+        HuffmanResult result;
+
+        if(containerOffset == 0) {
+            result = compressor.startDecompressing(in.data, transforms);
+        }
+        else {
+            result = compressor.decompressBlocks(in.data, transforms, out.data, containerOffset);
+        }
+
+        containerOffset += in.data.size();
+        return result;
+    };
+
+    HuffmanResult result = HuffmanPipeline(depth).run(read, code, streamWriteStage(output, written));
+    if(!result.ok()) {
+        return result;
+    }
+    return huffmanSuccess(written, uint64_t(written) * 8);
+}
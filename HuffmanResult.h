@@ -0,0 +1,78 @@
+/*
+    Purpose: Define the status codes and result type returned by the non-throwing encode and decode
+        methods. Instead of printing from inside the library and handing back a sentinel string, each
+        call reports what went wrong and the byte offset in its input where it happened, so that the
+        caller decides how (and whether) to report it.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Creating the status codes that the encode and decode methods can return
+enum HuffmanStatus {
+    // The whole message was processed
+    HUFFMAN_SUCCESS = 0,
+
+    // A character in the message (or a character decoded from the bits) is not in the alphabet
+    HUFFMAN_INVALID_CHARACTER,
+
+    // The encoded message contains something other than a '0' or a '1'
+    HUFFMAN_INVALID_BIT,
+
+    // The encoded message ends in the middle of a path or an eight bit character
+    HUFFMAN_TRUNCATED_MESSAGE,
+
+    // The caller's output buffer is too small, or the caller's sink would not take any more
+    HUFFMAN_OUTPUT_FULL,
+
+    // A container or block header is damaged, or asks for something this build can't do
+    HUFFMAN_INVALID_HEADER
+};
+
+// Creating the result type. Along with the status, we keep the offset in the input of the first bad
+//      symbol, which is only meaningful when the status is not HUFFMAN_SUCCESS. The offset is in bytes,
+//      except for packed bit input, where it is in bits. The calls that write into a caller's buffer or
+//      sink also report how many bytes and bits they wrote
+struct HuffmanResult {
+    HuffmanStatus status;
+    size_t errorOffset;
+    size_t bytesWritten;
+    uint64_t bitsWritten;
+
+    // Function that tells the caller whether the operation finished without an error
+    bool ok() const noexcept {
+        return status == HUFFMAN_SUCCESS;
+    }
+};
+
+// Helper functions to build results, so the coders don't have to spell out every member each time
+inline HuffmanResult huffmanSuccess() noexcept {
+    return HuffmanResult{HUFFMAN_SUCCESS, 0, 0, 0};
+}
+
+inline HuffmanResult huffmanSuccess(size_t bytesWritten, uint64_t bitsWritten) noexcept {
+    return HuffmanResult{HUFFMAN_SUCCESS, 0, bytesWritten, bitsWritten};
+}
+
+inline HuffmanResult huffmanFailure(HuffmanStatus status, size_t errorOffset) noexcept {
+    return HuffmanResult{status, errorOffset, 0, 0};
+}
+
+// Function that returns a readable description of a status, in the same wording as our exception messages
+inline const char* describeHuffmanStatus(HuffmanStatus status) noexcept {
+    switch(status) {
+        case HUFFMAN_SUCCESS:
+            return "Success";
+        case HUFFMAN_INVALID_CHARACTER:
+            return "Invalid Character In Message";
+        case HUFFMAN_INVALID_BIT:
+            return "Invalid Bit In Encoded Message";
+        case HUFFMAN_TRUNCATED_MESSAGE:
+            return "Encoded Message Ends Unexpectedly";
+        case HUFFMAN_OUTPUT_FULL:
+            return "Output Buffer Is Full";
+        case HUFFMAN_INVALID_HEADER:
+            return "Invalid Container Header";
+    }
+    return "Unknown Error";
+}
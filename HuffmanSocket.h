@@ -0,0 +1,319 @@
+/*
+    Purpose: Carry encode and decode requests between huffmand and its clients over a Unix domain socket.
+        Everything on the socket is a frame: a one-byte type, the length of the rest as four little-endian
+        bytes, and then that many bytes. A request is an ENCODE frame holding the block mode and the transform
+        flags, or an empty DECODE frame, then any number of DATA frames holding the input, and an empty END
+        frame. The reply is DATA frames holding the output, sent while it is being coded, and then a RESULT
+        frame holding the status, the error offset and the number of bytes of output. A connection can carry
+        any number of requests, one after another.
+
+        FrameInputBuffer and FrameOutputBuffer put the DATA frames behind a streambuf, so the streaming coders
+        the command line uses for files can read a request and write its reply.
+*/
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "HuffmanContainer.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the socket huffmand listens on when it isn't given one
+const string DEFAULT_DAEMON_SOCKET = "/tmp/huffmand.sock";
+
+// Creating the size of a frame header, the most bytes a DATA frame can hold, and the sizes of the ENCODE and
+//      RESULT frames
+const size_t FRAME_HEADER_SIZE = 5;
+const size_t MAX_FRAME_LENGTH = size_t(1) << 20;
+const size_t ENCODE_FRAME_LENGTH = 2;
+const size_t RESULT_FRAME_LENGTH = 17;
+
+// Creating the kinds of frame
+enum HuffmanFrameType {
+    // Starts a request to compress the input. Holds the block mode and then the TRANSFORM_ flags
+    FRAME_ENCODE = 1,
+
+    // Starts a request to decompress the input, which is a container. Holds nothing
+    FRAME_DECODE = 2,
+
+    // Holds a piece of the input of a request, or of the output of a reply
+    FRAME_DATA = 3,
+
+    // Ends the input of a request. Holds nothing
+    FRAME_END = 4,
+
+    // Ends a reply. Holds the status, then the error offset and the bytes of output as eight bytes each
+    FRAME_RESULT = 5
+};
+
+// Function that fills in the address of the socket at the path, returning false if the path is too long for one
+inline bool makeSocketAddress(const string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if(path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+
+    memcpy(address.sun_path, path.data(), path.size());
+    return true;
+}
+
+// Function that sends every byte the vectors point at, returning false if the socket fails. MSG_NOSIGNAL keeps a
+//      peer that has gone away from killing us with SIGPIPE
+inline bool sendVectors(int fd, iovec* vectors, int count) {
+    while(count > 0) {
+        msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = vectors;
+        message.msg_iovlen = size_t(count);
+
+        ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if(sent < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        // Stepping past what was sent, which may end part way into a vector
+        size_t remaining = size_t(sent);
+        while(count > 0 && remaining >= vectors->iov_len) {
+            remaining -= vectors->iov_len;
+            vectors++;
+            count--;
+        }
+        if(count > 0) {
+            vectors->iov_base = (char*)vectors->iov_base + remaining;
+            vectors->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+// Function that sends one frame, with its header and payload in a single call
+inline bool sendFrame(int fd, HuffmanFrameType type, const char* payload, size_t length) {
+    string header;
+    header.push_back(char(type));
+    appendLittleEndian(header, length, 4);
+
+    iovec vectors[2] = {{&header[0], header.size()}, {(void*)payload, length}};
+    return sendVectors(fd, vectors, length > 0 ? 2 : 1);
+}
+
+// Function that receives exactly the given number of bytes, returning false if the socket fails or is closed first
+inline bool receiveBytes(int fd, char* data, size_t length) {
+    while(length > 0) {
+        ssize_t got = recv(fd, data, length, 0);
+        if(got < 0 && errno == EINTR) {
+            continue;
+        }
+        if(got <= 0) {
+            return false;
+        }
+
+        data += got;
+        length -= size_t(got);
+    }
+    return true;
+}
+
+// Function that receives the header of the next frame
+inline bool receiveFrameHeader(int fd, uint8_t& type, uint32_t& length) {
+    char header[FRAME_HEADER_SIZE];
+
+    if(!receiveBytes(fd, header, FRAME_HEADER_SIZE)) {
+        return false;
+    }
+
+    type = uint8_t(header[0]);
+    length = uint32_t(readLittleEndian(header + 1, 4));
+    return true;
+}
+
+// Function that writes a result as the payload of a RESULT frame
+inline string resultPayload(const HuffmanResult& result) {
+    string payload;
+    payload.push_back(char(result.status));
+    appendLittleEndian(payload, result.errorOffset, 8);
+    appendLittleEndian(payload, result.bytesWritten, 8);
+    return payload;
+}
+
+// Function that reads a result out of the payload of a RESULT frame, returning false for a status we don't know
+inline bool readResultPayload(const string& payload, HuffmanResult& result) {
+    if(payload.size() != RESULT_FRAME_LENGTH || uint8_t(payload[0]) > HUFFMAN_INVALID_HEADER) {
+        return false;
+    }
+
+    result.status = HuffmanStatus(uint8_t(payload[0]));
+    result.errorOffset = size_t(readLittleEndian(payload.data() + 1, 8));
+    result.bytesWritten = size_t(readLittleEndian(payload.data() + 9, 8));
+    result.bitsWritten = uint64_t(result.bytesWritten) * 8;
+    return true;
+}
+
+// Creating the buffer that reads the DATA frames on a socket as one stream, which ends at a frame of the given
+//      type. A socket that fails or closes, or a frame of any other type, makes the stream bad
+class FrameInputBuffer : public streambuf {
+private:
+    int fd;
+    HuffmanFrameType endType;
+    unique_ptr<char[]> buffer;
+    string endPayload;
+    bool ended;
+    bool broken;
+
+protected:
+    // Function that the stream calls once it has used up the frame it had
+    int_type underflow() override {
+        if(gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        if(this->ended) {
+            return traits_type::eof();
+        }
+
+        while(!this->broken) {
+            uint8_t type = 0;
+            uint32_t length = 0;
+
+            if(!receiveFrameHeader(this->fd, type, length) || length > MAX_FRAME_LENGTH || (type != FRAME_DATA && type != this->endType)) {
+                this->broken = true;
+                break;
+            }
+
+            if(type == this->endType) {
+                this->endPayload.resize(length);
+                if(length > 0 && !receiveBytes(this->fd, &this->endPayload[0], length)) {
+                    this->broken = true;
+                    break;
+                }
+
+                this->ended = true;
+                setg(nullptr, nullptr, nullptr);
+                return traits_type::eof();
+            }
+
+            if(!receiveBytes(this->fd, this->buffer.get(), length)) {
+                this->broken = true;
+                break;
+            }
+
+            // An empty DATA frame is allowed, and just skipped
+            if(length > 0) {
+                setg(this->buffer.get(), this->buffer.get(), this->buffer.get() + length);
+                return traits_type::to_int_type(*gptr());
+            }
+        }
+
+        // Throwing is how a streambuf makes its stream bad
+        throw ios_base::failure("Error When Reading Frame");
+    }
+
+public:
+    // Constructor that takes the connected socket and the type of the frame that ends the stream
+    FrameInputBuffer(int fd, HuffmanFrameType endType)
+        : fd(fd), endType(endType), buffer(make_unique<char[]>(MAX_FRAME_LENGTH)), ended(false), broken(false) {}
+
+    // Function that reads and drops the rest of the stream, so the socket is ready for the next frame after it.
+    //      Returns false if the socket can't be used any more
+    bool finish() {
+        while(!this->ended && !this->broken) {
+            setg(nullptr, nullptr, nullptr);
+            try {
+                underflow();
+            }
+            catch(const ios_base::failure&) {
+            }
+        }
+        return !this->broken;
+    }
+
+    // Function that returns the payload of the frame the stream ended at
+    const string& getEndPayload() const noexcept {
+        return this->endPayload;
+    }
+};
+
+// Creating the buffer that writes a stream to a socket as DATA frames, a frame each time the buffer fills or the
+//      stream is flushed. A socket that fails makes the stream bad
+class FrameOutputBuffer : public streambuf {
+private:
+    int fd;
+    unique_ptr<char[]> buffer;
+    bool broken;
+
+    // Function that sends what is in the buffer as a frame, and starts filling it again
+    bool sendBuffer() {
+        size_t length = size_t(pptr() - pbase());
+
+        if(length > 0 && !this->broken && !sendFrame(this->fd, FRAME_DATA, pbase(), length)) {
+            this->broken = true;
+        }
+
+        setp(this->buffer.get(), this->buffer.get() + MAX_FRAME_LENGTH);
+        return !this->broken;
+    }
+
+protected:
+    // Function that the stream calls when the buffer is full
+    int_type overflow(int_type character) override {
+        if(!sendBuffer()) {
+            return traits_type::eof();
+        }
+
+        if(!traits_type::eq_int_type(character, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(character);
+            pbump(1);
+        }
+        return traits_type::not_eof(character);
+    }
+
+    // Function that the stream calls to write many characters at once. Anything as big as the buffer is sent
+    //      straight from the caller's memory, instead of being copied into the buffer a piece at a time
+    streamsize xsputn(const char* data, streamsize count) override {
+        if(size_t(count) < MAX_FRAME_LENGTH) {
+            return streambuf::xsputn(data, count);
+        }
+
+        if(!sendBuffer()) {
+            return 0;
+        }
+
+        for(streamsize sent = 0; sent < count; ) {
+            size_t length = min(size_t(count - sent), MAX_FRAME_LENGTH);
+
+            if(!sendFrame(this->fd, FRAME_DATA, data + sent, length)) {
+                this->broken = true;
+                return sent;
+            }
+            sent += streamsize(length);
+        }
+        return count;
+    }
+
+    // Function that the stream calls when it is flushed
+    int sync() override {
+        return sendBuffer() ? 0 : -1;
+    }
+
+public:
+    // Constructor that takes the connected socket
+    explicit FrameOutputBuffer(int fd) : fd(fd), buffer(make_unique<char[]>(MAX_FRAME_LENGTH)), broken(false) {
+        setp(this->buffer.get(), this->buffer.get() + MAX_FRAME_LENGTH);
+    }
+
+    // Function that tells us whether the socket has failed, so nothing more can be sent on it
+    bool isBroken() const noexcept {
+        return this->broken;
+    }
+};
@@ -0,0 +1,228 @@
+/*
+    Purpose: Keep a fixed set of worker threads that run tasks, for the coders whose blocks can be coded
+        independently of each other, and for the batch commands that code many files at once. Every worker
+        has a queue of its own. A task submitted from inside a task goes on the back of that worker's queue,
+        and a worker takes its next task from the back of its own queue, so the blocks of a file tend to stay
+        on the thread that read it. A worker whose queue is empty steals the oldest task from the front of
+        another's, so a few huge files and many small ones even out over all the workers.
+
+        parallelFor hands out the indices of a loop to the workers and to the calling thread alike, and returns
+        once every index has been run, so the caller never waits idle and a parallelFor called from inside a
+        task can't deadlock the pool. The workers are only started when the first task is submitted, so a pool
+        made in case a file has Burrows-Wheeler blocks costs nothing when it has none.
+*/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Creating the thread pool class
+class HuffmanThreadPool {
+private:
+    // Creating the queue each worker owns, with the lock that guards it
+    struct WorkerQueue {
+        deque<function<void()>> tasks;
+        mutex queueMutex;
+    };
+
+    // Creating the workers and their queues, the number of tasks waiting in all of the queues, the worker the next
+    //      task from outside the pool goes to, the lock and signal idle workers sleep on, and whether the workers have
+    //      been started
+    vector<thread> workers;
+    vector<unique_ptr<WorkerQueue>> queues;
+    atomic<size_t> waitingTasks;
+    atomic<size_t> nextQueue;
+    mutex sleepMutex;
+    condition_variable sleepSignal;
+    bool stopping;
+    once_flag startFlag;
+
+    // Creating the pool and the place in it of the worker running on this thread, if there is one
+    static inline thread_local const HuffmanThreadPool* currentPool = nullptr;
+    static inline thread_local size_t currentWorker = 0;
+
+    // Creating the shared state of one parallelFor. The helper tasks hold on to it, so one that only gets to run
+    //      after the loop is over still has something to look at
+    struct LoopState {
+        function<void(size_t)> body;
+        size_t count;
+        atomic<size_t> nextIndex;
+        size_t finished;
+        mutex finishedMutex;
+        condition_variable finishedSignal;
+
+        LoopState(const function<void(size_t)>& body, size_t count) : body(body), count(count), nextIndex(0), finished(0) {}
+    };
+
+    // Function that runs indices of the loop until there are none left to hand out
+    static void runLoop(LoopState& state) {
+        size_t ran = 0;
+
+        for(size_t i = state.nextIndex++; i < state.count; i = state.nextIndex++) {
+            state.body(i);
+            ran++;
+        }
+
+        if(ran > 0) {
+            lock_guard<mutex> lock(state.finishedMutex);
+            state.finished += ran;
+            if(state.finished == state.count) {
+                state.finishedSignal.notify_all();
+            }
+        }
+    }
+
+    // Function that takes a task for the given worker: the newest one in its own queue, or else the oldest one in
+    //      the first other queue that has any. Returns false if every queue is empty
+    bool takeTask(size_t worker, function<void()>& task) {
+        size_t queueCount = this->queues.size();
+
+        for(size_t step = 0; step < queueCount; step++) {
+            WorkerQueue& queue = *this->queues[(worker + step) % queueCount];
+            lock_guard<mutex> lock(queue.queueMutex);
+
+            if(queue.tasks.empty()) {
+                continue;
+            }
+
+            if(step == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+
+            this->waitingTasks--;
+            return true;
+        }
+
+        return false;
+    }
+
+    // Function that each worker runs: take a task, run it, and sleep once there are none left anywhere
+    void workerLoop(size_t worker) {
+        currentPool = this;
+        currentWorker = worker;
+
+        while(true) {
+            function<void()> task;
+
+            if(takeTask(worker, task)) {
+                task();
+                continue;
+            }
+
+            unique_lock<mutex> lock(this->sleepMutex);
+            this->sleepSignal.wait(lock, [this] { return this->stopping || this->waitingTasks > 0; });
+
+            if(this->stopping && this->waitingTasks == 0) {
+                return;
+            }
+        }
+    }
+
+    // Function that starts the workers the first time it is called. A failed start is picked up where it stopped
+    //      by the next call
+    void startWorkers() {
+        call_once(this->startFlag, [this] {
+            for(size_t i = this->workers.size(); i < this->queues.size(); i++) {
+                this->workers.emplace_back(&HuffmanThreadPool::workerLoop, this, i);
+            }
+        });
+    }
+
+public:
+    // Constructor that makes a queue for each worker, one per hardware thread unless the caller says otherwise. The
+    //      workers themselves are started by the first submit
+    explicit HuffmanThreadPool(size_t threadCount = thread::hardware_concurrency()) : waitingTasks(0), nextQueue(0), stopping(false) {
+        if(threadCount == 0) {
+            threadCount = 1;
+        }
+
+        for(size_t i = 0; i < threadCount; i++) {
+            this->queues.push_back(make_unique<WorkerQueue>());
+        }
+    }
+
+    // The workers point back at the pool, so it can be neither copied nor moved
+    HuffmanThreadPool(const HuffmanThreadPool&) = delete;
+    HuffmanThreadPool& operator=(const HuffmanThreadPool&) = delete;
+
+    // Destructor that lets the workers finish the tasks already queued, and then joins them
+    ~HuffmanThreadPool() {
+        {
+            lock_guard<mutex> lock(this->sleepMutex);
+            this->stopping = true;
+        }
+        this->sleepSignal.notify_all();
+
+        for(size_t i = 0; i < this->workers.size(); i++) {
+            this->workers[i].join();
+        }
+    }
+
+    // Function that returns the number of worker threads, whether or not they have been started yet
+    size_t getThreadCount() const noexcept {
+        return this->queues.size();
+    }
+
+    // Function that returns the place in the pool of the worker running on this thread, or the number of workers
+    //      for any thread that isn't one of ours, so callers can keep something for each thread in a vector one
+    //      longer than the pool
+    size_t getCurrentThreadIndex() const noexcept {
+        return currentPool == this ? currentWorker : this->queues.size();
+    }
+
+    // Function that queues a task. One of our workers queues it for itself, and anyone else hands tasks out to the
+    //      workers in turn
+    void submit(function<void()> task) {
+        startWorkers();
+
+        size_t worker = getCurrentThreadIndex();
+        if(worker == this->queues.size()) {
+            worker = this->nextQueue++ % this->queues.size();
+        }
+
+        // Counting the task under the sleep lock, so a worker deciding to sleep can't miss it, and before it is
+        //      queued, so a worker can't take it before it is counted
+        {
+            lock_guard<mutex> lock(this->sleepMutex);
+            this->waitingTasks++;
+        }
+
+        {
+            WorkerQueue& queue = *this->queues[worker];
+            lock_guard<mutex> lock(queue.queueMutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        this->sleepSignal.notify_one();
+    }
+
+    // Function that runs body(i) for every i below count, spread over the workers and the calling thread, and
+    //      waits for all of them to finish
+    void parallelFor(size_t count, const function<void(size_t)>& body) {
+        if(count == 0) {
+            return;
+        }
+
+        shared_ptr<LoopState> state = make_shared<LoopState>(body, count);
+        size_t helpers = min(count - 1, this->queues.size());
+
+        for(size_t i = 0; i < helpers; i++) {
+            submit([state] { runLoop(*state); });
+        }
+
+        runLoop(*state);
+
+        unique_lock<mutex> lock(state->finishedMutex);
+        state->finishedSignal.wait(lock, [&state] { return state->finished == state->count; });
+    }
+};
@@ -0,0 +1,186 @@
+/*
+    Purpose: Provide the optional transform stages that run before the coders: run-length encoding of runs,
+        and move-to-front. Both turn a message over an alphabet into another message over the same
+        alphabet, so whatever comes out can be coded by any of the coders unchanged. Counts and ranks are
+        written as the alphabet's characters: a value of v is the alphabet's v-th character.
+
+        The stages are chosen with flags, which the container keeps in its header. When both are on, runs
+        are shortened first and move-to-front runs on what is left; decoding undoes them in reverse.
+*/
+#pragma once
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "HuffmanAlphabet.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the flags for each transform stage
+const uint8_t TRANSFORM_NONE = 0;
+const uint8_t TRANSFORM_RLE = 1;
+const uint8_t TRANSFORM_MTF = 2;
+const uint8_t TRANSFORM_ALL = TRANSFORM_RLE | TRANSFORM_MTF;
+
+// Creating the run length at which the run-length stage steps in. After this many equal characters in a row,
+//      the next character is a count of how many more of them followed
+const int RUN_LENGTH_THRESHOLD = 4;
+
+// Creating the alphabet the stages work over: its characters, and the lookup from byte value to character number
+struct TransformAlphabet {
+    string symbols;
+    int symbolIndex[256];
+    AlphabetBitmap alphabetBitmap;
+
+    explicit TransformAlphabet(const string& alphabet) {
+        this->symbols = parseAlphabet(alphabet);
+        buildSymbolIndex(this->symbols, this->symbolIndex, this->alphabetBitmap);
+    }
+};
+
+// Function that shortens runs. Every run of at least RUN_LENGTH_THRESHOLD equal characters is written as that
+//      many characters followed by a count of the rest, as long as the count fits the alphabet. The message has
+//      to be checked against the alphabet first
+inline void runLengthEncode(string_view input, const TransformAlphabet& alphabet, string& output) {
+    size_t maxExtra = alphabet.symbols.size() - 1;
+    size_t i = 0;
+
+    while(i < input.size()) {
+        char character = input[i];
+        size_t run = 1;
+        while(i + run < input.size() && input[i + run] == character && run < RUN_LENGTH_THRESHOLD + maxExtra) {
+            run++;
+        }
+
+        if(run < (size_t)RUN_LENGTH_THRESHOLD) {
+            output.append(run, character);
+        }
+        else {
+            output.append(RUN_LENGTH_THRESHOLD, character);
+            output.push_back(alphabet.symbols[run - RUN_LENGTH_THRESHOLD]);
+        }
+        i += run;
+    }
+}
+
+// Function that undoes runLengthEncode. A run that stops right before its count means the input was cut short
+inline HuffmanResult runLengthDecode(string_view input, const TransformAlphabet& alphabet, string& output) {
+    int runLength = 0;
+    char previous = 0;
+
+    for(size_t i = 0; i < input.size(); i++) {
+        char character = input[i];
+        int index = alphabet.symbolIndex[(unsigned char)character];
+
+        if(index == -1) {
+            return huffmanFailure(HUFFMAN_INVALID_CHARACTER, i);
+        }
+
+        // After a full run, this character is the count of the rest of the run
+        if(runLength == RUN_LENGTH_THRESHOLD) {
+            output.append(index, previous);
+            runLength = 0;
+            continue;
+        }
+
+        runLength = (runLength != 0 && character == previous) ? runLength + 1 : 1;
+        previous = character;
+        output.push_back(character);
+    }
+
+    if(runLength == RUN_LENGTH_THRESHOLD) {
+        return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, input.size());
+    }
+
+    return huffmanSuccess(output.size(), uint64_t(output.size()) * 8);
+}
+
+// Function that replaces every character with its place in a list of the alphabet's characters, and then moves
+//      it to the front of the list. Characters that come up again soon get small places. The message has to be
+//      checked against the alphabet first
+inline void moveToFrontEncode(string_view input, const TransformAlphabet& alphabet, string& output) {
+    unsigned char order[256];
+    size_t symbolCount = alphabet.symbols.size();
+
+    for(size_t i = 0; i < symbolCount; i++) {
+        order[i] = (unsigned char)i;
+    }
+
+    output.reserve(output.size() + input.size());
+
+    for(size_t i = 0; i < input.size(); i++) {
+        unsigned char symbol = (unsigned char)alphabet.symbolIndex[(unsigned char)input[i]];
+        unsigned char* found = (unsigned char*)memchr(order, symbol, symbolCount);
+        size_t rank = found - order;
+
+        memmove(order + 1, order, rank);
+        order[0] = symbol;
+        output.push_back(alphabet.symbols[rank]);
+    }
+}
+
+// Function that undoes moveToFrontEncode
+inline HuffmanResult moveToFrontDecode(string_view input, const TransformAlphabet& alphabet, string& output) {
+    unsigned char order[256];
+    size_t symbolCount = alphabet.symbols.size();
+
+    for(size_t i = 0; i < symbolCount; i++) {
+        order[i] = (unsigned char)i;
+    }
+
+    output.reserve(output.size() + input.size());
+
+    for(size_t i = 0; i < input.size(); i++) {
+        int rank = alphabet.symbolIndex[(unsigned char)input[i]];
+
+        if(rank == -1) {
+            return huffmanFailure(HUFFMAN_INVALID_CHARACTER, i);
+        }
+
+        unsigned char symbol = order[rank];
+        memmove(order + 1, order, rank);
+        order[0] = symbol;
+        output.push_back(alphabet.symbols[symbol]);
+    }
+
+    return huffmanSuccess(output.size(), uint64_t(output.size()) * 8);
+}
+
+// Function that runs the stages chosen by the flags over a message that was checked against the alphabet
+inline void applyTransforms(uint8_t transforms, string_view input, const TransformAlphabet& alphabet, string& output) {
+    if(transforms == TRANSFORM_ALL) {
+        string shortened;
+        runLengthEncode(input, alphabet, shortened);
+        moveToFrontEncode(shortened, alphabet, output);
+    }
+    else if(transforms == TRANSFORM_RLE) {
+        runLengthEncode(input, alphabet, output);
+    }
+    else if(transforms == TRANSFORM_MTF) {
+        moveToFrontEncode(input, alphabet, output);
+    }
+    else {
+        output.append(input.data(), input.size());
+    }
+}
+
+// Function that undoes the stages chosen by the flags, in reverse order, appending the result to the output
+inline HuffmanResult undoTransforms(uint8_t transforms, string_view input, const TransformAlphabet& alphabet, string& output) {
+    if(transforms == TRANSFORM_ALL) {
+        string shortened;
+        HuffmanResult result = moveToFrontDecode(input, alphabet, shortened);
+
+        if(!result.ok()) {
+            return result;
+        }
+        return runLengthDecode(shortened, alphabet, output);
+    }
+    if(transforms == TRANSFORM_RLE) {
+        return runLengthDecode(input, alphabet, output);
+    }
+    if(transforms == TRANSFORM_MTF) {
+        return moveToFrontDecode(input, alphabet, output);
+    }
+
+    output.append(input.data(), input.size());
+    return huffmanSuccess(output.size(), uint64_t(output.size()) * 8);
+}
@@ -0,0 +1,126 @@
+/*
+    Purpose: Keep ready-built AdaptiveHuffmanTree objects around, keyed by their alphabet, so code that
+        handles many small messages can borrow a tree instead of constructing one (and parsing its
+        alphabet) for every message. A borrowed tree comes back through its lease, is reset, and waits for
+        the next caller. The pool can be shared between threads.
+*/
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "AdaptiveHuffmanTree.h"
+
+// Creating the default number of idle trees we keep for each alphabet. Trees returned beyond that are freed
+const size_t DEFAULT_MAX_IDLE_TREES = 64;
+
+// Creating the tree pool class
+class AdaptiveHuffmanTreePool {
+private:
+    // Creating the lock that guards the idle lists
+    mutex poolMutex;
+
+    // Creating the idle trees for each alphabet string. Every tree in here has already been reset
+    unordered_map<string, vector<unique_ptr<AdaptiveHuffmanTree>>> idleTrees;
+
+    // Creating the limit on how many idle trees we keep for one alphabet
+    size_t maxIdlePerAlphabet;
+
+    // Function that takes back a tree from a lease. The reset happens before we take the lock, so the lock is
+    //      only held long enough to push a pointer
+    void release(const string& alphabet, unique_ptr<AdaptiveHuffmanTree> tree) {
+        tree->reset();
+
+        lock_guard<mutex> lock(this->poolMutex);
+        vector<unique_ptr<AdaptiveHuffmanTree>>& idle = this->idleTrees[alphabet];
+
+        if(idle.size() < this->maxIdlePerAlphabet) {
+            idle.push_back(std::move(tree));
+        }
+    }
+
+public:
+    // Creating the lease that a borrowed tree comes in. It acts like a pointer to the tree, and hands the tree
+    //      back to the pool when it goes out of scope. Leases can be moved but not copied
+    class Lease {
+    private:
+        AdaptiveHuffmanTreePool* pool;
+        string alphabet;
+        unique_ptr<AdaptiveHuffmanTree> tree;
+
+    public:
+        Lease(AdaptiveHuffmanTreePool* pool, const string& alphabet, unique_ptr<AdaptiveHuffmanTree> tree)
+            : pool(pool), alphabet(alphabet), tree(std::move(tree)) {}
+
+        Lease(Lease&& other) noexcept = default;
+        Lease& operator=(Lease&& other) noexcept {
+            if(this != &other) {
+                giveBack();
+                pool = other.pool;
+                alphabet = std::move(other.alphabet);
+                tree = std::move(other.tree);
+            }
+            return *this;
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease() {
+            giveBack();
+        }
+
+        // Function that returns the tree to the pool early
+        void giveBack() {
+            if(tree != nullptr) {
+                pool->release(alphabet, std::move(tree));
+            }
+        }
+
+        AdaptiveHuffmanTree* operator->() const noexcept {
+            return tree.get();
+        }
+
+        AdaptiveHuffmanTree& operator*() const noexcept {
+            return *tree;
+        }
+    };
+
+    // Constructor for the pool, with the limit on idle trees per alphabet
+    explicit AdaptiveHuffmanTreePool(size_t maxIdlePerAlphabet = DEFAULT_MAX_IDLE_TREES)
+        : maxIdlePerAlphabet(maxIdlePerAlphabet) {}
+
+    // Function that borrows a tree for the given alphabet. An idle tree is used when there is one; otherwise a
+    //      new tree is built, outside the lock, so other threads are not held up by the alphabet parsing
+    Lease acquire(const string& alphabet) {
+        {
+            lock_guard<mutex> lock(this->poolMutex);
+            auto found = this->idleTrees.find(alphabet);
+
+            if(found != this->idleTrees.end() && !found->second.empty()) {
+                unique_ptr<AdaptiveHuffmanTree> tree = std::move(found->second.back());
+                found->second.pop_back();
+                return Lease(this, alphabet, std::move(tree));
+            }
+        }
+
+        return Lease(this, alphabet, unique_ptr<AdaptiveHuffmanTree>(new AdaptiveHuffmanTree(alphabet)));
+    }
+
+    // Function that builds count trees for an alphabet ahead of time, so the first requests don't pay for them
+    void preload(const string& alphabet, size_t count) {
+        vector<unique_ptr<AdaptiveHuffmanTree>> built;
+        for(size_t i = 0; i < count; i++) {
+            built.push_back(unique_ptr<AdaptiveHuffmanTree>(new AdaptiveHuffmanTree(alphabet)));
+        }
+
+        lock_guard<mutex> lock(this->poolMutex);
+        vector<unique_ptr<AdaptiveHuffmanTree>>& idle = this->idleTrees[alphabet];
+
+        for(size_t i = 0; i < built.size() && idle.size() < this->maxIdlePerAlphabet; i++) {
+            idle.push_back(std::move(built[i]));
+        }
+    }
+};
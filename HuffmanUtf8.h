@@ -0,0 +1,391 @@
+/*
+    Purpose: Read and write UTF-8 for the code point tree. Markup, logs and mixed-language text have long
+        runs of ASCII between their other characters, and Chinese, Japanese and Korean text has long runs of
+        three byte characters, so both kinds of run are decoded several characters at a time: ASCII sixteen
+        (SSE2) or thirty-two (AVX2) bytes per step, and three byte characters four (SSSE3) or eight (AVX2) per
+        step, picking the widest version the processor supports at run time. Two and four byte characters, and
+        the ends of runs, go through a scalar decoder. Every version rejects overlong forms, surrogates and
+        anything past U+10FFFF, so the only bytes a code point decodes from are the bytes it encodes back to.
+        Machines and compilers without those instructions decode a character at a time and give the same
+        answers. Decoding is a small part of coding a block, which the tree updates take most of.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AlphabetScanner.h"
+#include "HuffmanAlphabet.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the largest Unicode code point
+const uint32_t UTF8_MAX_CODE_POINT = 0x10FFFF;
+
+// Function that decodes the character at the start of the data into its code point, returning how many bytes it
+//      took, or zero if the bytes aren't a complete, shortest-form UTF-8 character
+inline size_t decodeUtf8Character(const unsigned char* data, size_t length, uint32_t& codePoint) noexcept {
+    if(length == 0) {
+        return 0;
+    }
+
+    unsigned char lead = data[0];
+
+    if(lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    }
+
+    // Working out the length from the lead byte, along with the range the second byte has to be in. Narrowing
+    //      that range is what rules out overlong forms, surrogates, and code points past U+10FFFF
+    size_t size;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+
+    if(lead >= 0xC2 && lead <= 0xDF) {
+        size = 2;
+        codePoint = lead & 0x1F;
+    }
+    else if(lead >= 0xE0 && lead <= 0xEF) {
+        size = 3;
+        codePoint = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    }
+    else if(lead >= 0xF0 && lead <= 0xF4) {
+        size = 4;
+        codePoint = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    }
+    else {
+        return 0;
+    }
+
+    if(length < size || data[1] < low || data[1] > high) {
+        return 0;
+    }
+
+    for(size_t i = 1; i < size; i++) {
+        if((data[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (data[i] & 0x3F);
+    }
+
+    return size;
+}
+
+// Function that appends the UTF-8 bytes of a code point onto the end of the string
+inline void appendUtf8(uint32_t codePoint, string& text) {
+    if(codePoint < 0x80) {
+        text.push_back(char(codePoint));
+    }
+    else if(codePoint < 0x800) {
+        text.push_back(char(0xC0 | (codePoint >> 6)));
+        text.push_back(char(0x80 | (codePoint & 0x3F)));
+    }
+    else if(codePoint < 0x10000) {
+        text.push_back(char(0xE0 | (codePoint >> 12)));
+        text.push_back(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        text.push_back(char(0x80 | (codePoint & 0x3F)));
+    }
+    else {
+        text.push_back(char(0xF0 | (codePoint >> 18)));
+        text.push_back(char(0x80 | ((codePoint >> 12) & 0x3F)));
+        text.push_back(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        text.push_back(char(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// Function that widens the run of ASCII bytes at the start of the data into code points, returning how long
+//      the run was. This is the plain version every other version has to agree with
+inline size_t widenAsciiRunScalar(const unsigned char* data, size_t length, uint32_t* codePoints) noexcept {
+    size_t i = 0;
+
+    while(i < length && data[i] < 0x80) {
+        codePoints[i] = data[i];
+        i++;
+    }
+
+    return i;
+}
+
+#ifdef HUFFMAN_HAVE_X86_SIMD
+// SSE2 version, sixteen bytes per step. The bytes are widened by interleaving them with zeros twice
+__attribute__((target("sse2")))
+inline size_t widenAsciiRunSse2(const unsigned char* data, size_t length, uint32_t* codePoints) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for(; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(data + i));
+
+        // The top bit of every byte outside ASCII is set, which is all movemask looks at
+        if(_mm_movemask_epi8(bytes) != 0) {
+            break;
+        }
+
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        _mm_storeu_si128((__m128i*)(codePoints + i), _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128((__m128i*)(codePoints + i + 4), _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128((__m128i*)(codePoints + i + 8), _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128((__m128i*)(codePoints + i + 12), _mm_unpackhi_epi16(high, zero));
+    }
+
+    return i + widenAsciiRunScalar(data + i, length - i, codePoints + i);
+}
+
+// AVX2 version, thirty-two bytes per step, widening eight bytes at a time straight to 32 bits
+__attribute__((target("avx2")))
+inline size_t widenAsciiRunAvx2(const unsigned char* data, size_t length, uint32_t* codePoints) noexcept {
+    size_t i = 0;
+    for(; i + 32 <= length; i += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(data + i));
+
+        if(_mm256_movemask_epi8(bytes) != 0) {
+            break;
+        }
+
+        for(int part = 0; part < 4; part++) {
+            __m128i eight = _mm_loadl_epi64((const __m128i*)(data + i + 8 * part));
+            _mm256_storeu_si256((__m256i*)(codePoints + i + 8 * part), _mm256_cvtepu8_epi32(eight));
+        }
+    }
+
+    return i + widenAsciiRunScalar(data + i, length - i, codePoints + i);
+}
+#endif
+
+// Function that decodes the run of three byte characters at the start of the data into code points, returning how
+//      many characters the run held. This is the plain version every other version has to agree with
+inline size_t widenThreeByteRunScalar(const unsigned char* data, size_t length, uint32_t* codePoints) noexcept {
+    size_t count = 0;
+
+    while(3 * count < length && decodeUtf8Character(data + 3 * count, length - 3 * count, codePoints[count]) == 3) {
+        count++;
+    }
+
+    return count;
+}
+
+#ifdef HUFFMAN_HAVE_X86_SIMD
+// SSSE3 version, four characters (twelve bytes) per step. A shuffle puts the bytes of each character in a 32 bit
+//      lane, lead byte highest, and the lanes are checked and turned into code points together. A lead byte
+//      from E0 to EF with two continuation bytes is a three byte character unless it is overlong, which leaves
+//      it below U+0800, or a surrogate, which leaves it from U+D800 to U+DFFF, so those are the checks
+__attribute__((target("ssse3")))
+inline size_t widenThreeByteRunSsse3(const unsigned char* data, size_t length, uint32_t* codePoints) noexcept {
+    const __m128i gather = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i markerMask = _mm_set1_epi32(0x00F0C0C0);
+    const __m128i markers = _mm_set1_epi32(0x00E08080);
+    const __m128i smallest = _mm_set1_epi32(0x7FF);
+    const __m128i surrogateMask = _mm_set1_epi32(0xF800);
+    const __m128i surrogates = _mm_set1_epi32(0xD800);
+
+    size_t count = 0;
+    for(; 3 * count + 16 <= length; count += 4) {
+        __m128i lanes = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 3 * count)), gather);
+
+        __m128i codePoint = _mm_or_si128(_mm_and_si128(lanes, _mm_set1_epi32(0x3F)),
+                                         _mm_or_si128(_mm_and_si128(_mm_srli_epi32(lanes, 2), _mm_set1_epi32(0xFC0)),
+                                                      _mm_and_si128(_mm_srli_epi32(lanes, 4), _mm_set1_epi32(0xF000))));
+
+        __m128i valid = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(lanes, markerMask), markers), _mm_cmpgt_epi32(codePoint, smallest));
+        valid = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(codePoint, surrogateMask), surrogates), valid);
+
+        if(_mm_movemask_epi8(valid) != 0xFFFF) {
+            break;
+        }
+
+        _mm_storeu_si128((__m128i*)(codePoints + count), codePoint);
+    }
+
+    return count + widenThreeByteRunScalar(data + 3 * count, length - 3 * count, codePoints + count);
+}
+
+// AVX2 version, eight characters (twenty-four bytes) per step. The shuffle only works inside each half of the
+//      register, so the halves are loaded twelve bytes apart
+__attribute__((target("avx2")))
+inline size_t widenThreeByteRunAvx2(const unsigned char* data, size_t length, uint32_t* codePoints) noexcept {
+    const __m256i gather = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                                            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m256i markerMask = _mm256_set1_epi32(0x00F0C0C0);
+    const __m256i markers = _mm256_set1_epi32(0x00E08080);
+    const __m256i smallest = _mm256_set1_epi32(0x7FF);
+    const __m256i surrogateMask = _mm256_set1_epi32(0xF800);
+    const __m256i surrogates = _mm256_set1_epi32(0xD800);
+
+    size_t count = 0;
+    for(; 3 * count + 28 <= length; count += 8) {
+        __m128i low = _mm_loadu_si128((const __m128i*)(data + 3 * count));
+        __m128i high = _mm_loadu_si128((const __m128i*)(data + 3 * count + 12));
+        __m256i lanes = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1), gather);
+
+        __m256i codePoint = _mm256_or_si256(_mm256_and_si256(lanes, _mm256_set1_epi32(0x3F)),
+                                            _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(lanes, 2), _mm256_set1_epi32(0xFC0)),
+                                                            _mm256_and_si256(_mm256_srli_epi32(lanes, 4), _mm256_set1_epi32(0xF000))));
+
+        __m256i valid = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(lanes, markerMask), markers), _mm256_cmpgt_epi32(codePoint, smallest));
+        valid = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(codePoint, surrogateMask), surrogates), valid);
+
+        if(_mm256_movemask_epi8(valid) != -1) {
+            break;
+        }
+
+        _mm256_storeu_si256((__m256i*)(codePoints + count), codePoint);
+    }
+
+    return count + widenThreeByteRunScalar(data + 3 * count, length - 3 * count, codePoints + count);
+}
+#endif
+
+// Creating the types for the functions above, so we only have to pick one of each once
+typedef size_t (*AsciiWidenFunction)(const unsigned char*, size_t, uint32_t*);
+typedef size_t (*ThreeByteWidenFunction)(const unsigned char*, size_t, uint32_t*);
+
+// Function that picks the widest version this processor supports. The choice is made the first time we are
+//      called and then kept
+inline AsciiWidenFunction selectAsciiWidenFunction() noexcept {
+    static const AsciiWidenFunction selected = []() -> AsciiWidenFunction {
+#ifdef HUFFMAN_HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return widenAsciiRunAvx2;
+        }
+        if(__builtin_cpu_supports("sse2")) {
+            return widenAsciiRunSse2;
+        }
+#endif
+        return widenAsciiRunScalar;
+    }();
+
+    return selected;
+}
+
+// Function that picks the widest three byte version this processor supports, the same way
+inline ThreeByteWidenFunction selectThreeByteWidenFunction() noexcept {
+    static const ThreeByteWidenFunction selected = []() -> ThreeByteWidenFunction {
+#ifdef HUFFMAN_HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return widenThreeByteRunAvx2;
+        }
+        if(__builtin_cpu_supports("ssse3")) {
+            return widenThreeByteRunSsse3;
+        }
+#endif
+        return widenThreeByteRunScalar;
+    }();
+
+    return selected;
+}
+
+// Function that decodes UTF-8 text into its code points, appended onto the end of the vector. On failure the
+//      result holds the byte offset of the first byte that doesn't start a valid character, and the vector holds
+//      the code points before it
+inline HuffmanResult decodeUtf8(const char* text, size_t length, vector<uint32_t>& codePoints) {
+    const unsigned char* data = (const unsigned char*)text;
+    AsciiWidenFunction widenAsciiRun = selectAsciiWidenFunction();
+    ThreeByteWidenFunction widenThreeByteRun = selectThreeByteWidenFunction();
+
+    // Making room for the most code points the text could hold, one per byte, and trimming it afterwards
+    size_t start = codePoints.size();
+    codePoints.resize(start + length);
+    uint32_t* output = codePoints.data() + start;
+    size_t produced = 0;
+    size_t i = 0;
+
+    while(i < length) {
+        if(data[i] < 0x80) {
+            size_t run = widenAsciiRun(data + i, length - i, output + produced);
+            i += run;
+            produced += run;
+            continue;
+        }
+
+        // A run that doesn't start with a valid three byte character is left to the scalar decoder below
+        if(data[i] >= 0xE0 && data[i] <= 0xEF) {
+            size_t run = widenThreeByteRun(data + i, length - i, output + produced);
+            i += 3 * run;
+            produced += run;
+
+            if(run > 0) {
+                continue;
+            }
+        }
+
+        size_t size = decodeUtf8Character(data + i, length - i, output[produced]);
+        if(size == 0) {
+            codePoints.resize(start + produced);
+            return huffmanFailure(HUFFMAN_INVALID_CHARACTER, i);
+        }
+
+        i += size;
+        produced++;
+    }
+
+    codePoints.resize(start + produced);
+    return huffmanSuccess();
+}
+
+// Function that returns the byte offset of the character at the given place in valid UTF-8 text, by counting the
+//      bytes that start a character
+inline size_t utf8ByteOffset(string_view text, size_t characterIndex) noexcept {
+    for(size_t i = 0; i < text.size(); i++) {
+        if(((unsigned char)text[i] & 0xC0) != 0x80) {
+            if(characterIndex == 0) {
+                return i;
+            }
+            characterIndex--;
+        }
+    }
+
+    return text.size();
+}
+
+// Function that moves an end offset inside the text back to the start of the character it falls in, so cutting
+//      the text there doesn't split a character. An offset that can't be moved that way is returned as it is
+inline size_t utf8CharacterBoundary(string_view text, size_t end) noexcept {
+    size_t boundary = end;
+
+    while(boundary > 0 && boundary < text.size() && end - boundary < 3 && ((unsigned char)text[boundary] & 0xC0) == 0x80) {
+        boundary--;
+    }
+
+    if(boundary == 0 || (boundary < text.size() && ((unsigned char)text[boundary] & 0xC0) == 0x80)) {
+        return end;
+    }
+    return boundary;
+}
+
+// Function that parses an alphabet string, read as UTF-8, into its code points in the order they first appear.
+//      Backslash escapes are read the way parseAlphabet reads them, and the alphabet stops at the first NULL
+//      character. On failure the result holds the byte offset of the first byte that isn't valid UTF-8
+inline HuffmanResult parseUtf8Alphabet(const string& alphabet, vector<uint32_t>& codePoints) {
+    const unsigned char* data = (const unsigned char*)alphabet.c_str();
+    size_t length = strlen(alphabet.c_str());
+
+    for(size_t i = 0; i < length; ) {
+        if(int(data[i]) == BACKSLASH_ASCII_VALUE) {
+            codePoints.push_back((unsigned char)alphabetEscape(char(data[i + 1])));
+            i += i + 1 < length ? 2 : 1;
+            continue;
+        }
+
+        uint32_t codePoint = 0;
+        size_t size = decodeUtf8Character(data + i, length - i, codePoint);
+
+        if(size == 0) {
+            return huffmanFailure(HUFFMAN_INVALID_CHARACTER, i);
+        }
+
+        codePoints.push_back(codePoint);
+        i += size;
+    }
+
+    return huffmanSuccess();
+}
@@ -0,0 +1,373 @@
+/*
+    Purpose: Implement a deflate-like coder for repetitive messages. A hash-chain match finder looks back
+        over a sliding window for an earlier copy of what comes next, and the message becomes a mix of
+        literal characters and (length, distance) pairs. Two AdaptiveHuffmanTree objects code them: one for
+        the literals and the length codes together, and one for the distance codes. As in deflate, a length
+        or distance is sent as the code for its range, followed by a few extra bits that pick the value
+        inside the range.
+
+        The trees are built over made-up alphabets (see syntheticAlphabet). The literal and length tree has
+        a symbol for every character of the message alphabet and then one for every length code, so it only
+        fits alphabets of up to LZ77_MAX_ALPHABET_SIZE characters. The level picks how hard the match finder
+        looks, trading speed for ratio; the decoder doesn't need to know it.
+*/
+#pragma once
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AdaptiveHuffmanTree.h"
+#include "HuffmanAlphabet.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the shortest and longest matches, and the size of the window matches can reach back over
+const int LZ77_MIN_MATCH = 3;
+const int LZ77_MAX_MATCH = 258;
+const size_t LZ77_WINDOW_SIZE = 32768;
+
+// Creating the size of the hash table that starts each chain, as a power of two
+const int LZ77_HASH_BITS = 15;
+
+// Creating the length and distance codes, with the first value of each code's range and its number of extra
+//      bits. These are deflate's
+const int LZ77_LENGTH_CODE_COUNT = 29;
+const int LZ77_LENGTH_BASE[LZ77_LENGTH_CODE_COUNT] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const int LZ77_LENGTH_EXTRA[LZ77_LENGTH_CODE_COUNT] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+const int LZ77_DISTANCE_CODE_COUNT = 30;
+const int LZ77_DISTANCE_BASE[LZ77_DISTANCE_CODE_COUNT] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+    4097, 6145, 8193, 12289, 16385, 24577
+};
+const int LZ77_DISTANCE_EXTRA[LZ77_DISTANCE_CODE_COUNT] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Creating the largest message alphabet the literal and length tree has room for
+const int LZ77_MAX_ALPHABET_SIZE = 255 - LZ77_LENGTH_CODE_COUNT;
+
+// Creating the range of levels, and the level we use when the caller doesn't say
+const int LZ77_MIN_LEVEL = 1;
+const int LZ77_MAX_LEVEL = 9;
+const int DEFAULT_LZ77_LEVEL = 6;
+
+// Creating the settings behind a level, which are zlib's: how many earlier positions the match finder tries, the
+//      match length below which it waits a character to see if a longer match starts there (zero to never wait),
+//      the match length past which that second look only tries a quarter as many positions, and the match length
+//      that is good enough to stop looking
+struct LZ77LevelSettings {
+    int maxChain;
+    int lazyLength;
+    int goodLength;
+    int niceLength;
+};
+
+const LZ77LevelSettings LZ77_LEVELS[LZ77_MAX_LEVEL] = {
+    {4, 0, 4, 8}, {8, 0, 4, 16}, {32, 0, 4, 32}, {16, 4, 4, 16}, {32, 16, 8, 32},
+    {128, 16, 8, 128}, {256, 32, 8, 128}, {1024, 128, 32, 258}, {4096, 258, 32, 258}
+};
+
+// Creating the match type the match finder hands back
+struct LZ77Match {
+    int length;
+    int distance;
+};
+
+// Creating the LZ77 coder class
+class LZ77HuffmanCoder {
+private:
+    // Creating the alphabet's characters, the lookup from byte value to character number, and the membership set
+    string symbols;
+    int symbolIndex[256];
+    AlphabetBitmap alphabetBitmap;
+
+    // Creating the tree for literals and length codes, and the tree for distance codes
+    AdaptiveHuffmanTree literalLengthTree;
+    AdaptiveHuffmanTree distanceTree;
+
+    // Creating the level's settings
+    LZ77LevelSettings settings;
+    int level;
+
+    // Creating the hash chains. The head of each hash holds the latest position with that hash, and the previous
+    //      entry of a position (kept for the last window's worth of positions) holds the one before it
+    vector<uint32_t> hashHead;
+    vector<uint32_t> hashPrevious;
+    size_t positionsInserted;
+
+    // Creating the code of every match length, and of every distance, split as in deflate into the distances up
+    //      to 256 and the rest in steps of 128
+    uint8_t lengthCode[LZ77_MAX_MATCH + 1];
+    uint8_t distanceCodeNear[256];
+    uint8_t distanceCodeFar[256];
+
+    // Function that returns the hash of the three characters at the position
+    static uint32_t hashAt(const unsigned char* data) {
+        uint32_t key = uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16);
+        return (key * 2654435761u) >> (32 - LZ77_HASH_BITS);
+    }
+
+    // Function that returns the code of a distance
+    int distanceCode(int distance) const {
+        return distance <= 256 ? this->distanceCodeNear[distance - 1] : this->distanceCodeFar[(distance - 1) >> 7];
+    }
+
+    // Function that adds every position before end to the hash chains, as long as three characters start there
+    void insertPositions(const unsigned char* data, size_t length, size_t end) {
+        while(this->positionsInserted < end && this->positionsInserted + LZ77_MIN_MATCH <= length) {
+            size_t position = this->positionsInserted++;
+            uint32_t hash = hashAt(data + position);
+
+            this->hashPrevious[position & (LZ77_WINDOW_SIZE - 1)] = this->hashHead[hash];
+            this->hashHead[hash] = (uint32_t)position;
+        }
+    }
+
+    // Function that walks the chain for the position, trying at most maxChain earlier positions, and returns the
+    //      longest match it finds in the window. A length below LZ77_MIN_MATCH means there is none
+    LZ77Match findMatch(const unsigned char* data, size_t length, size_t position, int maxChain) const {
+        LZ77Match best = {0, 0};
+
+        if(position + LZ77_MIN_MATCH > length) {
+            return best;
+        }
+
+        int maxLength = (int)min<size_t>(LZ77_MAX_MATCH, length - position);
+        uint32_t candidate = this->hashHead[hashAt(data + position)];
+        int chainLeft = maxChain;
+
+        // Every candidate has to be an earlier position still inside the window, whose chain entry hasn't been
+        //      written over by a later position
+        while(candidate != UINT32_MAX && candidate < position && position - candidate < LZ77_WINDOW_SIZE && chainLeft-- > 0) {
+            const unsigned char* earlier = data + candidate;
+            const unsigned char* current = data + position;
+
+            // Checking the character that would make this match longer than the best first, which rules out
+            //      most candidates with one comparison
+            if(earlier[best.length] == current[best.length]) {
+                int matchLength = 0;
+                while(matchLength < maxLength && earlier[matchLength] == current[matchLength]) {
+                    matchLength++;
+                }
+
+                if(matchLength > best.length) {
+                    best.length = matchLength;
+                    best.distance = int(position - candidate);
+
+                    if(matchLength >= this->settings.niceLength || matchLength == maxLength) {
+                        break;
+                    }
+                }
+            }
+
+            uint32_t next = this->hashPrevious[candidate & (LZ77_WINDOW_SIZE - 1)];
+            if(next == UINT32_MAX || next >= candidate) {
+                break;
+            }
+            candidate = next;
+        }
+
+        return best;
+    }
+
+    // Functions that write a literal, and a match, through the bit writer
+    void writeLiteral(unsigned char character, PackedBitWriter& writer) {
+        this->literalLengthTree.encodeSymbol((unsigned char)(this->symbolIndex[character] + 1), writer);
+    }
+
+    void writeMatch(const LZ77Match& match, PackedBitWriter& writer) {
+        int code = this->lengthCode[match.length];
+        this->literalLengthTree.encodeSymbol((unsigned char)(this->symbols.size() + code + 1), writer);
+        writer.putBits(match.length - LZ77_LENGTH_BASE[code], LZ77_LENGTH_EXTRA[code]);
+
+        code = distanceCode(match.distance);
+        this->distanceTree.encodeSymbol((unsigned char)(code + 1), writer);
+        writer.putBits(match.distance - LZ77_DISTANCE_BASE[code], LZ77_DISTANCE_EXTRA[code]);
+    }
+
+public:
+    // Constructor that takes the alphabet string, in the same form the AdaptiveHuffmanTree takes it, the level, and
+    //      the code length limit for both trees
+    explicit LZ77HuffmanCoder(const string& alphabet, int level = DEFAULT_LZ77_LEVEL, int maxCodeLength = NO_CODE_LENGTH_LIMIT)
+        : symbols(parseAlphabet(alphabet)),
+          literalLengthTree(syntheticAlphabet((int)symbols.size() + LZ77_LENGTH_CODE_COUNT), maxCodeLength),
+          distanceTree(syntheticAlphabet(LZ77_DISTANCE_CODE_COUNT), maxCodeLength),
+          hashHead(size_t(1) << LZ77_HASH_BITS, UINT32_MAX), hashPrevious(LZ77_WINDOW_SIZE, UINT32_MAX), positionsInserted(0) {
+        buildSymbolIndex(this->symbols, this->symbolIndex, this->alphabetBitmap);
+
+        this->level = max(LZ77_MIN_LEVEL, min(level, LZ77_MAX_LEVEL));
+        this->settings = LZ77_LEVELS[this->level - 1];
+
+        for(int code = 0; code < LZ77_LENGTH_CODE_COUNT; code++) {
+            int end = code + 1 < LZ77_LENGTH_CODE_COUNT ? LZ77_LENGTH_BASE[code + 1] : LZ77_MAX_MATCH + 1;
+            for(int length = LZ77_LENGTH_BASE[code]; length < end; length++) {
+                this->lengthCode[length] = (uint8_t)code;
+            }
+        }
+
+        for(int code = 0; code < LZ77_DISTANCE_CODE_COUNT; code++) {
+            int end = LZ77_DISTANCE_BASE[code] + (1 << LZ77_DISTANCE_EXTRA[code]);
+            for(int distance = LZ77_DISTANCE_BASE[code]; distance < end; distance++) {
+                if(distance <= 256) {
+                    this->distanceCodeNear[distance - 1] = (uint8_t)code;
+                }
+                else {
+                    this->distanceCodeFar[(distance - 1) >> 7] = (uint8_t)code;
+                }
+            }
+        }
+    }
+
+    // Function that puts both trees and the hash chains back to their starting state, for the next message
+    void reset() {
+        this->literalLengthTree.reset();
+        this->distanceTree.reset();
+        fill(this->hashHead.begin(), this->hashHead.end(), UINT32_MAX);
+        fill(this->hashPrevious.begin(), this->hashPrevious.end(), UINT32_MAX);
+        this->positionsInserted = 0;
+    }
+
+    // Function that tells us whether the alphabet is small enough to share a tree with the length codes
+    bool supportsAlphabet() const noexcept {
+        return (int)this->symbols.size() <= LZ77_MAX_ALPHABET_SIZE;
+    }
+
+    // Functions that return the level, and the code length limit of the trees
+    int getLevel() const noexcept {
+        return this->level;
+    }
+
+    int getMaxCodeLength() const noexcept {
+        return this->literalLengthTree.getMaxCodeLength();
+    }
+
+    // Function that encodes the message, appending the packed bits onto the end of the string
+    HuffmanResult encode(string_view message, string& packed) noexcept {
+        HuffmanResult validation = scanAlphabet(this->alphabetBitmap, message.data(), message.size(), nullptr);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+        if(!supportsAlphabet()) {
+            return huffmanFailure(HUFFMAN_INVALID_HEADER, 0);
+        }
+
+        reset();
+
+        ByteWriter bytes(packed);
+        PackedBitWriter writer(bytes);
+        const unsigned char* data = (const unsigned char*)message.data();
+        size_t length = message.size();
+        size_t position = 0;
+
+        // With lazy matching, the match found one character ahead is kept, so it isn't looked for twice
+        LZ77Match pending = {0, 0};
+        bool havePending = false;
+
+        while(position < length) {
+            insertPositions(data, length, position);
+            LZ77Match match = havePending ? pending : findMatch(data, length, position, this->settings.maxChain);
+            havePending = false;
+
+            if(match.length >= LZ77_MIN_MATCH && match.length < this->settings.lazyLength) {
+                int maxChain = match.length >= this->settings.goodLength ? this->settings.maxChain / 4 : this->settings.maxChain;
+                insertPositions(data, length, position + 1);
+                pending = findMatch(data, length, position + 1, maxChain);
+
+                if(pending.length > match.length) {
+                    havePending = true;
+                    match.length = 0;
+                }
+            }
+
+            if(match.length >= LZ77_MIN_MATCH) {
+                writeMatch(match, writer);
+                position += match.length;
+            }
+            else {
+                writeLiteral(data[position], writer);
+                position++;
+            }
+
+            if(writer.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, position);
+            }
+        }
+
+        if(!writer.finish()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, length);
+        }
+
+        return huffmanSuccess(writer.bytesWritten(), writer.bitsWritten());
+    }
+
+    // Function that decodes bitCount packed bits, appending the characters onto the end of the string. Decoding
+    //      stops with an error once more than maxLength characters come out, so a damaged payload can't make it
+    //      grow without end. Error offsets are in bits
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, size_t maxLength, string& message) noexcept {
+        this->literalLengthTree.reset();
+        this->distanceTree.reset();
+
+        PackedBitReader reader(input, bitCount);
+        size_t start = message.size();
+        int symbolCount = (int)this->symbols.size();
+
+        while(!reader.atEnd()) {
+            uint64_t symbolOffset = reader.getPosition();
+            char symbol = 0;
+
+            HuffmanStatus status = this->literalLengthTree.decodeSymbol(reader, symbol);
+            if(status != HUFFMAN_SUCCESS) {
+                return huffmanFailure(status, status == HUFFMAN_TRUNCATED_MESSAGE ? reader.getPosition() : symbolOffset);
+            }
+
+            int code = (unsigned char)symbol - 1;
+            if(code < symbolCount) {
+                message.push_back(this->symbols[code]);
+            }
+            else {
+                code -= symbolCount;
+                unsigned extra = 0;
+
+                if(!reader.getBits(LZ77_LENGTH_EXTRA[code], extra)) {
+                    return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, bitCount);
+                }
+                int length = LZ77_LENGTH_BASE[code] + (int)extra;
+
+                status = this->distanceTree.decodeSymbol(reader, symbol);
+                if(status != HUFFMAN_SUCCESS) {
+                    return huffmanFailure(status, status == HUFFMAN_TRUNCATED_MESSAGE ? reader.getPosition() : symbolOffset);
+                }
+
+                code = (unsigned char)symbol - 1;
+                if(!reader.getBits(LZ77_DISTANCE_EXTRA[code], extra)) {
+                    return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, bitCount);
+                }
+                size_t distance = size_t(LZ77_DISTANCE_BASE[code]) + extra;
+
+                // The match has to start inside what this message has decoded so far
+                if(distance > message.size() - start) {
+                    return huffmanFailure(HUFFMAN_INVALID_CHARACTER, symbolOffset);
+                }
+
+                // Copying a character at a time, since a match may overlap the characters it produces
+                size_t from = message.size() - distance;
+                for(int i = 0; i < length; i++) {
+                    message.push_back(message[from + i]);
+                }
+            }
+
+            if(message.size() - start > maxLength) {
+                return huffmanFailure(HUFFMAN_INVALID_HEADER, symbolOffset);
+            }
+        }
+
+        return huffmanSuccess(message.size() - start, uint64_t(message.size() - start) * 8);
+    }
+};
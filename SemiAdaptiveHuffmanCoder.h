@@ -0,0 +1,202 @@
+/*
+    Purpose: Implement a semi-adaptive Huffman coder. Like the AdaptiveHuffmanTree, it starts knowing only
+        the alphabet and learns the message's statistics as it goes, but instead of rebalancing a tree after
+        every character, it only bumps a count. Every so often (after 32 characters at first, doubling up to
+        the rebuild interval) the counts are turned into a fresh canonical code table, on exactly the same
+        schedule in the encoder and the decoder. Between rebuilds, coding is a single table lookup per
+        character. This gives up a little compression for a lot of speed.
+*/
+#pragma once
+#include <string>
+#include <string_view>
+#include "HuffmanAlphabet.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+#include "CanonicalHuffman.h"
+#include "AlphabetScanner.h"
+using namespace std;
+
+// Creating the default and first rebuild intervals, in characters
+const int DEFAULT_REBUILD_INTERVAL = 16384;
+const int FIRST_REBUILD_INTERVAL = 32;
+
+// Creating the total count at which the counts are halved at the next rebuild, so the code keeps following
+//      the message instead of being ruled by what it saw long ago
+const uint64_t SEMI_ADAPTIVE_COUNT_LIMIT = uint64_t(1) << 16;
+
+// Creating the semi-adaptive coder class
+class SemiAdaptiveHuffmanCoder {
+private:
+    // Creating the alphabet's characters, the lookup from byte value to character number, and the membership set
+    string symbols;
+    int symbolIndex[256];
+    AlphabetBitmap alphabetBitmap;
+
+    // Creating the longest stretch of characters between two rebuilds
+    int rebuildInterval;
+
+    // Creating the adapted state: the counts, the current code table, and where we are in the rebuild schedule
+    uint64_t counts[CANONICAL_MAX_SYMBOLS];
+    uint64_t totalCount;
+    int currentInterval;
+    int sinceRebuild;
+    CanonicalHuffmanCode code;
+
+public:
+    // Constructor that takes the alphabet string, in the same form the AdaptiveHuffmanTree takes it
+    explicit SemiAdaptiveHuffmanCoder(const string& alphabet, int rebuildInterval = DEFAULT_REBUILD_INTERVAL)
+        : rebuildInterval(rebuildInterval < FIRST_REBUILD_INTERVAL ? FIRST_REBUILD_INTERVAL : rebuildInterval) {
+        this->symbols = parseAlphabet(alphabet);
+        buildSymbolIndex(this->symbols, this->symbolIndex, this->alphabetBitmap);
+        reset();
+    }
+
+    // Function that goes back to the starting state, where every character has a count of one. Calling this at
+    //      the start of every block in both the encoder and decoder keeps the blocks independent
+    void reset() {
+        for(size_t i = 0; i < this->symbols.size(); i++) {
+            this->counts[i] = 1;
+        }
+
+        this->totalCount = this->symbols.size();
+        this->currentInterval = FIRST_REBUILD_INTERVAL;
+        this->sinceRebuild = 0;
+        buildCanonicalCodeFromCounts(this->counts, (int)this->symbols.size(), this->code);
+    }
+
+    // Function that returns the characters of the alphabet
+    const string& getAlphabetSymbols() const {
+        return this->symbols;
+    }
+
+    // Function that returns the most bits encoding a message of the given length can take
+    uint64_t maxEncodedBits(size_t messageLength) const noexcept {
+        return uint64_t(messageLength) * CANONICAL_MAX_CODE_LENGTH;
+    }
+
+    // Function that returns the size of a caller buffer that is always big enough for the packed encode method
+    size_t maxEncodedBytes(size_t messageLength) const noexcept {
+        return size_t((maxEncodedBits(messageLength) + 7) / 8);
+    }
+
+    // Encode methods, writing packed bits into a caller's buffer, a caller's sink, or onto the end of a string
+    HuffmanResult encode(string_view message, unsigned char* output, size_t capacity) noexcept {
+        ByteWriter bytes((char*)output, capacity);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(message, writer);
+    }
+
+    HuffmanResult encode(string_view message, HuffmanSink& sink) noexcept {
+        ByteWriter bytes(sink);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(message, writer);
+    }
+
+    HuffmanResult encode(string_view message, string& packed) noexcept {
+        ByteWriter bytes(packed);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(message, writer);
+    }
+
+    // Decode methods, reading bitCount packed bits and writing the characters into a caller's buffer, a caller's
+    //      sink, or onto the end of a string. Error offsets are in bits
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, char* output, size_t capacity) noexcept {
+        ByteWriter bytes(output, capacity);
+        return decodeMessage(input, bitCount, bytes);
+    }
+
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, HuffmanSink& sink) noexcept {
+        ByteWriter bytes(sink);
+        return decodeMessage(input, bitCount, bytes);
+    }
+
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, string& message) noexcept {
+        ByteWriter bytes(message);
+        return decodeMessage(input, bitCount, bytes);
+    }
+
+private:
+    // Function that counts a character, and rebuilds the code table when the schedule says so
+    void countSymbol(int symbol) {
+        this->counts[symbol]++;
+        this->totalCount++;
+
+        if(++this->sinceRebuild == this->currentInterval) {
+            rebuild();
+        }
+    }
+
+    // Function that turns the counts into a new code table
+    void rebuild() {
+        // Halving the counts once they get large, keeping every count at one or more so every character keeps a code
+        if(this->totalCount > SEMI_ADAPTIVE_COUNT_LIMIT) {
+            this->totalCount = 0;
+            for(size_t i = 0; i < this->symbols.size(); i++) {
+                this->counts[i] = (this->counts[i] + 1) / 2;
+                this->totalCount += this->counts[i];
+            }
+        }
+
+        buildCanonicalCodeFromCounts(this->counts, (int)this->symbols.size(), this->code);
+
+        this->sinceRebuild = 0;
+        if(this->currentInterval < this->rebuildInterval) {
+            this->currentInterval = min(this->currentInterval * 2, this->rebuildInterval);
+        }
+    }
+
+    // Function that encodes a whole message through the bit writer
+    HuffmanResult encodeMessage(string_view message, PackedBitWriter& writer) noexcept {
+        // Checking the whole message against the alphabet before coding anything
+        HuffmanResult validation = scanAlphabet(this->alphabetBitmap, message.data(), message.size(), nullptr);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+
+        for(size_t i = 0; i < message.size(); i++) {
+            int symbol = this->symbolIndex[(unsigned char)message[i]];
+
+            writeCanonicalSymbol(this->code, symbol, writer);
+            countSymbol(symbol);
+
+            if(writer.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, i);
+            }
+        }
+
+        if(!writer.finish()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, message.size());
+        }
+
+        return huffmanSuccess(writer.bytesWritten(), writer.bitsWritten());
+    }
+
+    // Function that decodes bitCount bits into the byte writer
+    HuffmanResult decodeMessage(const unsigned char* input, uint64_t bitCount, ByteWriter& output) noexcept {
+        PackedBitReader reader(input, bitCount);
+
+        while(!reader.atEnd()) {
+            uint64_t symbolOffset = reader.getPosition();
+            int symbol;
+
+            HuffmanStatus status = readCanonicalSymbol(this->code, reader, symbol);
+            if(status != HUFFMAN_SUCCESS) {
+                return huffmanFailure(status, symbolOffset);
+            }
+
+            output.put(this->symbols[symbol]);
+            countSymbol(symbol);
+
+            if(output.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, symbolOffset);
+            }
+        }
+
+        if(!output.flush()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, bitCount);
+        }
+
+        return huffmanSuccess(output.bytesWritten(), uint64_t(output.bytesWritten()) * 8);
+    }
+};
@@ -0,0 +1,214 @@
+/*
+    Purpose: Implement a static, two-pass Huffman coder for messages we can read twice. The first pass
+        counts every character of the message, the counts become a length-limited canonical code, and the
+        second pass codes the message with it. The code never changes, so the payload starts with the code
+        lengths, four bits for each character of the alphabet, and the decoder rebuilds the same table from
+        them. Both directions are a table lookup per character with no branches on the bits.
+*/
+#pragma once
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "HuffmanAlphabet.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+#include "CanonicalHuffman.h"
+#include "AlphabetScanner.h"
+using namespace std;
+
+// Creating the number of bits each stored code length takes. Lengths run from 0 to CANONICAL_MAX_CODE_LENGTH
+const int STATIC_LENGTH_BITS = 4;
+
+// Creating the number of codes the encoder gathers before handing them to the bit writer. Four codes of
+//      at most twelve bits fit comfortably under the writer's 57 bit limit
+const int STATIC_CODES_PER_WRITE = 4;
+
+// Creating the static coder class
+class StaticHuffmanCoder {
+private:
+    // Creating the alphabet's characters, the lookup from byte value to character number, and the membership set
+    string symbols;
+    int symbolIndex[256];
+    AlphabetBitmap alphabetBitmap;
+
+    // Creating the code table for the message being coded
+    CanonicalHuffmanCode code;
+
+public:
+    // Constructor that takes the alphabet string, in the same form the AdaptiveHuffmanTree takes it
+    explicit StaticHuffmanCoder(const string& alphabet) {
+        this->symbols = parseAlphabet(alphabet);
+        buildSymbolIndex(this->symbols, this->symbolIndex, this->alphabetBitmap);
+        this->code.symbolCount = (int)this->symbols.size();
+    }
+
+    // Function that does nothing, since the coder keeps no state between messages. It is here so the static
+    //      coder can be used anywhere the adaptive coders are
+    void reset() {}
+
+    // Function that returns the characters of the alphabet
+    const string& getAlphabetSymbols() const {
+        return this->symbols;
+    }
+
+    // Function that returns the number of bits the code length header takes
+    uint64_t headerBits() const noexcept {
+        return uint64_t(this->symbols.size()) * STATIC_LENGTH_BITS;
+    }
+
+    // Function that returns the most bits encoding a message of the given length can take
+    uint64_t maxEncodedBits(size_t messageLength) const noexcept {
+        return headerBits() + uint64_t(messageLength) * CANONICAL_MAX_CODE_LENGTH;
+    }
+
+    // Function that returns the size of a caller buffer that is always big enough for the packed encode method
+    size_t maxEncodedBytes(size_t messageLength) const noexcept {
+        return size_t((maxEncodedBits(messageLength) + 7) / 8);
+    }
+
+    // Encode methods, writing the code lengths and then the packed bits into a caller's buffer, a caller's sink,
+    //      or onto the end of a string
+    HuffmanResult encode(string_view message, unsigned char* output, size_t capacity) noexcept {
+        ByteWriter bytes((char*)output, capacity);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(message, writer);
+    }
+
+    HuffmanResult encode(string_view message, HuffmanSink& sink) noexcept {
+        ByteWriter bytes(sink);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(message, writer);
+    }
+
+    HuffmanResult encode(string_view message, string& packed) noexcept {
+        ByteWriter bytes(packed);
+        PackedBitWriter writer(bytes);
+        return encodeMessage(message, writer);
+    }
+
+    // Decode methods, reading bitCount packed bits and writing the characters into a caller's buffer, a caller's
+    //      sink, or onto the end of a string. Error offsets are in bits
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, char* output, size_t capacity) noexcept {
+        ByteWriter bytes(output, capacity);
+        return decodeMessage(input, bitCount, bytes);
+    }
+
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, HuffmanSink& sink) noexcept {
+        ByteWriter bytes(sink);
+        return decodeMessage(input, bitCount, bytes);
+    }
+
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, string& message) noexcept {
+        ByteWriter bytes(message);
+        return decodeMessage(input, bitCount, bytes);
+    }
+
+private:
+    // Function that encodes a whole message through the bit writer
+    HuffmanResult encodeMessage(string_view message, PackedBitWriter& writer) noexcept {
+        // The first pass checks the message against the alphabet and counts every byte value in it
+        uint64_t histogram[256] = {0};
+        HuffmanResult validation = scanAlphabet(this->alphabetBitmap, message.data(), message.size(), histogram);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+
+        uint64_t counts[CANONICAL_MAX_SYMBOLS];
+        for(size_t i = 0; i < this->symbols.size(); i++) {
+            counts[i] = histogram[(unsigned char)this->symbols[i]];
+        }
+
+        buildCanonicalCodeFromCounts(counts, (int)this->symbols.size(), this->code);
+
+        // Writing the code lengths, which are all the decoder needs to rebuild the table
+        for(size_t i = 0; i < this->symbols.size(); i++) {
+            writer.putBits(this->code.lengths[i], STATIC_LENGTH_BITS);
+        }
+
+        // Creating the code of each byte value, with the length in the low four bits, so the second pass is a
+        //      single load per character
+        uint32_t codeByByte[256] = {0};
+        for(int b = 0; b < 256; b++) {
+            int symbol = this->symbolIndex[b];
+            if(symbol >= 0) {
+                codeByByte[b] = (uint32_t(this->code.codes[symbol]) << 4) | this->code.lengths[symbol];
+            }
+        }
+
+        // The second pass gathers a few codes at a time before writing them
+        const unsigned char* data = (const unsigned char*)message.data();
+        size_t length = message.size();
+        size_t i = 0;
+
+        for(; i + STATIC_CODES_PER_WRITE <= length; i += STATIC_CODES_PER_WRITE) {
+            uint64_t bits = 0;
+            int bitCount = 0;
+
+            for(int j = 0; j < STATIC_CODES_PER_WRITE; j++) {
+                uint32_t entry = codeByByte[data[i + j]];
+                bits = (bits << (entry & 15)) | (entry >> 4);
+                bitCount += entry & 15;
+            }
+
+            writer.putBits(bits, bitCount);
+
+            if(writer.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, i);
+            }
+        }
+
+        for(; i < length; i++) {
+            uint32_t entry = codeByByte[data[i]];
+            writer.putBits(entry >> 4, entry & 15);
+        }
+
+        if(writer.failed() || !writer.finish()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, length);
+        }
+
+        return huffmanSuccess(writer.bytesWritten(), writer.bitsWritten());
+    }
+
+    // Function that decodes bitCount bits into the byte writer
+    HuffmanResult decodeMessage(const unsigned char* input, uint64_t bitCount, ByteWriter& output) noexcept {
+        PackedBitReader reader(input, bitCount);
+
+        // Reading the code lengths back and rebuilding the table from them
+        if(bitCount < headerBits()) {
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, bitCount);
+        }
+
+        for(size_t i = 0; i < this->symbols.size(); i++) {
+            unsigned length = 0;
+            reader.getBits(STATIC_LENGTH_BITS, length);
+            this->code.lengths[i] = (uint8_t)length;
+        }
+
+        if(!buildCanonicalCode(this->code)) {
+            return huffmanFailure(HUFFMAN_INVALID_HEADER, 0);
+        }
+
+        while(!reader.atEnd()) {
+            uint64_t symbolOffset = reader.getPosition();
+            int symbol;
+
+            HuffmanStatus status = readCanonicalSymbol(this->code, reader, symbol);
+            if(status != HUFFMAN_SUCCESS) {
+                return huffmanFailure(status, symbolOffset);
+            }
+
+            output.put(this->symbols[symbol]);
+
+            if(output.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, symbolOffset);
+            }
+        }
+
+        if(!output.flush()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, bitCount);
+        }
+
+        return huffmanSuccess(output.bytesWritten(), uint64_t(output.bytesWritten()) * 8);
+    }
+};
@@ -0,0 +1,164 @@
+/*
+    Purpose: Build suffix arrays in linear time with SA-IS (Nong, Zhang and Chan's induced sorting). The
+        suffixes are split into S-type (smaller than the suffix after them) and L-type (larger), and the
+        S-type suffixes with an L-type suffix just before them (the LMS suffixes) are sorted first. Every
+        other suffix is then slotted into place by two passes over the array that induce its position from
+        an already placed neighbour. Sorting the LMS suffixes is the same problem on a string at most half
+        as long, so the function recurses on it until every LMS substring is unique.
+*/
+#pragma once
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+// Function that fills the start (or the end, one past the last slot) of every character's bucket in the array
+inline void suffixBuckets(const int32_t* text, int32_t length, int32_t alphabetSize, vector<int32_t>& buckets, bool ends) {
+    buckets.assign(alphabetSize, 0);
+    for(int32_t i = 0; i < length; i++) {
+        buckets[text[i]]++;
+    }
+
+    int32_t sum = 0;
+    for(int32_t c = 0; c < alphabetSize; c++) {
+        sum += buckets[c];
+        buckets[c] = ends ? sum : sum - buckets[c];
+    }
+}
+
+// Function that places the L-type suffixes from the left of each bucket, and then the S-type suffixes from the
+//      right of each bucket, each induced by the suffix after it having been placed already
+inline void induceSuffixes(const int32_t* text, int32_t* suffixArray, int32_t length, int32_t alphabetSize,
+                           const vector<bool>& sType, vector<int32_t>& buckets) {
+    suffixBuckets(text, length, alphabetSize, buckets, false);
+    for(int32_t i = 0; i < length; i++) {
+        int32_t j = suffixArray[i] - 1;
+        if(j >= 0 && !sType[j]) {
+            suffixArray[buckets[text[j]]++] = j;
+        }
+    }
+
+    suffixBuckets(text, length, alphabetSize, buckets, true);
+    for(int32_t i = length - 1; i >= 0; i--) {
+        int32_t j = suffixArray[i] - 1;
+        if(j >= 0 && sType[j]) {
+            suffixArray[--buckets[text[j]]] = j;
+        }
+    }
+}
+
+// Function that fills the suffix array of the text. The characters are 0 to alphabetSize - 1, and the text has to
+//      end with a 0 that appears nowhere else, so the last suffix sorts first
+inline void buildSuffixArray(const int32_t* text, int32_t* suffixArray, int32_t length, int32_t alphabetSize) {
+    if(length == 1) {
+        suffixArray[0] = 0;
+        return;
+    }
+
+    // Classifying every suffix, from the back, since a suffix has the type of the one after it when they start
+    //      with the same character
+    vector<bool> sType(length);
+    sType[length - 1] = true;
+    for(int32_t i = length - 2; i >= 0; i--) {
+        sType[i] = text[i] < text[i + 1] || (text[i] == text[i + 1] && sType[i + 1]);
+    }
+
+    auto isLMS = [&](int32_t i) {
+        return i > 0 && sType[i] && !sType[i - 1];
+    };
+
+    // Placing the LMS suffixes at the ends of their buckets in any order, and inducing from them. This sorts the
+    //      LMS substrings (from one LMS position to the next), though not yet the LMS suffixes
+    vector<int32_t> buckets;
+    suffixBuckets(text, length, alphabetSize, buckets, true);
+
+    for(int32_t i = 0; i < length; i++) {
+        suffixArray[i] = -1;
+    }
+    for(int32_t i = 1; i < length; i++) {
+        if(isLMS(i)) {
+            suffixArray[--buckets[text[i]]] = i;
+        }
+    }
+
+    induceSuffixes(text, suffixArray, length, alphabetSize, sType, buckets);
+
+    // Gathering the sorted LMS positions at the front of the array
+    int32_t lmsCount = 0;
+    for(int32_t i = 0; i < length; i++) {
+        if(isLMS(suffixArray[i])) {
+            suffixArray[lmsCount++] = suffixArray[i];
+        }
+    }
+    for(int32_t i = lmsCount; i < length; i++) {
+        suffixArray[i] = -1;
+    }
+
+    // Naming each LMS substring by its rank, with equal substrings sharing a name. LMS positions are at least two
+    //      apart, so position / 2 gives each one its own slot behind the sorted positions
+    int32_t nameCount = 0;
+    int32_t previous = -1;
+
+    for(int32_t i = 0; i < lmsCount; i++) {
+        int32_t position = suffixArray[i];
+        bool different = false;
+
+        for(int32_t d = 0; d < length; d++) {
+            if(previous == -1 || text[position + d] != text[previous + d] || sType[position + d] != sType[previous + d]) {
+                different = true;
+                break;
+            }
+            if(d > 0 && (isLMS(position + d) || isLMS(previous + d))) {
+                break;
+            }
+        }
+
+        if(different) {
+            nameCount++;
+            previous = position;
+        }
+        suffixArray[lmsCount + position / 2] = nameCount - 1;
+    }
+
+    for(int32_t i = length - 1, j = length - 1; i >= lmsCount; i--) {
+        if(suffixArray[i] >= 0) {
+            suffixArray[j--] = suffixArray[i];
+        }
+    }
+
+    // Sorting the LMS suffixes. The names, in text order, make a shorter string whose suffix array is their order;
+    //      when every name is unique the order can be read straight off the names
+    int32_t* reducedSuffixArray = suffixArray;
+    int32_t* reducedText = suffixArray + length - lmsCount;
+
+    if(nameCount < lmsCount) {
+        buildSuffixArray(reducedText, reducedSuffixArray, lmsCount, nameCount);
+    }
+    else {
+        for(int32_t i = 0; i < lmsCount; i++) {
+            reducedSuffixArray[reducedText[i]] = i;
+        }
+    }
+
+    // Turning the order back into text positions, placing the sorted LMS suffixes at the ends of their buckets,
+    //      and inducing every other suffix from them
+    for(int32_t i = 1, j = 0; i < length; i++) {
+        if(isLMS(i)) {
+            reducedText[j++] = i;
+        }
+    }
+    for(int32_t i = 0; i < lmsCount; i++) {
+        reducedSuffixArray[i] = reducedText[reducedSuffixArray[i]];
+    }
+    for(int32_t i = lmsCount; i < length; i++) {
+        suffixArray[i] = -1;
+    }
+
+    suffixBuckets(text, length, alphabetSize, buckets, true);
+    for(int32_t i = lmsCount - 1; i >= 0; i--) {
+        int32_t j = suffixArray[i];
+        suffixArray[i] = -1;
+        suffixArray[--buckets[text[j]]] = j;
+    }
+
+    induceSuffixes(text, suffixArray, length, alphabetSize, sType, buckets);
+}
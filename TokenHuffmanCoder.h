@@ -0,0 +1,381 @@
+/*
+    Purpose: Implement a token coder for messages built out of the same words or fields over and over, such
+        as logs, CSV, or source code. Along with the alphabet, the coder takes a dictionary of up to
+        TOKEN_MAX_COUNT strings. The message is read greedily: at each position a trie finds the longest token
+        that starts there. Each token is a symbol of an AdaptiveHuffmanTree16, which has room for the whole
+        dictionary, so a frequent word costs about as much as a frequent character would. Symbol zero of that
+        tree is the escape. A character that starts no token is written as the escape followed by the character,
+        which a byte AdaptiveHuffmanTree over the alphabet codes.
+
+        Like the alphabet, the dictionary isn't stored in the payload, and the decoder has to be given the same
+        one. The payload starts with a fingerprint of the dictionary (four bytes, little endian), so a payload
+        decoded with the wrong dictionary fails instead of coming out as the wrong message.
+*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "AdaptiveHuffmanTree.h"
+#include "HuffmanAlphabet.h"
+#include "HuffmanContainer.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Creating the most tokens a dictionary can hold, which along with the escape fills the token tree
+const size_t TOKEN_MAX_COUNT = 65535;
+
+// Creating the token tree's symbol for the escape to a single character
+const uint16_t TOKEN_ESCAPE = 0;
+
+// Creating the number of bytes the dictionary fingerprint takes at the front of the payload
+const size_t TOKEN_FINGERPRINT_BYTES = 4;
+
+// Function that reads a whole file into a string, byte for byte, for the dictionary files and the commands that work
+//      on binary files. A HuffmanException is thrown if it can't be opened
+inline string readWholeFile(const string& fileName) {
+    ifstream file(fileName, ios::binary);
+
+    if(!file) {
+        throw HuffmanException("Error When Opening " + fileName + ". Re-Run Program To Try Again.");
+    }
+
+    ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// Function that parses a dictionary file into its tokens, one per line. Backslash escapes are read the way
+//      parseAlphabet reads them, so a token can hold a newline or a tab. Empty lines are skipped, and a carriage
+//      return at the end of a line is dropped
+inline vector<string> parseTokenDictionary(const string& text) {
+    vector<string> tokens;
+    size_t start = 0;
+
+    while(start < text.size()) {
+        size_t end = text.find('\n', start);
+        if(end == string::npos) {
+            end = text.size();
+        }
+
+        size_t lineEnd = end > start && text[end - 1] == '\r' ? end - 1 : end;
+        string token;
+
+        for(size_t i = start; i < lineEnd; i++) {
+            if(int(text[i]) == BACKSLASH_ASCII_VALUE && i + 1 < lineEnd) {
+                token.push_back(alphabetEscape(text[i + 1]));
+                i++;
+            }
+            else {
+                token.push_back(text[i]);
+            }
+        }
+
+        if(!token.empty()) {
+            tokens.push_back(token);
+        }
+        start = end + 1;
+    }
+
+    return tokens;
+}
+
+// Creating the trie the encoder finds tokens with. The first character of a token is looked up in a direct table,
+//      since that step runs at every position of the message. Every deeper node keeps its edges in a sorted run of
+//      one shared array, so the whole trie is three flat arrays
+class TokenTrie {
+private:
+    // Creating a trie node: where its edges start in the edge arrays, how many it has, and the token that ends
+    //      at it (zero for none)
+    struct TrieNode {
+        uint32_t firstEdge;
+        uint32_t edgeCount;
+        uint32_t token;
+    };
+
+    // Creating the node each first character leads to (-1 for none), the nodes, and the edges, split into their
+    //      characters and the nodes they lead to
+    int32_t rootChildren[256];
+    vector<TrieNode> nodes;
+    vector<unsigned char> edgeCharacters;
+    vector<int32_t> edgeChildren;
+
+public:
+    // Constructor that builds the trie from the tokens, where token number i + 1 is tokens[i]
+    explicit TokenTrie(const vector<string>& tokens) {
+        // Building the trie with a map of children per node first, which keeps every node's edges sorted
+        vector<map<unsigned char, int32_t>> children(1);
+        vector<uint32_t> endingTokens(1, 0);
+
+        for(size_t i = 0; i < tokens.size(); i++) {
+            int32_t node = 0;
+
+            for(size_t j = 0; j < tokens[i].size(); j++) {
+                unsigned char character = (unsigned char)tokens[i][j];
+                auto found = children[node].find(character);
+
+                if(found == children[node].end()) {
+                    int32_t child = (int32_t)children.size();
+                    children[node][character] = child;
+                    children.emplace_back();
+                    endingTokens.push_back(0);
+                    node = child;
+                }
+                else {
+                    node = found->second;
+                }
+            }
+
+            endingTokens[node] = uint32_t(i + 1);
+        }
+
+        // Flattening the maps into the edge arrays, with the root's edges in the direct table instead
+        fill(begin(this->rootChildren), end(this->rootChildren), -1);
+        this->nodes.resize(children.size());
+
+        for(size_t node = 0; node < children.size(); node++) {
+            this->nodes[node].firstEdge = (uint32_t)this->edgeCharacters.size();
+            this->nodes[node].edgeCount = node == 0 ? 0 : (uint32_t)children[node].size();
+            this->nodes[node].token = endingTokens[node];
+
+            for(const auto& edge : children[node]) {
+                if(node == 0) {
+                    this->rootChildren[edge.first] = edge.second;
+                }
+                else {
+                    this->edgeCharacters.push_back(edge.first);
+                    this->edgeChildren.push_back(edge.second);
+                }
+            }
+        }
+    }
+
+    // Function that finds the longest token the data starts with, returning its length and setting token to its
+    //      number, or returning zero if no token fits
+    size_t longestMatch(const unsigned char* data, size_t length, uint32_t& token) const {
+        size_t matched = 0;
+
+        if(length == 0 || this->rootChildren[data[0]] == -1) {
+            return 0;
+        }
+
+        int32_t node = this->rootChildren[data[0]];
+
+        for(size_t depth = 1; ; depth++) {
+            if(this->nodes[node].token != 0) {
+                token = this->nodes[node].token;
+                matched = depth;
+            }
+            if(depth == length || this->nodes[node].edgeCount == 0) {
+                break;
+            }
+
+            const unsigned char* first = this->edgeCharacters.data() + this->nodes[node].firstEdge;
+            const unsigned char* last = first + this->nodes[node].edgeCount;
+            const unsigned char* edge = lower_bound(first, last, data[depth]);
+
+            if(edge == last || *edge != data[depth]) {
+                break;
+            }
+            node = this->edgeChildren[edge - this->edgeCharacters.data()];
+        }
+
+        return matched;
+    }
+};
+
+// Creating the token coder class
+class TokenHuffmanCoder {
+private:
+    // Creating the alphabet's membership set, and the tokens in the order they are numbered from one
+    string symbols;
+    AlphabetBitmap alphabetBitmap;
+    vector<string> tokens;
+    uint32_t fingerprint;
+
+    // Creating the trie, the tree over the escape and the token numbers, and the tree for escaped characters
+    TokenTrie trie;
+    AdaptiveHuffmanTree16 tokenTree;
+    AdaptiveHuffmanTree literalTree;
+
+    // Function that keeps the tokens a message could hold: ones that aren't empty, are made of alphabet characters
+    //      only, and haven't come up before, up to TOKEN_MAX_COUNT of them
+    static vector<string> usableTokens(const vector<string>& dictionary, const string& symbols) {
+        AlphabetBitmap bitmap;
+        int symbolIndex[256];
+        buildSymbolIndex(symbols, symbolIndex, bitmap);
+
+        vector<string> kept;
+        unordered_set<string> seen;
+
+        for(size_t i = 0; i < dictionary.size() && kept.size() < TOKEN_MAX_COUNT; i++) {
+            const string& token = dictionary[i];
+            bool inAlphabet = !token.empty();
+
+            for(size_t j = 0; j < token.size() && inAlphabet; j++) {
+                inAlphabet = bitmap.contains((unsigned char)token[j]);
+            }
+
+            if(inAlphabet && seen.insert(token).second) {
+                kept.push_back(token);
+            }
+        }
+
+        return kept;
+    }
+
+    // Function that returns the token tree's alphabet: the escape followed by every token number
+    static vector<uint16_t> tokenNumbers(size_t tokenCount) {
+        vector<uint16_t> numbers(tokenCount + 1);
+
+        for(size_t i = 0; i <= tokenCount; i++) {
+            numbers[i] = (uint16_t)i;
+        }
+        return numbers;
+    }
+
+    // Function that returns the 32 bit FNV-1a hash of the tokens, each followed by a NULL character, which can't
+    //      be part of a token
+    static uint32_t dictionaryFingerprint(const vector<string>& tokens) {
+        uint32_t hash = 2166136261u;
+
+        for(const string& token : tokens) {
+            for(size_t i = 0; i <= token.size(); i++) {
+                hash ^= i < token.size() ? (unsigned char)token[i] : 0;
+                hash *= 16777619u;
+            }
+        }
+        return hash;
+    }
+
+    // Function that builds the token tree with the given code length limit
+    static AdaptiveHuffmanTree16 makeTokenTree(size_t tokenCount, int maxCodeLength) {
+        vector<uint16_t> numbers = tokenNumbers(tokenCount);
+        return AdaptiveHuffmanTree16(numbers.data(), numbers.size(), maxCodeLength);
+    }
+
+public:
+    // Constructor that takes the alphabet string, in the same form the AdaptiveHuffmanTree takes it, the dictionary,
+    //      and the code length limit for both trees. Tokens the coder can't use are dropped (see usableTokens)
+    TokenHuffmanCoder(const string& alphabet, const vector<string>& dictionary, int maxCodeLength = NO_CODE_LENGTH_LIMIT)
+        : symbols(parseAlphabet(alphabet)), tokens(usableTokens(dictionary, symbols)), fingerprint(dictionaryFingerprint(tokens)),
+          trie(tokens), tokenTree(makeTokenTree(tokens.size(), maxCodeLength)), literalTree(alphabet, maxCodeLength) {
+        int symbolIndex[256];
+        buildSymbolIndex(this->symbols, symbolIndex, this->alphabetBitmap);
+    }
+
+    // Function that puts both trees back to their starting state, for the next message
+    void reset() {
+        this->tokenTree.reset();
+        this->literalTree.reset();
+    }
+
+    // Function that returns the tokens the coder kept, numbered from one
+    const vector<string>& getTokens() const noexcept {
+        return this->tokens;
+    }
+
+    // Function that tells us whether the coder has any tokens, since without them every character is escaped
+    bool hasTokens() const noexcept {
+        return !this->tokens.empty();
+    }
+
+    // Function that returns the code length limit of the character tree
+    int getMaxCodeLength() const noexcept {
+        return this->literalTree.getMaxCodeLength();
+    }
+
+    // Function that encodes the message, appending the fingerprint and the packed bits onto the end of the string.
+    //      The result's bit count includes the fingerprint
+    HuffmanResult encode(string_view message, string& payload) noexcept {
+        HuffmanResult validation = scanAlphabet(this->alphabetBitmap, message.data(), message.size(), nullptr);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+
+        reset();
+        appendLittleEndian(payload, this->fingerprint, TOKEN_FINGERPRINT_BYTES);
+
+        ByteWriter bytes(payload);
+        PackedBitWriter writer(bytes);
+        const unsigned char* data = (const unsigned char*)message.data();
+        size_t length = message.size();
+        size_t position = 0;
+
+        while(position < length) {
+            uint32_t token = 0;
+            size_t matched = this->trie.longestMatch(data + position, length - position, token);
+
+            if(matched > 0) {
+                this->tokenTree.encodeSymbol((uint16_t)token, writer);
+                position += matched;
+            }
+            else {
+                this->tokenTree.encodeSymbol(TOKEN_ESCAPE, writer);
+                this->literalTree.encodeSymbol(data[position], writer);
+                position++;
+            }
+
+            if(writer.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, position);
+            }
+        }
+
+        if(!writer.finish()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, length);
+        }
+
+        return huffmanSuccess(TOKEN_FINGERPRINT_BYTES + writer.bytesWritten(), TOKEN_FINGERPRINT_BYTES * 8 + writer.bitsWritten());
+    }
+
+    // Function that decodes a payload of bitCount bits, appending the characters onto the end of the string. Decoding
+    //      stops with an error once more than maxLength characters come out, or right away if the payload was coded
+    //      with a different dictionary. Error offsets are in bits from the start of the payload
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, size_t maxLength, string& message) noexcept {
+        if(bitCount < TOKEN_FINGERPRINT_BYTES * 8) {
+            return huffmanFailure(HUFFMAN_TRUNCATED_MESSAGE, bitCount);
+        }
+        if((uint32_t)readLittleEndian((const char*)input, TOKEN_FINGERPRINT_BYTES) != this->fingerprint) {
+            return huffmanFailure(HUFFMAN_INVALID_HEADER, 0);
+        }
+
+        reset();
+
+        const uint64_t headerBits = TOKEN_FINGERPRINT_BYTES * 8;
+        PackedBitReader reader(input + TOKEN_FINGERPRINT_BYTES, bitCount - headerBits);
+        size_t start = message.size();
+
+        while(!reader.atEnd()) {
+            uint64_t symbolOffset = reader.getPosition();
+            uint16_t token = 0;
+
+            HuffmanStatus status = this->tokenTree.decodeSymbol(reader, token);
+            if(status == HUFFMAN_SUCCESS && token == TOKEN_ESCAPE) {
+                char character = 0;
+                status = this->literalTree.decodeSymbol(reader, character);
+                if(status == HUFFMAN_SUCCESS) {
+                    message.push_back(character);
+                }
+            }
+            else if(status == HUFFMAN_SUCCESS) {
+                message.append(this->tokens[token - 1]);
+            }
+
+            if(status != HUFFMAN_SUCCESS) {
+                return huffmanFailure(status, headerBits + (status == HUFFMAN_TRUNCATED_MESSAGE ? reader.getPosition() : symbolOffset));
+            }
+            if(message.size() - start > maxLength) {
+                return huffmanFailure(HUFFMAN_INVALID_HEADER, headerBits + symbolOffset);
+            }
+        }
+
+        return huffmanSuccess(message.size() - start, uint64_t(message.size() - start) * 8);
+    }
+};
@@ -0,0 +1,163 @@
+/*
+    Purpose: Code UTF-8 text a character at a time instead of a byte at a time. The alphabet is read as UTF-8,
+        so it can hold any Unicode character, and the tree is an AdaptiveHuffmanTree32 over the code points.
+        Code points up to the alphabet's largest are looked up directly (while that stays under
+        DENSE_SYMBOL_INDEX_LIMIT), and the rest by a binary search of the sorted alphabet. A CJK character is
+        then one symbol and one tree update instead of three, and it is predicted as a whole. Messages go in and
+        come out as UTF-8, and every offset in a result is in bytes of the UTF-8 text.
+*/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "AdaptiveHuffmanTree.h"
+#include "HuffmanUtf8.h"
+#include "HuffmanBitIO.h"
+#include "HuffmanResult.h"
+using namespace std;
+
+// Function that tells us whether an alphabet string is valid UTF-8, and so can be given to a Utf8HuffmanTree
+inline bool isUtf8Alphabet(const string& alphabet) {
+    vector<uint32_t> codePoints;
+    return parseUtf8Alphabet(alphabet, codePoints).ok();
+}
+
+// Creating the code point tree, which takes its alphabet as a UTF-8 string and codes UTF-8 messages
+class Utf8HuffmanTree : public AdaptiveHuffmanTree32
+{
+    public:
+    // Creating the code point tree's base class
+    using Base = AdaptiveHuffmanTree32;
+    using Base::encode;
+    using Base::decode;
+
+    // Constructor that takes the alphabet string, read as UTF-8, and the code length limit. A HuffmanException is
+    //      thrown if the alphabet isn't valid UTF-8, or has more than 65536 characters
+    explicit Utf8HuffmanTree(const string& alphabet, int maxCodeLength = NO_CODE_LENGTH_LIMIT)
+        : Utf8HuffmanTree(alphabetCodePoints(alphabet), maxCodeLength) {}
+
+    // Moving a code point tree moves its nodes the same way as the template, and copying is not allowed
+    Utf8HuffmanTree(Utf8HuffmanTree&& other) noexcept = default;
+    Utf8HuffmanTree& operator=(Utf8HuffmanTree&& other) noexcept = default;
+
+    // Function that returns an independent deep copy of this tree, including everything it has adapted to so far
+    Utf8HuffmanTree clone() const {
+        Utf8HuffmanTree copy;
+        cloneInto(copy);
+        return copy;
+    }
+
+    // Function that returns the characters of the alphabet as UTF-8, in the order they appear in the alphabet
+    string getAlphabetSymbols() const {
+        string alphabet;
+
+        for(int i = 0; i < this->symbolCount; i++) {
+            appendUtf8(this->symbols[i], alphabet);
+        }
+        return alphabet;
+    }
+
+    // Function that checks that a message is valid UTF-8 made of characters in the alphabet. The result holds the
+    //      byte offset of the first character that isn't
+    HuffmanResult validateMessage(string_view message) const {
+        vector<uint32_t> indices;
+        return symbolIndices(message, indices);
+    }
+
+    // Function that encodes a UTF-8 message, writing packed bits into a caller's sink. Nothing is written for a
+    //      message that isn't valid UTF-8 over the alphabet
+    HuffmanResult encode(string_view message, HuffmanSink& sink) noexcept {
+        vector<uint32_t> indices;
+        HuffmanResult validation = symbolIndices(message, indices);
+
+        if(!validation.ok()) {
+            return validation;
+        }
+
+        ByteWriter bytes(sink);
+        PackedBitWriter writer(bytes);
+
+        for(size_t i = 0; i < indices.size(); i++) {
+            encodeCharacter(int(indices[i]), writer);
+
+            if(writer.failed()) {
+                return huffmanFailure(HUFFMAN_OUTPUT_FULL, utf8ByteOffset(message, i));
+            }
+        }
+
+        if(!writer.finish()) {
+            return huffmanFailure(HUFFMAN_OUTPUT_FULL, message.size());
+        }
+
+        return huffmanSuccess(writer.bytesWritten(), writer.bitsWritten());
+    }
+
+    // Function that encodes a UTF-8 message, appending the packed bits onto the end of the string
+    HuffmanResult encode(string_view message, string& packed) noexcept {
+        StringSink sink(packed);
+        return encode(message, sink);
+    }
+
+    // Function that decodes packed bits, appending the message onto the end of the string as UTF-8. The result counts
+    //      bytes of UTF-8, and error offsets are in bits
+    HuffmanResult decode(const unsigned char* input, uint64_t bitCount, string& message) noexcept {
+        PackedBitReader reader(input, bitCount);
+        size_t start = message.size();
+
+        while(!reader.atEnd()) {
+            uint64_t symbolOffset = reader.getPosition();
+            int index = -1;
+
+            HuffmanStatus status = decodeCharacter(reader, index);
+            if(status != HUFFMAN_SUCCESS) {
+                return huffmanFailure(status, status == HUFFMAN_TRUNCATED_MESSAGE ? reader.getPosition() : symbolOffset);
+            }
+
+            appendUtf8(this->symbols[index], message);
+        }
+
+        return huffmanSuccess(message.size() - start, uint64_t(message.size() - start) * 8);
+    }
+
+    private:
+    // Private constructor for an empty tree, which clone() fills in
+    Utf8HuffmanTree() noexcept : Base() {}
+
+    // Private constructor that takes the parsed code points, so they only have to be parsed once
+    Utf8HuffmanTree(const vector<uint32_t>& codePoints, int maxCodeLength)
+        : Base(codePoints.data(), codePoints.size(), maxCodeLength) {}
+
+    // Function that parses the alphabet into its code points, throwing a HuffmanException if it isn't valid UTF-8
+    static vector<uint32_t> alphabetCodePoints(const string& alphabet) {
+        vector<uint32_t> codePoints;
+        HuffmanResult result = parseUtf8Alphabet(alphabet, codePoints);
+
+        if(!result.ok()) {
+            throw HuffmanException("Alphabet Is Not Valid UTF-8 At Byte " + to_string(result.errorOffset) + ".");
+        }
+        return codePoints;
+    }
+
+    // Function that decodes the message and replaces each code point with its place in the alphabet, so the coding
+    //      loop doesn't have to look anything up. The result holds the byte offset of the first character that is
+    //      either not valid UTF-8 or not in the alphabet
+    HuffmanResult symbolIndices(string_view message, vector<uint32_t>& indices) const {
+        HuffmanResult result = decodeUtf8(message.data(), message.size(), indices);
+
+        if(!result.ok()) {
+            return result;
+        }
+
+        for(size_t i = 0; i < indices.size(); i++) {
+            int index = indexOf(indices[i]);
+
+            if(index == -1) {
+                return huffmanFailure(HUFFMAN_INVALID_CHARACTER, utf8ByteOffset(message, i));
+            }
+            indices[i] = uint32_t(index);
+        }
+
+        return huffmanSuccess();
+    }
+};
@@ -0,0 +1,136 @@
+/*
+    Purpose: Run huffmand, the compression daemon. It takes the alphabet file, builds its compressors and thread
+        pool once, and then codes the requests HuffmanClient sends it over a Unix domain socket until it is
+        sent SIGINT or SIGTERM. It then answers the requests it is already coding, removes the socket and exits.
+        An optional --socket=path flag picks the socket (/tmp/huffmand.sock when not given), --compressors=N the
+        number of requests coded at once (one per core when not given), --connections=N the number of clients
+        served at once (256 when not given), and --level=, --max-code-length= and --tokens= set the LZ77 level,
+        the code length limit and the token dictionary the same way they do for the command line program.
+*/
+
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <pthread.h>
+#include "HuffmanDaemon.h"
+using namespace std;
+
+// Creating the prefixes of the optional flags
+const string SOCKET_FLAG_PREFIX = "--socket=";
+const string COMPRESSORS_FLAG_PREFIX = "--compressors=";
+const string CONNECTIONS_FLAG_PREFIX = "--connections=";
+const string LEVEL_FLAG_PREFIX = "--level=";
+const string MAX_CODE_LENGTH_FLAG_PREFIX = "--max-code-length=";
+const string TOKENS_FLAG_PREFIX = "--tokens=";
+
+int main(int argc, const char *argv[]) {
+    try {
+        string socketPath = DEFAULT_DAEMON_SOCKET;
+        size_t compressorCount = thread::hardware_concurrency();
+        size_t connectionCount = DEFAULT_DAEMON_CONNECTIONS;
+        int level = DEFAULT_LZ77_LEVEL;
+        int maxCodeLength = NO_CODE_LENGTH_LIMIT;
+        vector<string> tokens;
+
+        while(argc > 1 && string(argv[1]).compare(0, 2, "--") == 0) {
+            string flag = argv[1];
+
+            if(flag.compare(0, SOCKET_FLAG_PREFIX.size(), SOCKET_FLAG_PREFIX) == 0) {
+                socketPath = flag.substr(SOCKET_FLAG_PREFIX.size());
+            }
+            else if(flag.compare(0, COMPRESSORS_FLAG_PREFIX.size(), COMPRESSORS_FLAG_PREFIX) == 0) {
+                string count = flag.substr(COMPRESSORS_FLAG_PREFIX.size());
+
+                if(count.empty() || count.size() > 4 || count.find_first_not_of("0123456789") != string::npos || stoi(count) == 0) {
+                    throw HuffmanException("Unknown Compressor Count " + flag + ". Re-Run Program To Try Again.");
+                }
+                compressorCount = size_t(stoi(count));
+            }
+            else if(flag.compare(0, CONNECTIONS_FLAG_PREFIX.size(), CONNECTIONS_FLAG_PREFIX) == 0) {
+                string count = flag.substr(CONNECTIONS_FLAG_PREFIX.size());
+
+                if(count.empty() || count.size() > 5 || count.find_first_not_of("0123456789") != string::npos || stoi(count) == 0) {
+                    throw HuffmanException("Unknown Connection Count " + flag + ". Re-Run Program To Try Again.");
+                }
+                connectionCount = size_t(stoi(count));
+            }
+            else if(flag.compare(0, LEVEL_FLAG_PREFIX.size(), LEVEL_FLAG_PREFIX) == 0) {
+                string text = flag.substr(LEVEL_FLAG_PREFIX.size());
+
+                if(text.size() != 1 || text[0] < '0' + LZ77_MIN_LEVEL || text[0] > '0' + LZ77_MAX_LEVEL) {
+                    throw HuffmanException("Unknown Level " + flag + ". Re-Run Program To Try Again.");
+                }
+                level = text[0] - '0';
+            }
+            else if(flag.compare(0, MAX_CODE_LENGTH_FLAG_PREFIX.size(), MAX_CODE_LENGTH_FLAG_PREFIX) == 0) {
+                string text = flag.substr(MAX_CODE_LENGTH_FLAG_PREFIX.size());
+
+                if(text.size() != 2 || text.find_first_not_of("0123456789") != string::npos || stoi(text) < MIN_CODE_LENGTH_LIMIT || stoi(text) > MAX_CODE_LENGTH_LIMIT) {
+                    throw HuffmanException("Unknown Code Length Limit " + flag + ". Re-Run Program To Try Again.");
+                }
+                maxCodeLength = stoi(text);
+            }
+            else if(flag.compare(0, TOKENS_FLAG_PREFIX.size(), TOKENS_FLAG_PREFIX) == 0) {
+                tokens = parseTokenDictionary(readWholeFile(flag.substr(TOKENS_FLAG_PREFIX.size())));
+            }
+            else {
+                throw HuffmanException("Unknown Option " + flag + ". Re-Run Program To Try Again.");
+            }
+
+            argc--;
+            argv++;
+        }
+
+        if(argc != 2) {
+            throw HuffmanException("Invalid Number Of Command Line Arguments. Re-Run Program To Try Again.");
+        }
+
+        ifstream alphabetFile(argv[1]);
+        string alphabetString;
+
+        if(!alphabetFile) {
+            throw HuffmanException("Error When Opening Alphabet File. Re-Run Program To Try Again.");
+        }
+        getline(alphabetFile, alphabetString);
+
+        // Blocking the stop signals before any thread starts, so every thread inherits the mask and only the one
+        //      waiting for them below ever sees them
+        sigset_t stopSignals;
+        sigemptyset(&stopSignals);
+        sigaddset(&stopSignals, SIGINT);
+        sigaddset(&stopSignals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+        HuffmanThreadPool threadPool;
+        HuffmanDaemon daemon(threadPool, alphabetString, compressorCount, level, tokens, DEFAULT_BLOCK_SIZE,
+                             maxCodeLength, connectionCount);
+
+        int error = daemon.listenOn(socketPath);
+        if(error != 0) {
+            throw HuffmanException("Error When Listening On " + socketPath + ": " + strerror(error) + ".");
+        }
+
+        thread signalThread([&daemon, stopSignals] {
+            int signal = 0;
+            sigwait(&stopSignals, &signal);
+            daemon.stop();
+        });
+
+        cout << "Listening On " << socketPath << "." << endl;
+        daemon.serve();
+
+        // Sending the signal thread a stop signal of its own, in case serve ended without one, so it is done with
+        //      the daemon before the daemon goes away
+        pthread_kill(signalThread.native_handle(), SIGTERM);
+        signalThread.join();
+        cout << "Stopped." << endl;
+    }
+
+    catch(HuffmanException error) {
+        error.outputError();
+        return 1;
+    }
+
+    return 0;
+}
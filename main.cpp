@@ -12,18 +12,354 @@
 
 #include <iostream>
 #include "AdaptiveHuffmanTree.h"
+#include "BitPacking.h"
+#include "HuffmanCompressor.h"
+#include "HuffmanPipeline.h"
+#include "HuffmanBatch.h"
+#include "HuffmanAsyncIO.h"
 #include <bitset>
+#include <cstdio>
 #include <fstream>
+#include <glob.h>
+#include <sstream>
 using namespace std;
 
 const int VALID_COMMAND_LINE_ARGUMENTS = 4;
+
+// Creating the prefixes of the optional flags that pick a container mode, the transform stages, the LZ77 level and
+//      the code length limit for encoding, and the token dictionary for encoding and decoding
+const string MODE_FLAG_PREFIX = "--mode=";
+const string TRANSFORM_FLAG_PREFIX = "--transform=";
+const string LEVEL_FLAG_PREFIX = "--level=";
+const string MAX_CODE_LENGTH_FLAG_PREFIX = "--max-code-length=";
+const string TOKENS_FLAG_PREFIX = "--tokens=";
+const string IO_FLAG_PREFIX = "--io=";
+
+// Creating the number of message bytes the '0'/'1' text form is encoded in at a time
+const size_t TEXT_ENCODE_PIECE_SIZE = 64 * 1024;
+
+// Function that turns a mode name from the command line into a block mode, returning false for an unknown name
+bool parseBlockMode(const string& name, HuffmanBlockMode& mode) {
+    if(name == "adaptive") {
+        mode = BLOCK_MODE_ADAPTIVE;
+    }
+    else if(name == "semi") {
+        mode = BLOCK_MODE_SEMI_ADAPTIVE;
+    }
+    else if(name == "static") {
+        mode = BLOCK_MODE_STATIC;
+    }
+    else if(name == "context") {
+        mode = BLOCK_MODE_CONTEXT;
+    }
+    else if(name == "lz77") {
+        mode = BLOCK_MODE_LZ77;
+    }
+    else if(name == "bwt") {
+        mode = BLOCK_MODE_BWT;
+    }
+    else if(name == "token") {
+        mode = BLOCK_MODE_TOKEN;
+    }
+    else if(name == "utf8") {
+        mode = BLOCK_MODE_UTF8;
+    }
+    else if(name == "auto") {
+        mode = BLOCK_MODE_AUTO;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+// Function that turns a comma separated list of stage names from the command line into TRANSFORM_ flags,
+//      returning false for an unknown name
+bool parseTransforms(const string& names, uint8_t& transforms) {
+    size_t start = 0;
+
+    while(start <= names.size()) {
+        size_t end = names.find(',', start);
+        if(end == string::npos) {
+            end = names.size();
+        }
+
+        string name = names.substr(start, end - start);
+        if(name == "rle") {
+            transforms |= TRANSFORM_RLE;
+        }
+        else if(name == "mtf") {
+            transforms |= TRANSFORM_MTF;
+        }
+        else {
+            return false;
+        }
+
+        start = end + 1;
+    }
+    return true;
+}
+
+// Function that turns a level from the command line into a number, returning false unless it is 1 to 9
+bool parseLevel(const string& text, int& level) {
+    if(text.size() != 1 || text[0] < '0' + LZ77_MIN_LEVEL || text[0] > '0' + LZ77_MAX_LEVEL) {
+        return false;
+    }
+
+    level = text[0] - '0';
+    return true;
+}
+
+// Function that turns a code length limit from the command line into a number, returning false unless it is one a
+//      tree can keep to, 16 to 40
+bool parseMaxCodeLength(const string& text, int& maxCodeLength) {
+    if(text.size() != 2 || text.find_first_not_of("0123456789") != string::npos || stoi(text) < MIN_CODE_LENGTH_LIMIT || stoi(text) > MAX_CODE_LENGTH_LIMIT) {
+        return false;
+    }
+
+    maxCodeLength = stoi(text);
+    return true;
+}
+
+// Function that writes a string out to a file, byte for byte
+void writeWholeFile(const string& fileName, const string& contents) {
+    ofstream file(fileName, ios::binary);
+
+    if(!file) {
+        throw HuffmanException("Error When Creating/Opening " + fileName + ". Re-Run Program To Try Again.");
+    }
+
+    file << contents;
+}
+
+// Function that makes the name of an encoded or decoded file from the message file name. A file name with ".txt"
+//      in it is cut off there and given ".txt.encoded" or ".txt.decoded", as it always has been. Any other keeps its
+//      whole name, apart from an ".encoded" on the end when decoding, and has ".encoded" or ".decoded" added
+string codedFileName(const string& messageFileName, bool encoding) {
+    const string encodedExtension = ".encoded";
+    size_t nameStart = messageFileName.find_last_of('/');
+    size_t dotTextLocation = messageFileName.find(".txt", nameStart == string::npos ? 0 : nameStart + 1);
+
+    if(dotTextLocation != string::npos) {
+        return messageFileName.substr(0, dotTextLocation) + (encoding ? ".txt.encoded" : ".txt.decoded");
+    }
+
+    string baseName = messageFileName;
+    if(!encoding && baseName.size() > encodedExtension.size() &&
+       baseName.compare(baseName.size() - encodedExtension.size(), string::npos, encodedExtension) == 0) {
+        baseName.resize(baseName.size() - encodedExtension.size());
+    }
+    return baseName + (encoding ? encodedExtension : ".decoded");
+}
+
+// Function that turns the file arguments of a batch command into the list of files. An argument starting with '@'
+//      names a file that lists more of them, one per line, and one with a '*', '?' or '[' in it is a pattern that
+//      is matched here, for lists too long for the shell to pass
+vector<string> expandBatchArguments(int count, const char* arguments[]) {
+    vector<string> fileNames;
+
+    for(int i = 0; i < count; i++) {
+        string argument = arguments[i];
+
+        if(argument.size() > 1 && argument[0] == '@') {
+            istringstream list(readWholeFile(argument.substr(1)));
+            string line;
+
+            while(getline(list, line)) {
+                if(!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if(!line.empty()) {
+                    fileNames.push_back(line);
+                }
+            }
+        }
+        else if(argument.find_first_of("*?[") != string::npos) {
+            // A pattern that matches nothing is kept as it is, so it is reported as a file that can't be opened
+            glob_t matches;
+            if(glob(argument.c_str(), GLOB_NOCHECK, nullptr, &matches) == 0) {
+                for(size_t j = 0; j < matches.gl_pathc; j++) {
+                    fileNames.push_back(matches.gl_pathv[j]);
+                }
+            }
+            globfree(&matches);
+        }
+        else {
+            fileNames.push_back(argument);
+        }
+    }
+    return fileNames;
+}
+
+// Function that runs encode-batch or decode-batch over every file, with one alphabet and one set of compressors
+//      for the whole run. Files are coded in parallel, and so are the blocks of each file, while this thread keeps
+//      reads and writes in flight. A file that fails is reported and skipped, and the others are still coded. Returns
+//      the number of files that failed
+size_t runBatch(bool encoding, const string& alphabetString, const vector<string>& fileNames, HuffmanBlockMode blockMode,
+                uint8_t transforms, int level, int maxCodeLength, const vector<string>& tokens, HuffmanIOBackend ioBackend) {
+    HuffmanThreadPool threadPool;
+    HuffmanBatchCoder batchCoder(threadPool, alphabetString, DEFAULT_BLOCK_SIZE, blockMode, transforms, level, tokens, maxCodeLength);
+    vector<string> outputFileNames;
+
+    for(size_t i = 0; i < fileNames.size(); i++) {
+        outputFileNames.push_back(codedFileName(fileNames[i], encoding));
+    }
+
+    vector<HuffmanFileResult> results = batchCoder.codeFiles(encoding, fileNames, outputFileNames, ioBackend);
+    size_t failures = 0;
+
+    for(size_t i = 0; i < results.size(); i++) {
+        if(results[i].readError != 0) {
+            cerr << "Error When Opening " << fileNames[i] << "." << endl;
+        }
+        else if(!results[i].result.ok()) {
+            cerr << describeHuffmanStatus(results[i].result.status) << " At Byte " << results[i].result.errorOffset << " Of " << fileNames[i] << "." << endl;
+        }
+        else if(results[i].writeError != 0) {
+            cerr << "Error When Creating/Opening " << outputFileNames[i] << "." << endl;
+        }
+        else {
+            continue;
+        }
+        failures++;
+    }
+
+    cout << (fileNames.size() - failures) << " Of " << fileNames.size() << (encoding ? " Messages Encoded. Check Folder For .encoded Files." : " Messages Decoded. Check Folder For .decoded Files.") << endl;
+    return failures;
+}
+
+// Function that tells the user where the encoded or decoded message went. Nothing is printed when it went to standard
+//      output, where it would end up mixed into the message
+void reportCodedFile(bool encoding, const string& outputFileName, bool outputNamed) {
+    if(outputFileName == "-") {
+        return;
+    }
+
+    if(outputNamed) {
+        cout << (encoding ? "Message Encoded" : "Message Decoded") << ". Check Folder For " << outputFileName << "." << endl;
+    }
+    else if(encoding) {
+        cout << "Message Encoded. Check Folder For .encoded File For Encrypted Message." << endl;
+    }
+    else {
+        cout << "Message Decoded. Check Folder For .decoded File For Decrypted Message." << endl;
+    }
+}
+
 int main(int argc, const char *argv[]) {
 
+    // Whether the coded output goes to the screen, in which case errors go to cerr so they don't end up mixed into it
+    bool outputToScreen = false;
+
     // Now, we will embed all of our operations in the main, within a try catch block so that we can 
     //      throw error exceptions when necessary
     try {
+        // An optional --mode=adaptive, --mode=semi, --mode=static, --mode=context, --mode=lz77, --mode=bwt,
+        //      --mode=token, --mode=utf8 or --mode=auto flag may come before the command. With it, encoding writes a
+        //      packed container in that mode instead of the '0'/'1' text form. A --transform=rle, --transform=mtf or
+        //      --transform=rle,mtf flag runs those stages over each block first, and writes a container too (adaptive,
+        //      unless a mode is given). A --level=1 to --level=9 flag sets how hard --mode=lz77 looks for matches, and
+        //      picks that mode if no other is given. A --max-code-length=16 to --max-code-length=40 flag keeps every
+        //      code of the adaptive trees to that many bits, which the container records for decoding. A --tokens=file
+        //      flag reads the token dictionary, one token per line, which decoding a token container needs as well,
+        //      and picks --mode=token if no other mode is given.
+        //      Containers are read and written through io_uring where it can be set up, and --io=threads reads and
+        //      writes them on threads instead. We step past the flags so the rest of the arguments are where they
+        //      always are
+        bool useContainer = false;
+        bool modeGiven = false;
+        HuffmanBlockMode blockMode = BLOCK_MODE_ADAPTIVE;
+        uint8_t transforms = TRANSFORM_NONE;
+        int level = DEFAULT_LZ77_LEVEL;
+        int maxCodeLength = NO_CODE_LENGTH_LIMIT;
+        vector<string> tokens;
+        HuffmanIOBackend ioBackend = IO_BACKEND_AUTO;
+
+        while(argc > 1 && string(argv[1]).compare(0, 2, "--") == 0) {
+            string flag = argv[1];
+
+            if(flag.compare(0, MODE_FLAG_PREFIX.size(), MODE_FLAG_PREFIX) == 0) {
+                if(!parseBlockMode(flag.substr(MODE_FLAG_PREFIX.size()), blockMode)) {
+                    throw HuffmanException("Unknown Mode " + flag + ". Re-Run Program To Try Again.");
+                }
+                modeGiven = true;
+            }
+            else if(flag.compare(0, TRANSFORM_FLAG_PREFIX.size(), TRANSFORM_FLAG_PREFIX) == 0) {
+                if(!parseTransforms(flag.substr(TRANSFORM_FLAG_PREFIX.size()), transforms)) {
+                    throw HuffmanException("Unknown Transform " + flag + ". Re-Run Program To Try Again.");
+                }
+            }
+            else if(flag.compare(0, LEVEL_FLAG_PREFIX.size(), LEVEL_FLAG_PREFIX) == 0) {
+                if(!parseLevel(flag.substr(LEVEL_FLAG_PREFIX.size()), level)) {
+                    throw HuffmanException("Unknown Level " + flag + ". Re-Run Program To Try Again.");
+                }
+                if(!modeGiven) {
+                    blockMode = BLOCK_MODE_LZ77;
+                }
+            }
+            else if(flag.compare(0, MAX_CODE_LENGTH_FLAG_PREFIX.size(), MAX_CODE_LENGTH_FLAG_PREFIX) == 0) {
+                if(!parseMaxCodeLength(flag.substr(MAX_CODE_LENGTH_FLAG_PREFIX.size()), maxCodeLength)) {
+                    throw HuffmanException("Unknown Code Length Limit " + flag + ". Re-Run Program To Try Again.");
+                }
+            }
+            else if(flag.compare(0, TOKENS_FLAG_PREFIX.size(), TOKENS_FLAG_PREFIX) == 0) {
+                tokens = parseTokenDictionary(readWholeFile(flag.substr(TOKENS_FLAG_PREFIX.size())));
+                if(!modeGiven) {
+                    blockMode = BLOCK_MODE_TOKEN;
+                }
+            }
+            else if(flag.compare(0, IO_FLAG_PREFIX.size(), IO_FLAG_PREFIX) == 0) {
+                string backend = flag.substr(IO_FLAG_PREFIX.size());
+
+                if(backend == "auto") {
+                    ioBackend = IO_BACKEND_AUTO;
+                }
+                else if(backend == "threads") {
+                    ioBackend = IO_BACKEND_THREADS;
+                }
+                else {
+                    throw HuffmanException("Unknown I/O Backend " + flag + ". Re-Run Program To Try Again.");
+                }
+
+                // Only containers go through the backend, so this is the one flag that doesn't ask for one
+                argc--;
+                argv++;
+                continue;
+            }
+            else {
+                throw HuffmanException("Unknown Option " + flag + ". Re-Run Program To Try Again.");
+            }
+
+            useContainer = true;
+            argc--;
+            argv++;
+        }
+
+        // The batch commands take the alphabet file and any number of message files, and always read and write
+        //      containers, adaptive unless a mode is given
+        if(argc > 1 && (string(argv[1]) == "encode-batch" || string(argv[1]) == "decode-batch")) {
+            if(argc < VALID_COMMAND_LINE_ARGUMENTS) {
+                throw HuffmanException("Invalid Number Of Command Line Arguments. Re-Run Program To Try Again.");
+            }
+
+            ifstream alphabetFile(argv[2]);
+            string alphabetString;
+
+            if(!alphabetFile) {
+                throw HuffmanException("Error When Opening Alphabet File. Re-Run Program To Try Again.");
+            }
+            getline(alphabetFile, alphabetString);
+
+            // Exiting with a failure if any file failed, so scripts can tell without reading what was printed
+            size_t failures = runBatch(string(argv[1]) == "encode-batch", alphabetString, expandBatchArguments(argc - 3, argv + 3), blockMode, transforms, level, maxCodeLength, tokens, ioBackend);
+            return failures == 0 ? 0 : 1;
+        }
+
         // Our first task is to check if the user has entered the correct amount of arguments into the command line.
-        if(argc != VALID_COMMAND_LINE_ARGUMENTS) {
+        //      Encode and decode may also be given the name of the file to write, after the message file
+        bool outputNamed = argc == VALID_COMMAND_LINE_ARGUMENTS + 1 && (string(argv[1]) == "encode" || string(argv[1]) == "decode");
+
+        if(argc != VALID_COMMAND_LINE_ARGUMENTS && !outputNamed) {
             throw HuffmanException("Invalid Number Of Command Line Arguments. Re-Run Program To Try Again.");
         }
 
@@ -32,6 +368,30 @@ int main(int argc, const char *argv[]) {
             //      into a string variable, so we can use it to confirm which operation the user
             //      wants to execute
             string command = argv[1];
+
+            // The convert command does not use an alphabet. Its arguments are the input and output files, and it
+            //      packs a '0'/'1' encoded file into bytes, or unpacks a packed file back into '0'/'1' text,
+            //      depending on whether the input starts with the packed header
+            if(command == "convert") {
+                string input = readWholeFile(argv[2]);
+                string output;
+                HuffmanResult result;
+
+                if(isPackedBitFile(input)) {
+                    result = unpackBitString(input, output);
+                }
+                else {
+                    result = packBitString(input, output);
+                }
+
+                if(!result.ok()) {
+                    throw HuffmanException(string(describeHuffmanStatus(result.status)) + " At Byte " + to_string(result.errorOffset) + ". Re-Run Program To Try Again.");
+                }
+
+                writeWholeFile(argv[3], output);
+                cout << "Message Converted. Check Folder For " << argv[3] << "." << endl;
+                return 0;
+            }
             
             // Creating temporary string variables to hold the strings that we read in from our files
             string alphabetString;
@@ -48,18 +408,13 @@ int main(int argc, const char *argv[]) {
             // Using the message file name and converting it to a string
             string messageFileName = argv[3];
 
-            // Finding the location of the end of the original file name, using the .txt delimiter
-            int dotTextLocation = messageFileName.find(".txt");
-
-            // Getting the original file substring and making the start of the encoded and decoded file
-            //      names with it
-            string encodedFileName = messageFileName.substr(0, dotTextLocation);
-            string decodedFileName = messageFileName.substr(0, dotTextLocation);
-
             // For our encoding and decoding processes, they will use the original message file name, append
-            //      an extension based on the process, and create a completely new file with those two things.
-            encodedFileName.append(".txt.encoded");
-            decodedFileName.append(".txt.decoded");
+            //      an extension based on the process, and create a completely new file with that name, unless the
+            //      user named the file to write. A "-" for the message reads it from standard input, and a "-" for
+            //      the output, or a message read from standard input with no output named, writes to standard
+            //      output, so the program can sit in the middle of a pipeline
+            string outputFileName = outputNamed ? argv[4] : (messageFileName == "-" ? "-" : codedFileName(messageFileName, command == "encode"));
+            outputToScreen = outputFileName == "-";
 
             // Next, since the user entered the correct number of commmand line arguments, we will proceed in reading 
             //      in the third argument in the command line (the argv[2] element), which should contain a string of 
@@ -86,13 +441,174 @@ int main(int argc, const char *argv[]) {
             //      the alphabet for our encoding and decoding methods
             AdaptiveHuffmanTree huffmanTree(alphabetString);
             
+            // Containers are streamed: a reader thread, the compressor and a writer thread each work on a different
+            //      chunk of the file, so it is never held whole, and the file is read ahead and written behind a few
+            //      buffers at a time. A file is decoded this way if it starts like a container. Pipes can't be read or
+            //      written at an offset, so standard input and output, and any other file that isn't a regular one,
+            //      are read and written a buffer at a time from wherever they are instead
+            int inputFd = messageFileName == "-" ? STDIN_FILENO : open(messageFileName.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if(inputFd < 0) {
+                throw HuffmanException("Error When Opening Message File. Re-Run Program To Try Again.");
+            }
+
+            struct stat inputInformation;
+            unique_ptr<PipeInputBuffer> pipeInput;
+            string prefix;
+
+            if(inputFd != STDIN_FILENO && fstat(inputFd, &inputInformation) == 0 && S_ISREG(inputInformation.st_mode)) {
+                prefix.resize(CONTAINER_HEADER_SIZE);
+                ssize_t prefixLength = pread(inputFd, &prefix[0], prefix.size(), 0);
+                prefix.resize(prefixLength > 0 ? size_t(prefixLength) : 0);
+            }
+            else {
+                pipeInput = make_unique<PipeInputBuffer>(inputFd);
+                prefix = pipeInput->peek(CONTAINER_HEADER_SIZE);
+            }
+
+            if((command == "encode" && useContainer) || (command == "decode" && isContainerFile(prefix))) {
+                bool encoding = command == "encode";
+                int outputFd = outputToScreen ? STDOUT_FILENO : open(outputFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+                if(outputFd < 0) {
+                    close(inputFd);
+                    throw HuffmanException("Error When Creating/Opening " + outputFileName + ". Re-Run Program To Try Again.");
+                }
+
+                struct stat outputInformation;
+                bool outputIsFile = !outputToScreen && fstat(outputFd, &outputInformation) == 0 && S_ISREG(outputInformation.st_mode);
+
+                // Burrows-Wheeler blocks are coded in parallel, on one thread per core, so each chunk of them holds
+                //      a block for every thread. The pool only starts its threads when the first of them is coded, so
+                //      encoding in any other mode, or decoding a container without them, runs on this thread alone
+                HuffmanThreadPool threadPool;
+                HuffmanCompressor compressor(alphabetString, DEFAULT_BLOCK_SIZE, maxCodeLength, level);
+                compressor.useThreadPool(&threadPool);
+                compressor.useTokenDictionary(tokens);
+                HuffmanResult result;
+
+                {
+                    unique_ptr<streambuf> inputBuffer;
+                    unique_ptr<streambuf> outputBuffer;
+
+                    if(pipeInput) {
+                        inputBuffer = std::move(pipeInput);
+                    }
+                    else {
+                        inputBuffer = make_unique<AsyncInputBuffer>(inputFd, ioBackend);
+                    }
+
+                    if(outputIsFile) {
+                        outputBuffer = make_unique<AsyncOutputBuffer>(outputFd, ioBackend);
+                    }
+                    else {
+                        outputBuffer = make_unique<PipeOutputBuffer>(outputFd);
+                    }
+
+                    istream input(inputBuffer.get());
+                    ostream output(outputBuffer.get());
+
+                    result = encoding
+                        ? compressStream(input, output, compressor, blockMode, transforms, blockMode == BLOCK_MODE_BWT ? threadPool.getThreadCount() : 1)
+                        : decompressStream(input, output, compressor, threadPool.getThreadCount());
+
+                    // The last writes are still in flight until the flush, and can fail too
+                    if(result.ok() && !output.flush()) {
+                        result = huffmanFailure(HUFFMAN_OUTPUT_FULL, result.bytesWritten);
+                    }
+                }
+
+                close(inputFd);
+                close(outputFd);
+
+                // Removing what was written of the output, so a failed run doesn't leave half a file behind
+                if(!result.ok()) {
+                    if(outputIsFile) {
+                        remove(outputFileName.c_str());
+                    }
+                    throw HuffmanException(string(describeHuffmanStatus(result.status)) + " At Byte " + to_string(result.errorOffset) + ". Re-Run Program To Try Again.");
+                }
+
+                reportCodedFile(encoding, outputFileName, outputNamed);
+                return 0;
+            }
+
             // Our next task is to access to the second file (the argv[3] element) that holds the message that will be 
             //      either encoded or decoded
-            // Creating the ifstream file object for our message file
-            ifstream messageFile(messageFileName);
+            // Creating the ifstream file object for our message file. A message coming through a pipe is read through
+            //      the pipe buffer instead, which already holds the start of it
+            ifstream messageFile;
+            istream pipedMessage(pipeInput.get());
+
+            if(!pipeInput) {
+                close(inputFd);
+                messageFile.open(messageFileName);
+            }
+            istream& messageStream = pipeInput ? pipedMessage : messageFile;
+
+            // The '0'/'1' text form is encoded a piece at a time, so a message coming through a pipe is coded as it
+            //      arrives and its output goes out as each piece is coded, instead of once the pipe closes. The tree
+            //      carries over from one piece to the next, so the output is the same as coding the message whole.
+            //      Decoding the text form still reads the whole encoded message first
+            if(command == "encode") {
+                if(!messageStream) {
+                    throw HuffmanException("Error When Opening Message File. Re-Run Program To Try Again.");
+                }
+
+                ofstream encodedFile;
+                if(!outputToScreen) {
+                    encodedFile.open(outputFileName);
+                }
+                ostream& encodedOutput = outputToScreen ? cout : encodedFile;
+
+                if(!encodedOutput) {
+                    throw HuffmanException("Error When Creating/Opening Encoded Message File. Re-Run Program To Try Again.");
+                }
+
+                vector<char> piece(TEXT_ENCODE_PIECE_SIZE);
+                uint64_t messageOffset = 0;
+                string failure;
+
+                while(failure.empty() && messageStream.read(piece.data(), piece.size()).gcount() > 0) {
+                    size_t pieceLength = size_t(messageStream.gcount());
+                    encodedMessage.clear();
+
+                    // Error offsets are counted from the start of the message, not the piece
+                    HuffmanResult result = huffmanTree.encode(string_view(piece.data(), pieceLength), encodedMessage);
+
+                    if(!result.ok()) {
+                        failure = string(describeHuffmanStatus(result.status)) + " At Byte " + to_string(messageOffset + result.errorOffset);
+                    }
+                    else if(!encodedOutput.write(encodedMessage.data(), encodedMessage.size()) || (outputToScreen && !encodedOutput.flush())) {
+                        failure = "Error When Writing Encoded Message File";
+                    }
+                    messageOffset += pieceLength;
+                }
+
+                // A pipe that fails part way through leaves the stream bad, instead of at its end
+                if(failure.empty() && messageStream.bad()) {
+                    failure = "Error When Reading Message File";
+                }
+                if(failure.empty() && !encodedOutput.flush()) {
+                    failure = "Error When Writing Encoded Message File";
+                }
+
+                // Removing what was written of the output, so a failed run doesn't leave half a file behind
+                if(!failure.empty()) {
+                    if(!outputToScreen) {
+                        encodedFile.close();
+                        remove(outputFileName.c_str());
+                    }
+                    throw HuffmanException(failure + ". Re-Run Program To Try Again.");
+                }
+
+                encodedFile.close();
+                reportCodedFile(true, outputFileName, outputNamed);
+                return 0;
+            }
 
             // Using an if statement to check that it was opened correctly
-            if(messageFile) {
+            if(messageStream) {
                 // Now, for the message file, the message itself could be more than one line. So, to read it in 
                 //      properly, we will use a while loop and getline to read in all of the lines until the end of the
                 //      file is reached
@@ -102,7 +618,7 @@ int main(int argc, const char *argv[]) {
                 string tempMessageString;
 
                 // Reading in the first line of the string message
-                getline(messageFile, tempMessageString);
+                getline(messageStream, tempMessageString);
 
                 // From our first line of the file, we append the string, first, to our string message variable 
                 messageString.append(tempMessageString);
@@ -113,17 +629,22 @@ int main(int argc, const char *argv[]) {
                 //      We will now append the newline and the actual line read in, in a specific order, so that we ensure
                 //      the newline character is only appended to lines that actually have it. This way, the last line
                 //      of the file is not stuck with a newline at the end of it.
-                while(!messageFile.eof()) {
+                while(messageStream.good()) {
                     
                     // Appending the newline character since our getline ignores it when reading the message file
                     messageString.append("\n");
 
                     // Reading in the next line of the string message
-                    getline(messageFile, tempMessageString);
+                    getline(messageStream, tempMessageString);
 
                     // Appending the newly read line to our actual message string variable
                     messageString.append(tempMessageString);
                 }
+
+                // A pipe that fails part way through leaves the stream bad, instead of at its end
+                if(messageStream.bad()) {
+                    throw HuffmanException("Error When Reading Message File. Re-Run Program To Try Again.");
+                }
             }
 
             // Else statement that will throw an exception error if the file failed to open 
@@ -132,70 +653,44 @@ int main(int argc, const char *argv[]) {
             }
 
             // Next up, we will use the command string variable which is the same as the second command line argument check to see if it is 
-            //      either encode or decode. If it is one of those commands, we will continue on with it, if not, an exception will be thrown
-            if(command == "encode") {
-
-                // If the user entered the encode command, we will use make AdaptiveHuffmanTree object to call the encode method,
-                //      with the message read in from the string as its argument. Within this method, the message will be encoded,
-                //      returned, and assinged to the encodedMessage variable
-                encodedMessage = huffmanTree.encode(messageString);
-
-                // Our encode method returns NULL if a character encountered in the message is not a part of the alphabet array,
-                //      so we will use an if else statement to control our operations.
-                // If the message returned from the encode function is NULL, we will exit the program.
-                if(encodedMessage == "NULL") {
-                    return 0;
-                }
-
-                // Else statement that will run and operate if the encodedMessage was good and fully encoded
-                else {
-                    // Now that our encoding operation has happened, we will use the new file name created earlier that has the
-                    //      .encoded extension on it.
-                    ofstream encodedFile(encodedFileName);
-
-                    // Now, we will check if the file opens correctly or not
-                    if(encodedFile) {
-                        // If the file is created and opens properly, we will now write the encoded message into it
-                        encodedFile << encodedMessage;
-                    }
-
-                    // Else statement that will thrown an error exception if the file was not created or did not open correctly 
-                    else {
-                        throw HuffmanException("Error When Creating/Opening Encoded Message File. Re-Run Program To Try Again.");
+            //      decode, since encode was handled above. If it is, we will continue on with it, if not, an exception will be thrown
+            if(command == "decode") {
+                // Encoded messages that were converted to the packed form are turned back into '0'/'1' text first
+                if(isPackedBitFile(messageString)) {
+                    string packedMessage = pipeInput ? messageString : readWholeFile(messageFileName);
+                    HuffmanResult unpackResult = unpackBitString(packedMessage, messageString);
+
+                    if(!unpackResult.ok()) {
+                        throw HuffmanException(string(describeHuffmanStatus(unpackResult.status)) + " At Byte " + to_string(unpackResult.errorOffset) + ". Re-Run Program To Try Again.");
                     }
-
-                    // Closing the encodedFile
-                    encodedFile.close();            
                 }
 
-                // Outputting message to the screen letting the user know the message has been encoded
-                cout << "Message Encoded. Check Folder For .encoded File For Encrypted Message." << endl;
-            }
-
-            // Else if statement that will check for and handle the decode operation
-            else if(command == "decode") {
                 // If the user entered the decode command, we will use make AdaptiveHuffmanTree object to call the decode method,
-                //      with the message read in from the string as its argument. Within this method, the message will be decoded,
-                //      returned, and assinged to the decodedMessage variable
-                decodedMessage = huffmanTree.decode(messageString);
-
-                // As with the encode method, if a character encountered within the message file is not within the alphabet array,
-                //      there will be an exception thrown and the decodedMessage will be set to NULL
-                // If the message returned from the decode function is NULL, we will exit the program.
-                if(decodedMessage == "NULL") {
-                    return 0;
+                //      with the message read in from the string as its argument. Within this method, the message will be decoded
+                //      into the decodedMessage variable, and we get back a result telling us if it worked
+                HuffmanResult result = huffmanTree.decode(messageString, decodedMessage);
+
+                // As with the encode method, if the encoded message is malformed or decodes to a character that is not within
+                //      the alphabet array, the result will hold a failed status and the offset where it happened
+                // If the decoding failed, we will throw an exception that tells the user where the problem is.
+                if(!result.ok()) {
+                    throw HuffmanException(string(describeHuffmanStatus(result.status)) + " At Byte " + to_string(result.errorOffset) + ". Re-Run Program To Try Again.");
                 }
 
                 // Else statement that will run and operate if the decodedMessage had no issues and was properly decoded
                 else {
                     // Now that our decoding operation has happened, we will use the new file name created earlier that has the
-                    //      .decoded extension on it.
-                    ofstream decodedFile(decodedFileName);
+                    //      .decoded extension on it, or standard output.
+                    ofstream decodedFile;
+                    if(!outputToScreen) {
+                        decodedFile.open(outputFileName);
+                    }
+                    ostream& decodedOutput = outputToScreen ? cout : decodedFile;
 
                     // Now, we will check if the file opens correctly or not
-                    if(decodedFile) {
+                    if(decodedOutput) {
                         // If the file is created and opens properly, we will now write the encoded message into it
-                        decodedFile << decodedMessage;
+                        decodedOutput << decodedMessage;
                     }
 
                     // Else statement that will thrown an error exception if the file was not created or did not open correctly 
@@ -208,7 +703,7 @@ int main(int argc, const char *argv[]) {
                 }
 
                 // Outputting message to the screen letting the user know the message has been decoded
-                cout << "Message Decoded. Check Folder For .decoded File For Decrypted Message." << endl;
+                reportCodedFile(false, outputFileName, outputNamed);
             }
 
             // Else statement that will throw an exception error if the command is incorrect
@@ -220,7 +715,8 @@ int main(int argc, const char *argv[]) {
 
     // Catching any errors thrown
     catch(HuffmanException error) {            
-        error.outputError();
+        error.outputError(outputToScreen ? cerr : cout);
+        return 1;
     }
 
     return 0;
@@ -0,0 +1,329 @@
+/*
+    Purpose: Test the container. Every block mode is round tripped with every set of transform stages, with and
+        without a code length limit, and then containers that have been cut short or corrupted are decoded to
+        check they are turned away with the right status rather than decoded into something else or crashed on.
+        It prints each check that fails and exits with status 1 if any did. Run it from the top of the repo:
+
+        g++ -std=c++17 -O2 -pthread -I. tests/ContainerTest.cpp -o container_test && ./container_test
+*/
+
+#include <iostream>
+#include <random>
+#include "HuffmanCompressor.h"
+using namespace std;
+
+// Creating the alphabet the ASCII messages are written in, in the form the alphabet file takes
+const string TEST_ALPHABET = "abcdefghijklmnopqrstuvwxyz .,!?'-\\n\\tABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+// Creating a UTF-8 alphabet for the UTF-8 mode, and the words its messages are made of
+const string TEST_UTF8_ALPHABET = " .,abc\xe4\xb8\x80\xe4\xba\x8c\xe4\xb8\x89\xe5\x9b\x9b\xe4\xba\x94\xe6\x97\xa5\xe6\x9c\xac";
+const string TEST_UTF8_WORDS[] = {"\xe4\xb8\x80", "\xe4\xba\x8c", "\xe4\xb8\x89", "\xe5\x9b\x9b", "\xe4\xba\x94",
+                                  "\xe6\x97\xa5\xe6\x9c\xac", "abc", " ", ", ", "."};
+
+// Creating the words the test messages are made of, the first few of which are also the token dictionary
+const string TEST_WORDS[] = {"the", "compress", "container", "block", "and", "Huffman", "tree", "of", "a", "mode",
+                             "Run", "2024", "!", "?", "it's", "well-known"};
+const size_t TEST_TOKEN_COUNT = 6;
+
+// Creating a small block size, so every message is split into several blocks
+const size_t TEST_BLOCK_SIZE = 4096;
+
+// Creating the modes that can be asked for, with their names for the failure messages
+const HuffmanBlockMode TEST_MODES[] = {BLOCK_MODE_ADAPTIVE, BLOCK_MODE_SEMI_ADAPTIVE, BLOCK_MODE_STATIC, BLOCK_MODE_CONTEXT,
+                                       BLOCK_MODE_LZ77, BLOCK_MODE_BWT, BLOCK_MODE_TOKEN, BLOCK_MODE_UTF8, BLOCK_MODE_AUTO};
+const char* const TEST_MODE_NAMES[] = {"adaptive", "semi", "static", "context", "lz77", "bwt", "token", "utf8", "auto"};
+
+// Creating the count of checks that failed
+size_t failures = 0;
+
+// Function that records a check, printing it if it failed
+void check(bool passed, const string& what) {
+    if(!passed) {
+        cout << "FAILED: " << what << endl;
+        failures++;
+    }
+}
+
+// Function that builds a message of the given length out of the words, with runs of one character and newlines
+//      mixed in so the run-length stage has something to shorten
+string makeMessage(size_t length, unsigned seed) {
+    mt19937 random(seed);
+    string message;
+
+    while(message.size() < length) {
+        unsigned pick = random() % 20;
+
+        if(pick == 0) {
+            message.append(4 + random() % 40, 'z');
+        }
+        else if(pick == 1) {
+            message.push_back('\n');
+        }
+        else {
+            message.append(TEST_WORDS[random() % size(TEST_WORDS)]);
+            message.push_back(pick % 7 == 0 ? '\t' : ' ');
+        }
+    }
+    message.resize(length);
+    return message;
+}
+
+// Function that builds a UTF-8 message of roughly the given length out of the UTF-8 words
+string makeUtf8Message(size_t length, unsigned seed) {
+    mt19937 random(seed);
+    string message;
+
+    while(message.size() < length) {
+        message.append(TEST_UTF8_WORDS[random() % size(TEST_UTF8_WORDS)]);
+    }
+    return message;
+}
+
+// Function that returns the token dictionary
+vector<string> testTokens() {
+    return vector<string>(TEST_WORDS, TEST_WORDS + TEST_TOKEN_COUNT);
+}
+
+// Function that returns the offsets where the blocks of a well formed container end, adding up the characters its
+//      block headers say they hold
+vector<size_t> blockEnds(const string& container, uint64_t& rawLength) {
+    vector<size_t> ends;
+    size_t offset = CONTAINER_HEADER_SIZE;
+    BlockHeader header;
+    rawLength = 0;
+
+    while(offset < container.size() && readBlockHeader(container, offset, header).ok()) {
+        offset += header.payloadBytes();
+        ends.push_back(offset);
+        rawLength += header.rawLength;
+    }
+    return ends;
+}
+
+vector<size_t> blockEnds(const string& container) {
+    uint64_t rawLength;
+    return blockEnds(container, rawLength);
+}
+
+// Function that compresses and decompresses the message, checking it comes back the same, and returns the container
+string roundTrip(HuffmanCompressor& compressor, const string& message, HuffmanBlockMode mode, uint8_t transforms, const string& name) {
+    string container;
+    HuffmanResult result = compressor.compress(message, mode, container, transforms);
+    check(result.ok(), name + " compresses (" + describeHuffmanStatus(result.status) + ")");
+
+    string decoded;
+    result = compressor.decompress(container, decoded);
+    check(result.ok(), name + " decompresses (" + describeHuffmanStatus(result.status) + ")");
+    check(decoded == message, name + " decodes to the message");
+
+    return container;
+}
+
+// Function that round trips every mode with every set of transforms, checking the mode each block was written with
+void testRoundTrips(int maxCodeLength) {
+    HuffmanCompressor compressor(TEST_ALPHABET, TEST_BLOCK_SIZE, maxCodeLength);
+    compressor.useTokenDictionary(testTokens());
+    string message = makeMessage(5 * TEST_BLOCK_SIZE + 123, 1);
+    string limit = maxCodeLength == NO_CODE_LENGTH_LIMIT ? "no limit" : "limit " + to_string(maxCodeLength);
+
+    for(size_t i = 0; i < size(TEST_MODES); i++) {
+        for(uint8_t transforms = TRANSFORM_NONE; transforms <= TRANSFORM_ALL; transforms++) {
+            string name = string(TEST_MODE_NAMES[i]) + ", transforms " + to_string(transforms) + ", " + limit;
+            string container = roundTrip(compressor, message, TEST_MODES[i], transforms, name);
+
+            check(container.size() > CONTAINER_HEADER_SIZE && uint8_t(container[5]) == transforms, name + " records the transforms");
+            check(container.size() > CONTAINER_HEADER_SIZE && uint8_t(container[6]) == maxCodeLength, name + " records the code length limit");
+            check(blockEnds(container).size() == 6 && blockEnds(container).back() == container.size(), name + " has six whole blocks");
+
+            // The transformed blocks of the UTF-8 mode may fall back to bytes, and auto picks for itself
+            if(TEST_MODES[i] != BLOCK_MODE_AUTO && (TEST_MODES[i] != BLOCK_MODE_UTF8 || transforms == TRANSFORM_NONE)) {
+                check(uint8_t(container[CONTAINER_HEADER_SIZE]) == TEST_MODES[i], name + " writes its mode");
+            }
+        }
+
+        roundTrip(compressor, string(), TEST_MODES[i], TRANSFORM_NONE, string(TEST_MODE_NAMES[i]) + ", empty message, " + limit);
+    }
+}
+
+// Function that round trips the Burrows-Wheeler mode with a thread pool, which codes its blocks in parallel
+void testThreadPool() {
+    HuffmanThreadPool pool(4);
+    HuffmanCompressor compressor(TEST_ALPHABET, TEST_BLOCK_SIZE);
+    compressor.useThreadPool(&pool);
+
+    string message = makeMessage(9 * TEST_BLOCK_SIZE, 2);
+    for(uint8_t transforms = TRANSFORM_NONE; transforms <= TRANSFORM_ALL; transforms++) {
+        roundTrip(compressor, message, BLOCK_MODE_BWT, transforms, "bwt on a pool, transforms " + to_string(transforms));
+    }
+}
+
+// Function that round trips the UTF-8 mode over a UTF-8 alphabet, and checks blocks that aren't valid UTF-8 fall
+//      back to being coded a byte at a time
+void testUtf8() {
+    HuffmanCompressor compressor(TEST_UTF8_ALPHABET, TEST_BLOCK_SIZE);
+    string message = makeUtf8Message(3 * TEST_BLOCK_SIZE, 3);
+
+    for(uint8_t transforms = TRANSFORM_NONE; transforms <= TRANSFORM_ALL; transforms++) {
+        roundTrip(compressor, message, BLOCK_MODE_UTF8, transforms, "utf8 alphabet, transforms " + to_string(transforms));
+    }
+
+    string container = roundTrip(compressor, message, BLOCK_MODE_UTF8, TRANSFORM_NONE, "utf8 alphabet");
+    check(uint8_t(container[CONTAINER_HEADER_SIZE]) == BLOCK_MODE_UTF8, "utf8 alphabet writes utf8 blocks");
+
+    // Blocks end on a character boundary, so a block size that lands inside a character still round trips
+    HuffmanCompressor oddCompressor(TEST_UTF8_ALPHABET, 1001);
+    roundTrip(oddCompressor, message, BLOCK_MODE_UTF8, TRANSFORM_NONE, "utf8 with blocks ending inside characters");
+
+    // A lone lead byte is in the byte alphabet but isn't UTF-8, so its block is coded a byte at a time
+    string invalid = "abc \xe4 abc";
+    container = roundTrip(compressor, invalid, BLOCK_MODE_UTF8, TRANSFORM_NONE, "invalid utf8");
+    check(uint8_t(container[CONTAINER_HEADER_SIZE]) == BLOCK_MODE_ADAPTIVE, "invalid utf8 falls back to an adaptive block");
+
+    // A character in neither alphabet still fails, at the byte it is at
+    container.clear();
+    HuffmanResult result = compressor.compress("abc d", BLOCK_MODE_UTF8, container);
+    check(result.status == HUFFMAN_INVALID_CHARACTER && result.errorOffset == 4, "a character outside the alphabet is rejected");
+}
+
+// Function that checks the decoding of the container fails with the status, and at the offset unless it is -1
+void checkRejected(HuffmanCompressor& compressor, const string& container, HuffmanStatus status, int64_t offset, const string& name) {
+    string decoded;
+    HuffmanResult result = compressor.decompress(container, decoded);
+
+    check(result.status == status, name + " gives " + describeHuffmanStatus(status) + " (got " + describeHuffmanStatus(result.status) + ")");
+    if(offset >= 0) {
+        check(result.errorOffset == uint64_t(offset), name + " fails at byte " + to_string(offset) + " (got " + to_string(result.errorOffset) + ")");
+    }
+}
+
+// Function that checks the container header is read and its fields are checked
+void testHeaders() {
+    HuffmanCompressor compressor(TEST_ALPHABET, TEST_BLOCK_SIZE);
+    string message = makeMessage(2 * TEST_BLOCK_SIZE, 4);
+    string container;
+    compressor.compress(message, BLOCK_MODE_ADAPTIVE, container);
+
+    string corrupt = container;
+    corrupt[0] = 'X';
+    checkRejected(compressor, corrupt, HUFFMAN_INVALID_HEADER, 0, "a bad magic number");
+
+    corrupt = container;
+    corrupt[4] = char(CONTAINER_VERSION + 1);
+    checkRejected(compressor, corrupt, HUFFMAN_INVALID_HEADER, 4, "an unknown version");
+
+    corrupt = container;
+    corrupt[5] = char(TRANSFORM_ALL + 1);
+    checkRejected(compressor, corrupt, HUFFMAN_INVALID_HEADER, 5, "an unknown transform");
+
+    // The code length limit has to be one a tree could have been built with
+    int badLimits[] = {1, MIN_CODE_LENGTH_LIMIT - 1, MAX_CODE_LENGTH_LIMIT + 1, 255};
+    for(int limit : badLimits) {
+        corrupt = container;
+        corrupt[6] = char(limit);
+        checkRejected(compressor, corrupt, HUFFMAN_INVALID_HEADER, 6, "a code length limit of " + to_string(limit));
+    }
+
+    // Block modes past the last one are turned away by readBlockHeader, including auto, which is never written
+    int badModes[] = {BLOCK_MODE_UTF8 + 1, 100, BLOCK_MODE_AUTO};
+    for(int mode : badModes) {
+        corrupt = container;
+        corrupt[CONTAINER_HEADER_SIZE] = char(mode);
+        checkRejected(compressor, corrupt, HUFFMAN_INVALID_HEADER, CONTAINER_HEADER_SIZE, "a block mode of " + to_string(mode));
+
+        size_t offset = CONTAINER_HEADER_SIZE;
+        BlockHeader header;
+        check(readBlockHeader(corrupt, offset, header).status == HUFFMAN_INVALID_HEADER, "readBlockHeader turns away mode " + to_string(mode));
+    }
+
+    // A payload longer than what is left of the container
+    corrupt = container;
+    corrupt[CONTAINER_HEADER_SIZE + 5] = char(0xff);
+    corrupt[CONTAINER_HEADER_SIZE + 12] = char(0x7f);
+    checkRejected(compressor, corrupt, HUFFMAN_TRUNCATED_MESSAGE, container.size(), "a payload past the end");
+
+    // A token block decoded without the dictionary it was coded with
+    HuffmanCompressor tokenCompressor(TEST_ALPHABET, TEST_BLOCK_SIZE);
+    tokenCompressor.useTokenDictionary(testTokens());
+    string tokenContainer;
+    tokenCompressor.compress(message, BLOCK_MODE_TOKEN, tokenContainer);
+
+    string decoded;
+    check(!compressor.decompress(tokenContainer, decoded).ok(), "a token container without its dictionary is turned away");
+}
+
+// Function that cuts every mode's container short at every byte. Ending on a block boundary leaves a shorter but
+//      well formed container, and anywhere else has to fail, never giving back more than the message
+void testTruncation() {
+    HuffmanCompressor compressor(TEST_ALPHABET, 1024);
+    compressor.useTokenDictionary(testTokens());
+    string message = makeMessage(3000, 5);
+
+    for(size_t i = 0; i < size(TEST_MODES); i++) {
+        string container;
+        compressor.compress(message, TEST_MODES[i], container, TRANSFORM_ALL);
+        vector<size_t> ends = blockEnds(container);
+
+        for(size_t length = 0; length < container.size(); length++) {
+            string name = string(TEST_MODE_NAMES[i]) + " cut to " + to_string(length) + " bytes";
+            string decoded;
+            HuffmanResult result = compressor.decompress(string_view(container).substr(0, length), decoded);
+
+            if(length < CONTAINER_HEADER_SIZE) {
+                check(result.status == HUFFMAN_INVALID_HEADER, name + " has no header");
+            }
+            else if(length == CONTAINER_HEADER_SIZE || find(ends.begin(), ends.end(), length) != ends.end()) {
+                check(result.ok() && message.compare(0, decoded.size(), decoded) == 0, name + " decodes the whole blocks");
+            }
+            else {
+                check(result.status == HUFFMAN_TRUNCATED_MESSAGE, name + " is truncated (got " + describeHuffmanStatus(result.status) + ")");
+            }
+        }
+    }
+}
+
+// Function that flips bytes after the first block header at random. A flipped bit can still decode, so this only
+//      checks that decoding comes back, and that a container that decodes gives the characters its block headers
+//      say it holds. Transforms are left off, since a flipped run length rightly decodes to a longer run
+void testCorruptPayloads() {
+    HuffmanCompressor compressor(TEST_ALPHABET, TEST_BLOCK_SIZE);
+    compressor.useTokenDictionary(testTokens());
+    string message = makeMessage(2 * TEST_BLOCK_SIZE, 6);
+    mt19937 random(7);
+
+    for(size_t i = 0; i < size(TEST_MODES); i++) {
+        string container;
+        compressor.compress(message, TEST_MODES[i], container);
+
+        for(int trial = 0; trial < 200; trial++) {
+            string corrupt = container;
+            size_t position = CONTAINER_HEADER_SIZE + BLOCK_HEADER_SIZE + random() % (corrupt.size() - CONTAINER_HEADER_SIZE - BLOCK_HEADER_SIZE);
+            corrupt[position] = char(corrupt[position] ^ (1 + random() % 255));
+
+            string decoded;
+            uint64_t rawLength;
+            blockEnds(corrupt, rawLength);
+            HuffmanResult result = compressor.decompress(corrupt, decoded);
+            check(!result.ok() || decoded.size() == rawLength,
+                  string(TEST_MODE_NAMES[i]) + " with byte " + to_string(position) + " flipped decodes to its block lengths");
+        }
+    }
+}
+
+int main() {
+    testRoundTrips(NO_CODE_LENGTH_LIMIT);
+    testRoundTrips(MIN_CODE_LENGTH_LIMIT);
+    testRoundTrips(MAX_CODE_LENGTH_LIMIT);
+    testThreadPool();
+    testUtf8();
+    testHeaders();
+    testTruncation();
+    testCorruptPayloads();
+
+    if(failures > 0) {
+        cout << failures << " Checks Failed." << endl;
+        return 1;
+    }
+
+    cout << "All Checks Passed." << endl;
+    return 0;
+}